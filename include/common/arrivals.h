@@ -0,0 +1,25 @@
+#ifndef FERRY_COMMON_ARRIVALS_H
+#define FERRY_COMMON_ARRIVALS_H
+
+#define ARRIVALS_POISSON "poisson"
+#define ARRIVALS_FIXED "fixed"
+
+typedef enum ArrivalProcess {
+    ARRIVAL_PROCESS_POISSON,    // Exponentially distributed gaps
+    ARRIVAL_PROCESS_FIXED       // Constant gaps
+} ArrivalProcess;
+
+/**
+ * Passenger arrival process, shared by every engine.
+ */
+typedef struct ArrivalConfig {
+    ArrivalProcess process;
+    int interval;               // ms, mean gap between arrivals, 0 = everyone at once
+} ArrivalConfig;
+
+int arrivals_valid(const char* name);
+void arrivals_load(ArrivalConfig* config);
+long long arrivals_next_gap(const ArrivalConfig* config, double uniform);
+void arrivals_sleep(long long usec);
+
+#endif
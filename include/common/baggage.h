@@ -0,0 +1,20 @@
+#ifndef FERRY_COMMON_BAGGAGE_H
+#define FERRY_COMMON_BAGGAGE_H
+
+#include <stdint.h>
+
+#include "common/state.h"
+
+// Longest sleep at baggage check before a passenger looks at the docks again,
+// in case a wake-up was missed
+#define BAGGAGE_WAIT_TIMEOUT_MS 1000
+
+void baggage_waiters_init(BaggageWaiters* baggage, int weight_min, int weight_max);
+int baggage_bucket(const BaggageWaiters* baggage, int weight);
+uint32_t baggage_wait_begin(SharedState* state, int weight);
+int baggage_wait(SharedState* state, int weight, uint32_t generation);
+void baggage_wake(SharedState* state, int baggage_limit);
+void baggage_wake_all(SharedState* state);
+void baggage_demand(const SharedState* state, int baggage_limit, int* fitting, int* heavier);
+
+#endif
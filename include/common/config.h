@@ -6,6 +6,7 @@
 #define SECURITY_MAX_FRUSTRATION 3
 
 #define CONFIG_GET_INT(key) atoi(getenv(key))
+#define CONFIG_GET_INT_OR(key, fallback) (getenv(key) ? atoi(getenv(key)) : (fallback))
 
 #define LOG_FILE "simulation.log"
 
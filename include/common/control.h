@@ -0,0 +1,40 @@
+#ifndef FERRY_COMMON_CONTROL_H
+#define FERRY_COMMON_CONTROL_H
+
+#include <stddef.h>
+
+// Path of the control FIFO the port manager serves, see control.c
+#define CONTROL_ENV "CONTROL"
+#define CONTROL_PATH_DEFAULT "port.control"
+// Longest command line, newline included
+#define CONTROL_LINE_MAX 64
+
+typedef enum ControlCommand {
+    CONTROL_DEPART_NOW = 1,     // depart-now [ferry]: boarding ferries leave at once
+    CONTROL_CLOSE_PORT,         // close-port [terminal]: passengers leave, boarding ferries depart
+    CONTROL_DRAIN,              // drain [terminal]: no more arrivals, the terminal closes once empty
+    CONTROL_PAUSE,              // pause [terminal]: no arrivals until resume
+    CONTROL_RESUME              // resume [terminal]
+} ControlCommand;
+
+typedef struct ControlRequest {
+    ControlCommand command;
+    int target;                 // Ferry for depart-now, terminal otherwise; -1 for all
+    char line[CONTROL_LINE_MAX];
+} ControlRequest;
+
+typedef struct ControlChannel {
+    int fd;                     // -1 if the channel could not be opened
+    size_t length;              // Bytes of an unfinished line in buffer
+    int discarding;             // Set while skipping the rest of a line too long for buffer
+    char buffer[CONTROL_LINE_MAX];
+    char path[256];
+} ControlChannel;
+
+int control_open(ControlChannel* channel, const char* path);
+int control_receive(ControlChannel* channel, ControlRequest* request);
+int control_parse(const char* line, ControlRequest* request);
+const char* control_command_name(ControlCommand command);
+void control_close(ControlChannel* channel);
+
+#endif
@@ -2,11 +2,14 @@
 #define FERRY_COMMON_IPC_H
 
 #include <stddef.h>
+#include <sys/types.h>
 #include <sys/ipc.h>
 #include <sys/msg.h>
 #include <sys/sem.h>
 #include <sys/shm.h>
 
+#include "common/state.h"
+
 #ifdef _SEM_SEMUN_UNDEFINED 
 union semun {
     int val;
@@ -18,29 +21,62 @@ union semun {
 
 // Queues are lowercase
 #define IPC_KEY_LOG_ID 'l'
-#define IPC_KEY_QUEUE_SECURITY_ID 's'
-#define IPC_KEY_QUEUE_RAMP_ID 'r'
 // SEM and SHM uppercase
 #define IPC_KEY_SHM_ID 'S'
-#define IPC_KEY_SEM_STATE_ID 'M'
 #define IPC_KEY_SEM_SECURITY_ID 'E'
 #define IPC_KEY_SEM_RAMP_ID 'R'
-#define IPC_KEY_SEM_RAMP_SLOTS_ID 'T'
 #define IPC_KEY_SEM_CURRENT_FERRY 'F'
+// Terminals after the first take their per-terminal objects from this id up,
+// one block of IPC_KEY_TERMINAL_STRIDE ids each (above every letter above)
+#define IPC_KEY_TERMINAL_BASE 0x80
+#define IPC_KEY_TERMINAL_STRIDE 8
+
+
+typedef enum IpcBackend {
+    IPC_BACKEND_SYSV,   // System V objects shared between processes
+    IPC_BACKEND_LOCAL   // Process-local emulation for the threaded engine
+} IpcBackend;
+
+// Transport behind the log queue of the System V backend
+#define IPC_TRANSPORT_ENV "TRANSPORT"
+
+typedef enum IpcTransport {
+    IPC_TRANSPORT_SYSV,     // System V message queues (default)
+    IPC_TRANSPORT_POSIX,    // POSIX message queues, one per channel type
+    IPC_TRANSPORT_RING      // Rings in System V shared memory
+} IpcTransport;
 
+/**
+ * Identifiers of every IPC object of one terminal, opened once per process.
+ * Roles forked without exec inherit them, shared memory attachment included,
+ * instead of resolving every key again. The log queue is shared by all terminals.
+ */
+typedef struct IpcHandles {
+    int terminal;
+    int log_queue;
+    int shm_id;
+    void* shm;
+    int sem_security;
+    int sem_ramp;
+    int sem_current_ferry;
+} IpcHandles;
 
-typedef enum SemStateMutexVariant {
-    SEM_STATE_MUTEX_VARIANT_PORT,
-    SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY,
-    SEM_STATE_MUTEX_VARIANT_FERRIES_STATE,
-    SEM_STATE_MUTEX_VARIANT_STATS,
-    SEM_STATE_MUTEX_VARIANT_COUNT
-} SemStateMutexVariant;
+void ipc_set_backend(IpcBackend backend);
+IpcBackend ipc_get_backend(void);
+int ipc_transport_valid(const char* name);
+IpcTransport ipc_get_transport(void);
+long ipc_self_id(void);
+void ipc_interrupt_waiters(void);
+key_t ipc_terminal_key(const char* ipc_key, int id, int terminal);
+int ipc_handles_open(const char* ipc_key, int terminal, IpcHandles* handles);
+void ipc_handles_close(IpcHandles* handles);
 
 int queue_create(key_t queue_key);
 int queue_open(key_t queue_key);
 int queue_close(int queue_id);
 int queue_close_if_exists(key_t queue_key);
+int queue_send(int queue_id, const void* msg, size_t size, int flags);
+ssize_t queue_receive(int queue_id, void* msg, size_t size, long type, int flags);
 
 int sem_create(key_t sem_key, int semaphore_count, unsigned short* initial_values);
 int sem_open(key_t sem_key, int semaphore_count);
@@ -52,6 +88,7 @@ int sem_wait_single_noundo(int sem_id, unsigned short sem_num);
 int sem_wait_single(int sem_id, unsigned short sem_num);
 int sem_wait_single_nointr(int sem_id, unsigned short sem_num);
 int sem_wait_single_nointr_noundo(int sem_id, unsigned short sem_num);
+int sem_trywait_single_noundo(int sem_id, unsigned short sem_num);
 int sem_signal_single_noundo(int sem_id, unsigned short sem_num);
 int sem_signal_single(int sem_id, unsigned short sem_num);
 
@@ -0,0 +1,37 @@
+#ifndef FERRY_COMMON_IPC_LOCAL_H
+#define FERRY_COMMON_IPC_LOCAL_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+
+// Process-local replacements for the System V objects, used when every
+// role runs as a thread of a single process (ENGINE=threads).
+// Identifiers returned here are table indices and are only meaningful
+// for the local_* functions below.
+
+#define LOCAL_IPC_MAX_OBJECTS 16
+#define LOCAL_QUEUE_MAX_BYTES (1024 * 1024)
+// Segments start on a cache line, so structures aligned within them stay aligned
+#define LOCAL_SHM_ALIGNMENT 64
+
+int local_queue_create(key_t queue_key);
+int local_queue_open(key_t queue_key);
+int local_queue_close(int queue_id);
+int local_queue_send(int queue_id, const void* msg, size_t size, int flags);
+ssize_t local_queue_receive(int queue_id, void* msg, size_t size, long type, int flags);
+
+int local_sem_create(key_t sem_key, int semaphore_count, unsigned short* initial_values);
+int local_sem_open(key_t sem_key, int semaphore_count);
+int local_sem_close(int sem_id);
+int local_sem_get_val(int sem_id, unsigned short sem_num);
+int local_sem_op(int sem_id, unsigned short sem_num, int value, int nowait);
+
+int local_shm_create(key_t shm_key, size_t size);
+int local_shm_open(key_t shm_key);
+int local_shm_close(int shm_id);
+void* local_shm_attach(int shm_id);
+
+void local_interrupt_waiters(void);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef FERRY_COMMON_IPC_POSIX_H
+#define FERRY_COMMON_IPC_POSIX_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+
+// POSIX message queue transport (TRANSPORT=posix), behind the log queue.
+// POSIX queues cannot be read by message type, so every channel type gets a
+// queue of its own: types 1..POSIX_MQ_CHANNEL_TYPES, which cover the roles'
+// log messages and the end marker. Other types fail with EINVAL.
+// Each message is stamped with the time it was sent, so a type-0 receive
+// returns the oldest message across the channels, as msgrcv would.
+// An empty System V queue stands behind the channels. Its identifier is the
+// one callers hold, and its removal tells waiters in other processes that the
+// channels are gone, which mq_unlink cannot: open descriptors keep working.
+
+#define POSIX_MQ_CHANNEL_TYPES 8
+#define POSIX_MQ_MAX_MESSAGES 10        // Default fs.mqueue.msg_max
+#define POSIX_MQ_MESSAGE_MAX 8192       // Default fs.mqueue.msgsize_max
+#define POSIX_MQ_POLL_MS 100            // How often blocked waits check for removal
+#define POSIX_MQ_MAX_OPEN 128
+#define POSIX_MQ_MAX_QUEUES 16
+
+int posix_queue_create(key_t queue_key);
+int posix_queue_open(key_t queue_key);
+int posix_queue_close(int queue_id);
+int posix_queue_send(int queue_id, const void* msg, size_t size, int flags);
+ssize_t posix_queue_receive(int queue_id, void* msg, size_t size, long type, int flags);
+
+#endif
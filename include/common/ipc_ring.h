@@ -0,0 +1,25 @@
+#ifndef FERRY_COMMON_IPC_RING_H
+#define FERRY_COMMON_IPC_RING_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+
+// Shared-memory ring transport (TRANSPORT=ring).
+// Every queue is a ring of fixed-size slots in a System V shared memory segment
+// keyed by the queue key, guarded by a robust process-shared mutex (state_lock.c).
+// Blocked senders and receivers sleep on a futex instead of entering the kernel
+// for every message.
+// Identifiers returned here are shared memory identifiers.
+
+#define RING_SLOTS 128
+#define RING_MESSAGE_MAX 1088           // Largest message body, LogMessage included
+#define RING_MAX_ATTACHED 16
+
+int ring_queue_create(key_t queue_key);
+int ring_queue_open(key_t queue_key);
+int ring_queue_close(int queue_id);
+int ring_queue_send(int queue_id, const void* msg, size_t size, int flags);
+ssize_t ring_queue_receive(int queue_id, void* msg, size_t size, long type, int flags);
+
+#endif
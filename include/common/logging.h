@@ -1,8 +1,10 @@
 #ifndef FERRY_COMMON_LOGGING_H
 #define FERRY_COMMON_LOGGING_H
 
+#include <stdio.h>
 #include <stdarg.h>
 #include "common/messages.h"
+#include "common/state.h"
 
 typedef enum Role {
     ROLE_PASSENGER = 1,
@@ -12,6 +14,9 @@ typedef enum Role {
     ROLE_SECURITY_MANAGER
 } Role;
 
+// Identifier of the last message, after which the logger writes what is left queued, prints the statistics and exits
+#define LOG_END_IDENTIFIER -2
+
 static const char* ROLE_NAMES[] = {
     "PASSENGER",
     "PORT_MANAGER",
@@ -21,5 +26,9 @@ static const char* ROLE_NAMES[] = {
 };
 
 void log_message(int queue, Role role, int identifier, const char* message, ...);
+void log_end(int queue);
+void log_statistics(FILE* out, const SimulationStats* stats);
+void log_terminal_statistics(FILE* out, int terminal, const SimulationStats* stats);
+void stats_add(SimulationStats* total, const SimulationStats* stats);
 
 #endif
\ No newline at end of file
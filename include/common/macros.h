@@ -10,6 +10,14 @@
     sem_signal_single(sem,sem_num); \
     }
 
+#define START_STATE_LOCK(state, variant) \
+    state_mutex_lock(&(state)->locks[variant].mutex); \
+    {
+
+#define END_STATE_LOCK(state, variant) \
+    state_mutex_unlock(&(state)->locks[variant].mutex); \
+    }
+
 #define TIMESPEC_DIFF(pred, current) ((double)(current.tv_sec - pred.tv_sec) + (current.tv_nsec - pred.tv_nsec) / 1000000000.0)
 
 #endif
\ No newline at end of file
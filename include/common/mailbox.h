@@ -0,0 +1,22 @@
+#ifndef FERRY_COMMON_MAILBOX_H
+#define FERRY_COMMON_MAILBOX_H
+
+#include "common/state.h"
+
+// States of a mailbox
+#define MAILBOX_FREE 0
+#define MAILBOX_WAITING 1       // Claimed, the owner has not slept yet
+#define MAILBOX_SLEEPING 2      // Claimed, the owner sleeps on it
+#define MAILBOX_ACCEPTED 3
+#define MAILBOX_REFUSED 4
+#define MAILBOX_WITHDRAWN 5     // The owner gave up waiting, the answer frees it
+
+void mailboxes_init(Mailboxes* mailboxes);
+int mailbox_claim(Mailboxes* mailboxes, int hint);
+int mailbox_wait(Mailboxes* mailboxes, int mailbox, int timeout_ms);
+int mailbox_withdraw(Mailboxes* mailboxes, int mailbox);
+void mailbox_release(Mailboxes* mailboxes, int mailbox);
+int mailbox_post(Mailboxes* mailboxes, int mailbox, int accepted);
+int mailbox_pending(const Mailboxes* mailboxes);
+
+#endif
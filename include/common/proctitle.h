@@ -0,0 +1,7 @@
+#ifndef FERRY_COMMON_PROCTITLE_H
+#define FERRY_COMMON_PROCTITLE_H
+
+void proctitle_init(int argc, char** argv);
+void proctitle_set(const char* title, ...);
+
+#endif
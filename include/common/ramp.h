@@ -0,0 +1,62 @@
+#ifndef FERRY_COMMON_RAMP_H
+#define FERRY_COMMON_RAMP_H
+
+#include "common/state.h"
+
+// What the ferry takes off a ramp lane, in the order it takes them
+#define RAMP_MESSAGE_EXIT 1        // Passenger leaving ramp
+#define RAMP_PRIORITY_VIP 2        // VIP passenger request
+#define RAMP_PRIORITY_REGULAR 3    // Regular passenger request
+
+// Longest sleep for a ramp slot before a passenger checks whether the port closed
+#define RAMP_WAIT_TIMEOUT_MS 1000
+
+// A granted passenger is off the ramp after PASSENGER_BOARDING_TIME. Its lease
+// gives it this much longer, in simulated microseconds, unless RAMP_LEASE_TIME is set
+#define RAMP_LEASE_GRACE_USEC 10000000
+// How often a ferry whose gate is closing, or whose passengers outlived their
+// lease, looks for passengers on the ramp who exited, in simulated microseconds
+#define RAMP_LEASE_PROBE_USEC 100000
+
+// Why a lease is marked, see ramp_leases_check
+#define RAMP_LEASE_EXPIRED 1       // Outlived by a holder that still runs: reported, still held
+#define RAMP_LEASE_ORPHANED 2      // Holder exited on the ramp: its slot is taken back
+
+// A passenger the ferry let onto the ramp, held until it walks off
+typedef struct RampLease {
+    long owner;                 // Passenger process or thread, 0 if the lease is free
+    int passenger_id;
+    int vip;
+    int reclaim;                // RAMP_LEASE_* once marked
+    int overdue;                // 1 once the holder outlived the lease
+    long long deadline;         // time_scale_now() at which the holder is looked at
+} RampLease;
+
+// Leases of the ferry at a dock. Only that ferry manager uses them
+typedef struct RampLeases {
+    int held;
+    RampLease leases[RAMP_LANE_SLOTS];
+} RampLeases;
+
+void ramp_lanes_init(SharedState* state);
+int ramp_slot_wait(RampSlots* slots);
+int ramp_slot_trywait(RampSlots* slots);
+void ramp_slot_post(RampSlots* slots, int count);
+int ramp_slot_value(const RampSlots* slots);
+int ramp_ring_push(RampRing* ring, const RampEntry* entry);
+int ramp_ring_pop(RampRing* ring, RampEntry* entry);
+int ramp_send(RampLane* lane, RampRing* ring, const RampEntry* entry);
+int ramp_receive(RampLane* lane, RampEntry* entry);
+void ramp_doorbell_ring(RampLane* lane);
+uint32_t ramp_lane_wait_begin(RampLane* lane);
+int ramp_lane_wait(RampLane* lane, uint32_t rings, long long deadline);
+void ramp_wake_ferries(SharedState* state);
+void ramp_wake_all(SharedState* state);
+void ramp_leases_init(RampLeases* leases);
+int ramp_lease_grant(RampLeases* leases, const RampEntry* entry, long long deadline);
+int ramp_lease_end(RampLeases* leases, int passenger_id);
+int ramp_leases_check(RampLeases* leases, long long now, int probe);
+int ramp_lease_reclaim(RampLeases* leases, RampLease* reclaimed);
+long long ramp_leases_next_deadline(const RampLeases* leases);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef FERRY_COMMON_SECURITY_RING_H
+#define FERRY_COMMON_SECURITY_RING_H
+
+#include <time.h>
+
+#include "common/state.h"
+
+void security_ring_init(SecurityRing* ring);
+int security_ring_push(SecurityRing* ring, const SecurityRequest* request);
+int security_ring_pop(SecurityRing* ring, SecurityRequest* request);
+int security_ring_wait(SecurityRing* ring, const struct timespec* deadline);
+void security_ring_close(SecurityRing* ring);
+
+#endif
@@ -1,8 +1,30 @@
 #ifndef FERRY_COMMON_STATE_H
 #define FERRY_COMMON_STATE_H
 
+#include <stdint.h>
+#include <pthread.h>
+
 #include "common/config.h"
 
+// Docks per terminal: ferries that board at the same time, each from its own ramp lane
+#define DOCK_MAX 8
+#define DOCK_COUNT_DEFAULT 1
+
+// Fields written by different roles are kept on different cache lines
+#define CACHE_LINE_SIZE 64
+
+// Identifies a mapped SharedState, see shared_state_check
+#define SHARED_STATE_MAGIC 0x53595246u    // "FRYS"
+#define SHARED_STATE_VERSION 10
+
+// Locks embedded in SharedState, one per group of fields
+typedef enum SemStateMutexVariant {
+    SEM_STATE_MUTEX_VARIANT_PORT,
+    SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY,
+    SEM_STATE_MUTEX_VARIANT_FERRIES_STATE,
+    SEM_STATE_MUTEX_VARIANT_COUNT
+} SemStateMutexVariant;
+
 typedef enum FerryStatus {
     FERRY_WAITING_IN_QUEUE = 1,
     FERRY_BOARDING,
@@ -10,13 +32,23 @@ typedef enum FerryStatus {
     FERRY_TRAVELING
 } FerryStatus;
 
+// Whether the passenger generator of a terminal releases passengers, set by control commands
+typedef enum Admissions {
+    ADMISSIONS_OPEN,
+    ADMISSIONS_PAUSED,          // Arrivals wait for resume
+    ADMISSIONS_DRAINING         // No more arrivals, the terminal closes once its passengers are gone
+} Admissions;
+
+// Each ferry on a cache line of its own: a ferry manager writing its
+// passenger count does not disturb the ferries next to it
 typedef struct FerryState {
     int ferry_id;
     int baggage_limit;
     int passenger_count;
     int baggage_weight_total;
     FerryStatus status;
-} FerryState;
+    uint32_t depart_requests;   // Bumped by the port manager for the ferry to depart now
+} __attribute__((aligned(CACHE_LINE_SIZE))) FerryState;
 
 typedef struct SimulationStats {
     int passengers_spawned;
@@ -27,11 +59,158 @@ typedef struct SimulationStats {
     int passengers_screened_rejected;
 } SimulationStats;
 
+// Statistics are counted on shards of their own cache line; readers add them up
+#define STATS_SHARDS 16
+
+typedef struct StatsShard {
+    SimulationStats counts;     // Updated with atomic adds only
+} __attribute__((aligned(CACHE_LINE_SIZE))) StatsShard;
+
+typedef struct SharedStats {
+    StatsShard shards[STATS_SHARDS];
+} SharedStats;
+
+// Passengers at baggage check wait in buckets of bag weight, see baggage.c
+#define BAGGAGE_BUCKETS 16
+
+typedef struct BaggageBucket {
+    uint32_t generation;        // Futex word: bumped whenever a ferry docks that may fit the bucket
+    int waiting;                // Passengers asleep in the bucket
+} __attribute__((aligned(CACHE_LINE_SIZE))) BaggageBucket;
+
+typedef struct BaggageWaiters {
+    int weight_min;             // Lowest weight of bucket 0
+    int bucket_width;           // Weights per bucket
+    BaggageBucket buckets[BAGGAGE_BUCKETS];
+} BaggageWaiters;
+
+// Ramp admission, see ramp.c. A lane holds this many passengers, so
+// RAMP_CAPACITY_REG + RAMP_CAPACITY_VIP is at most this (a power of two)
+#define RAMP_LANE_SLOTS 32
+
+// A ramp request or exit, as a passenger leaves it in a ring
+typedef struct RampEntry {
+    uint32_t sequence;          // Ring position the entry is ready for, see ramp_ring_push
+    long pid;                   // Passenger process or thread, the owner of its ramp lease
+    int passenger_id;
+    int weight;
+    int vip;
+    int mailbox;                // Mailbox the ferry answers a request in
+    int boarding;               // In an exit, the boarding that let the passenger on
+} RampEntry;
+
+// Ring many passengers push to and only the ferry at the dock pops from
+typedef struct RampRing {
+    uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));   // Next position passengers claim
+    uint32_t head __attribute__((aligned(CACHE_LINE_SIZE)));   // Next position the ferry reads
+    RampEntry entries[RAMP_LANE_SLOTS] __attribute__((aligned(CACHE_LINE_SIZE)));
+} RampRing;
+
+// Ramp slots of one kind: a counting semaphore on a futex
+typedef struct RampSlots {
+    int32_t available;          // Futex word: slots a passenger may take
+    int waiting;                // Passengers asleep on it
+} __attribute__((aligned(CACHE_LINE_SIZE))) RampSlots;
+
+// What the ferry at a dock sleeps on while its lane is empty
+typedef struct RampDoorbell {
+    uint32_t rings;             // Futex word: bumped by every request, exit or departure order
+    int sleeping;               // 1 while the ferry sleeps on it
+} __attribute__((aligned(CACHE_LINE_SIZE))) RampDoorbell;
+
+// Ramp lane of a dock
+typedef struct RampLane {
+    RampSlots slots[2];         // Regular and VIP slots, indexed by VIP status
+    RampRing requests[2];       // Regular and VIP requests
+    RampRing exits;             // Passengers who walked off the ramp onto the ferry
+    RampDoorbell doorbell;
+    int boardings;              // Gates opened at the dock, naming each boarding; only the docked ferry writes it
+} RampLane;
+
+// Security intake, see security_ring.c. The security semaphore lets at most
+// SECURITY_STATIONS * SECURITY_STATION_CAPACITY passengers request screening
+// at once, so a ring of this many requests (a power of two) never fills
+#define SECURITY_RING_SLOTS 16
+
+// A screening request, as a passenger leaves it in the ring
+typedef struct SecurityRequest {
+    uint32_t sequence;          // Ring position the request is ready for, see security_ring_push
+    long pid;                   // Requester
+    int passenger_id;
+    int gender;
+    int dangerous;
+    int mailbox;                // Mailbox the security manager answers in
+} SecurityRequest;
+
+// Requests many passengers push and only the security manager pops
+typedef struct SecurityRing {
+    uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));       // Next position passengers claim
+    uint32_t head __attribute__((aligned(CACHE_LINE_SIZE)));       // Next position the manager reads
+    uint32_t doorbell __attribute__((aligned(CACHE_LINE_SIZE)));   // Futex word the idle manager sleeps on
+    int sleeping;               // 1 while the manager sleeps on the doorbell
+    int closed;                 // Set once no passenger is left to screen
+    SecurityRequest requests[SECURITY_RING_SLOTS] __attribute__((aligned(CACHE_LINE_SIZE)));
+} SecurityRing;
+
+// Reply mailboxes, see mailbox.c. A passenger holds one from sending a
+// request until it has the answer. At most SECURITY_RING_SLOTS passengers
+// wait in security and RAMP_LANE_SLOTS on each ramp lane, so a passenger
+// always finds a free one
+#define MAILBOX_SLOTS 512
+
+// The answer to one passenger, MAILBOX_* in mailbox.h
+typedef struct Mailbox {
+    uint32_t state;             // Futex word
+    int value;                  // What an accepted request was accepted with
+} __attribute__((aligned(CACHE_LINE_SIZE))) Mailbox;
+
+typedef struct Mailboxes {
+    Mailbox boxes[MAILBOX_SLOTS];
+} Mailboxes;
+
+/**
+ * Describes the segment to whoever maps it. Written once when the terminal
+ * is created; readers check it before touching anything else.
+ */
+typedef struct SharedStateHeader {
+    uint32_t magic;             // SHARED_STATE_MAGIC
+    uint32_t version;           // SHARED_STATE_VERSION
+    uint32_t size;              // Bytes of the whole segment, ferries included
+    uint32_t ferry_count;
+    uint32_t ferries_offset;    // Offset of ferries[]
+    uint32_t ferry_stride;      // Bytes per ferry
+} __attribute__((aligned(CACHE_LINE_SIZE))) SharedStateHeader;
+
+// A state lock on a cache line of its own, so taking one lock does not disturb another
+typedef struct StateLock {
+    pthread_mutex_t mutex;      // Robust process-shared mutex, see state_lock.c
+} __attribute__((aligned(CACHE_LINE_SIZE))) StateLock;
+
+/**
+ * Shared state of a terminal, one cache line or more per access pattern:
+ * the header, the read-mostly port and dock fields every waiting passenger
+ * reads, each lock, each statistics shard, each baggage bucket, each part of
+ * a ramp lane or of the security ring, each reply mailbox and each ferry.
+ */
 typedef struct SharedState {
-    int port_open;
-    int current_ferry_id;
-    SimulationStats stats;
+    SharedStateHeader header;
+    // Read-mostly: written when the port closes, on control commands, or when a ferry docks or leaves
+    int port_open __attribute__((aligned(CACHE_LINE_SIZE)));
+    Admissions admissions;
+    int dock_count;
+    unsigned int docks_sequence;    // Seqlock of docked_ferry: odd while a ferry docks or leaves
+    int docked_ferry[DOCK_MAX];     // Ferry boarding at each dock, -1 if the dock is free
+    StateLock locks[SEM_STATE_MUTEX_VARIANT_COUNT];
+    SharedStats stats;              // Lock-free, see stats.h
+    BaggageWaiters baggage;         // Lock-free, see baggage.h
+    RampLane ramps[DOCK_MAX];       // Lock-free, see ramp.h
+    SecurityRing security;          // Lock-free, see security_ring.h
+    Mailboxes mailboxes;            // Lock-free, see mailbox.h
     FerryState ferries[];
 } SharedState;
 
+size_t shared_state_size(int ferry_count);
+void shared_state_header_init(SharedState* state, int ferry_count);
+int shared_state_check(const SharedState* state);
+
 #endif
@@ -0,0 +1,19 @@
+#ifndef FERRY_COMMON_STATE_LOCK_H
+#define FERRY_COMMON_STATE_LOCK_H
+
+#include <pthread.h>
+
+#include "common/state.h"
+
+int state_mutex_init(pthread_mutex_t* mutex);
+int state_mutex_lock(pthread_mutex_t* mutex);
+int state_mutex_unlock(pthread_mutex_t* mutex);
+int state_locks_init(SharedState* state);
+unsigned int state_seq_read_begin(const unsigned int* sequence);
+int state_seq_read_retry(const unsigned int* sequence, unsigned int start);
+void state_seq_write_begin(unsigned int* sequence);
+void state_seq_write_end(unsigned int* sequence);
+int docks_snapshot(const SharedState* state, int docked[DOCK_MAX]);
+void docks_publish(SharedState* state, int dock, int ferry);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef FERRY_COMMON_STATS_H
+#define FERRY_COMMON_STATS_H
+
+#include "common/state.h"
+
+// Retries of a snapshot before settling for counters read at slightly different times
+#define STATS_SNAPSHOT_ATTEMPTS 8
+
+/**
+ * Counter shard of a writer. Writers pick it by an identifier of their own
+ * (passenger id, ferry id, security station), so different roles rarely
+ * share a cache line; any choice is correct, since every update is atomic.
+ */
+#define STATS_SHARD(stats, key) (&(stats)->shards[(unsigned int)(key) % STATS_SHARDS].counts)
+
+// Adds to one statistic without a lock
+#define STATS_ADD(stats, key, field, value) \
+    __atomic_fetch_add(&STATS_SHARD(stats, key)->field, (value), __ATOMIC_RELAXED)
+
+#define STATS_INC(stats, key, field) STATS_ADD(stats, key, field, 1)
+
+void stats_reset(SharedStats* stats);
+int stats_snapshot(const SharedStats* stats, SimulationStats* snapshot);
+
+#endif
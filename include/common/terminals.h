@@ -0,0 +1,14 @@
+#ifndef FERRY_COMMON_TERMINALS_H
+#define FERRY_COMMON_TERMINALS_H
+
+// Terminals of one port, limited by the IPC key ids left for their objects
+#define TERMINAL_MAX 16
+// Terminal of an exec'd passenger generator and its passengers, set by the port manager
+#define TERMINAL_ENV "TERMINAL"
+
+int terminals_count(void);
+int terminals_current(void);
+void terminals_share(int passenger_count, int terminal_count, int terminal, int* first_id, int* count);
+int terminals_pin(int terminal, int terminal_count);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef FERRY_COMMON_TIMESCALE_H
+#define FERRY_COMMON_TIMESCALE_H
+
+#include <time.h>
+
+// Simulated seconds per wall-clock second: 10 runs the port ten times faster
+#define TIME_SCALE_ENV "TIME_SCALE"
+
+int time_scale_valid(const char* value);
+double time_scale(void);
+long long time_scale_wall_usec(long long usec);
+long long time_scale_now(void);
+void time_scale_sleep(long long usec);
+void time_scale_deadline(struct timespec* deadline, long long usec);
+
+#endif
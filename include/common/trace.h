@@ -0,0 +1,59 @@
+#ifndef FERRY_COMMON_TRACE_H
+#define FERRY_COMMON_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary traces start with this magic, then the version and the record count
+#define TRACE_BINARY_MAGIC "FTRC"
+#define TRACE_BINARY_VERSION 1
+
+/**
+ * Binary trace header and record layout (host byte order).
+ */
+typedef struct TraceBinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+} TraceBinaryHeader;
+
+typedef struct TraceBinaryRecord {
+    uint64_t arrival;           // ms
+    uint8_t gender;             // 1 - man, 2 - woman
+    uint8_t vip;
+    uint8_t dangerous;
+    uint8_t reserved;
+    uint32_t bag_weight;        // kg
+} TraceBinaryRecord;
+
+/**
+ * One recorded passenger arrival.
+ */
+typedef struct TraceEntry {
+    long long arrival;          // ms after the first arrival of the trace
+    int gender;                 // GENDER_MAN or GENDER_WOMAN
+    int vip;
+    int bag_weight;
+    int dangerous;
+} TraceEntry;
+
+/**
+ * Memory-mapped trace, read front to back one record at a time.
+ */
+typedef struct Trace {
+    const char* data;
+    size_t size;
+    size_t offset;
+    int binary;
+    long line;                  // CSV line of the last record read
+    long long first_arrival;    // ms
+    long long last_arrival;     // ms
+    long read;                  // Records read so far
+} Trace;
+
+int trace_open(const char* path, Trace* trace);
+long trace_count(const Trace* trace);
+int trace_next(Trace* trace, TraceEntry* entry);
+void trace_close(Trace* trace);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef FERRY_ENGINE_BENCH_H
+#define FERRY_ENGINE_BENCH_H
+
+// Selects a microbenchmark instead of a simulation run
+#define BENCH_ENV "BENCH"
+#define BENCH_ITERATIONS_DEFAULT 200000
+#define BENCH_PROCESSES_DEFAULT 4
+// Processes of the layout benchmark, one ferry record each
+#define BENCH_LAYOUT_WORKERS_MAX 64
+
+int bench_run(const char* name);
+
+#endif
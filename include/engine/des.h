@@ -0,0 +1,70 @@
+#ifndef FERRY_ENGINE_DES_H
+#define FERRY_ENGINE_DES_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "common/state.h"
+#include "common/baggage.h"
+#include "common/arrivals.h"
+
+// Simulated time in microseconds since the port opened
+typedef long long SimTime;
+
+#define DES_USEC_PER_SEC 1000000LL
+// Passengers asleep at baggage check look at the docked ferries again this often,
+// besides whenever a ferry that may take their bag docks
+#define DES_BAGGAGE_POLL_INTERVAL (BAGGAGE_WAIT_TIMEOUT_MS * 1000LL)
+
+// Checkpoint files start with this magic and version
+#define DES_CHECKPOINT_MAGIC "FCKP"
+#define DES_CHECKPOINT_VERSION 2
+
+/**
+ * Simulation parameters, read from the same environment variables as the
+ * other engines. Kept in a struct so a run can be repeated with different
+ * values inside one process.
+ */
+typedef struct DesConfig {
+    int passenger_count;
+    int ferry_count;
+    int ferry_capacity;
+    int dock_count;
+    int ramp_capacity_regular;
+    int ramp_capacity_vip;
+    int ferry_departure_interval;   // s
+    int ferry_travel_time;          // s, one way
+    int security_time_min;          // ms
+    int security_time_max;          // ms
+    int passenger_boarding_time;    // us
+    int ferry_gate_delay_max;       // us
+    int ferry_baggage_limit_min;
+    int ferry_baggage_limit_max;
+    int passenger_bag_min;
+    int passenger_bag_max;
+    int dangerous_item_chance;      // %
+    int vip_chance;                 // %
+    int port_close_after;           // s of simulated time, 0 = when all passengers are done
+    ArrivalConfig arrivals;
+    const char* trace;              // Recorded arrivals to replay, NULL = draw them from arrivals
+    unsigned long long seed;
+    const char* checkpoint;         // Save the whole state here once simulated time reaches checkpoint_at, NULL = never
+    int checkpoint_at;              // s of simulated time
+    const char* warm_start;         // Resume from this checkpoint instead of an empty port, NULL = cold start
+} DesConfig;
+
+// Every field a checkpoint must agree on with the configuration it is resumed with
+#define DES_CONFIG_MODEL_SIZE (offsetof(DesConfig, arrivals) + sizeof(ArrivalConfig))
+
+typedef struct DesReport {
+    SimTime start_time;         // Simulated time the run started from, 0 unless warm-started
+    SimTime simulated_time;
+    unsigned long long events;  // Events processed by this run, after the warm start if any
+    double board_time_mean;     // s from arrival at the port to boarded, over boarded passengers
+    double board_time_p95;      // s
+} DesReport;
+
+void des_config_load(DesConfig* config);
+int des_run(const DesConfig* config, FILE* log_file, SimulationStats* stats, DesReport* report);
+int des_engine_run(void);
+
+#endif
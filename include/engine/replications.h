@@ -0,0 +1,24 @@
+#ifndef FERRY_ENGINE_REPLICATIONS_H
+#define FERRY_ENGINE_REPLICATIONS_H
+
+#include "common/state.h"
+#include "engine/des.h"
+
+typedef struct ReplicationResult {
+    int status;                 // 0 on success, -1 if the run did not complete
+    SimulationStats stats;
+    DesReport report;
+} ReplicationResult;
+
+typedef struct MetricSummary {
+    double mean;
+    double variance;            // Sample variance
+    double ci_half_width;       // 95% confidence interval is mean +- ci_half_width
+} MetricSummary;
+
+int replications_default_workers(void);
+int replications_execute(const DesConfig* configs, int count, int workers, ReplicationResult* results);
+void replications_summarize(const double* samples, int count, MetricSummary* summary);
+int replications_engine_run(void);
+
+#endif
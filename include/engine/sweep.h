@@ -0,0 +1,11 @@
+#ifndef FERRY_ENGINE_SWEEP_H
+#define FERRY_ENGINE_SWEEP_H
+
+#define SWEEP_MAX_PARAMETERS 8
+#define SWEEP_MAX_VALUES 64
+// Replications per configuration when REPLICATIONS is not set
+#define SWEEP_DEFAULT_REPLICATIONS 5
+
+int sweep_engine_run(void);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef FERRY_ENGINE_THREADS_H
+#define FERRY_ENGINE_THREADS_H
+
+// Passengers alive at once when MAX_LIVE_PASSENGERS is not set
+#define THREADS_DEFAULT_MAX_LIVE_PASSENGERS 1024
+#define THREADS_PASSENGER_STACK_SIZE (128 * 1024)
+
+int threads_engine_run(const char* ipc_key, int log_queue_id, int shm_id);
+
+#endif
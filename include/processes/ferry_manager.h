@@ -0,0 +1,11 @@
+#ifndef FERRY_PROCESSES_FERRY_MANAGER_H
+#define FERRY_PROCESSES_FERRY_MANAGER_H
+
+#include "common/ipc.h"
+
+int ferry_manager_run(const IpcHandles* terminals, int terminal_count, int ferry_id);
+void ferry_manager_notify_depart(void);
+int ferry_manager_process(const IpcHandles* terminals, int ferry_id);
+int ferry_manager_main(int argc, char** argv);
+
+#endif
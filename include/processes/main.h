@@ -2,6 +2,6 @@
 #define FERRY_PROCESSES_MAIN_H
 #include <sys/ipc.h>
 
-int logger_loop(int queue_id, int shm_id);
+int logger_loop(int queue_id, const int* shm_ids, int terminal_count);
 
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef FERRY_PROCESSES_PASSENGER_H
 #define FERRY_PROCESSES_PASSENGER_H
 
+#include "common/ipc.h"
+
 typedef enum Gender {
     GENDER_MAN = 1,
     GENDER_WOMAN
@@ -21,4 +23,23 @@ typedef struct PassengerTicket {
     int bag_weight;
 } PassengerTicket;
 
+/**
+ * Attributes of a passenger, drawn at random or replayed from a trace.
+ */
+typedef struct PassengerProfile {
+    Gender gender;
+    int vip;        // 1 - VIP
+    int bag_weight;
+    int dangerous;  // 1 - carries a dangerous item, rejected at security
+} PassengerProfile;
+
+// Profile passed on the command line of exec'd passengers: gender,vip,bag_weight,dangerous
+#define PASSENGER_PROFILE_FORMAT "%d,%d,%d,%d"
+
+void passenger_profile_random(PassengerProfile* profile);
+int passenger_run(const IpcHandles* ipc, int passenger_id, const PassengerProfile* profile);
+void passenger_notify_port_closed(void);
+int passenger_process(const IpcHandles* ipc, int passenger_id, const PassengerProfile* profile);
+int passenger_main(int argc, char** argv);
+
 #endif
\ No newline at end of file
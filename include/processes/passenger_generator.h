@@ -0,0 +1,16 @@
+#ifndef FERRY_PROCESSES_PASSENGER_GENERATOR_H
+#define FERRY_PROCESSES_PASSENGER_GENERATOR_H
+
+#include "common/ipc.h"
+
+// Exited passengers are reaped this often while waiting for the next arrival (us)
+#define PASSENGER_GENERATOR_POLL_INTERVAL 10000
+// Passengers younger than this are left out of the memory report (us), exec may not be done yet
+#define PASSENGER_GENERATOR_SETTLE_TIME 100000
+// Memory is sampled once the generator has been running this long (us)
+#define PASSENGER_GENERATOR_MEMORY_DELAY 1000000
+
+int passenger_generator_run(const IpcHandles* ipc, const char* ipc_key);
+int passenger_generator_main(int argc, char** argv);
+
+#endif
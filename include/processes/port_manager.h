@@ -2,22 +2,29 @@
 #define FERRY_PROCESSES_PORT_MANAGER_H
 
 #include <time.h>
-#include <common/config.h>
+#include <sys/types.h>
+#include <processes/security_manager.h>
+#include <common/ipc.h>
+#include <common/logging.h>
 
-typedef struct SecurityStationOccupant {
-    long pid;
-    int passenger_id;
-    int dangerous;
-    struct timespec finish_timestamp;
-} SecurityStationOccupant;
+// Longest wait between two looks at children the kernel gave no pidfd for (ms)
+#define PORT_MANAGER_POLL_MS 10
+// Security permits added when a terminal closes, so queued passengers leave together
+#define PORT_CLOSE_SECURITY_PERMITS 1024
 
-typedef struct SecurityStationState {
-    int gender;
-    int usage;
-    SecurityStationOccupant slots[SECURITY_STATION_CAPACITY];
-} SecurityStationState;
+// A child of the port manager. Its pidfd turns readable once it exits
+typedef struct PortChild {
+    pid_t pid;
+    int pidfd;                  // -1 without pidfd support, or once reaped
+    Role role;                  // ROLE_FERRY_MANAGER, ROLE_SECURITY_MANAGER or ROLE_PASSENGER_GENERATOR
+    int index;                  // Ferry or terminal
+    int reaped;
+    int status;                 // From waitpid, once reaped
+    struct timespec started;
+    struct timespec ended;
+} PortChild;
 
+int port_manager_run(const IpcHandles* terminals, int terminal_count, const char* ipc_key);
+int port_manager_main(int argc, char** argv);
 
-int run_security_manager(const char* ipc_key);
-
-#endif
\ No newline at end of file
+#endif
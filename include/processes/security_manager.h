@@ -0,0 +1,39 @@
+#ifndef FERRY_PROCESSES_SECURITY_MANAGER_H
+#define FERRY_PROCESSES_SECURITY_MANAGER_H
+
+#include <time.h>
+#include <common/config.h>
+#include <common/messages.h>
+#include <common/ipc.h>
+
+typedef struct SecurityStationOccupant {
+    long pid;
+    int passenger_id;
+    int dangerous;
+    int mailbox;
+    struct timespec finish_timestamp;
+} SecurityStationOccupant;
+
+typedef struct SecurityStationState {
+    int gender;
+    int usage;
+    SecurityStationOccupant slots[SECURITY_STATION_CAPACITY];
+} SecurityStationState;
+
+// A screening in progress, filed by the time it ends
+typedef struct SecurityCompletion {
+    struct timespec finish_timestamp;
+    int station;
+    int slot;
+} SecurityCompletion;
+
+// Min-heap of the screenings in progress, the one ending first on top
+typedef struct SecurityCompletions {
+    int count;
+    SecurityCompletion entries[SECURITY_STATIONS * SECURITY_STATION_CAPACITY];
+} SecurityCompletions;
+
+int security_try_insert(SecurityStationState *securityStations, SecurityCompletions *completions, SecurityMessage *msg);
+int run_security_manager(const IpcHandles* ipc);
+
+#endif
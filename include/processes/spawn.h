@@ -0,0 +1,18 @@
+#ifndef FERRY_PROCESSES_SPAWN_H
+#define FERRY_PROCESSES_SPAWN_H
+
+#include <sys/types.h>
+#include "common/ipc.h"
+#include "common/logging.h"
+
+// Child processes: forked without exec (default) or exec'd as separate programs
+#define SPAWN_MODE_FORK "fork"
+#define SPAWN_MODE_EXEC "exec"
+// Passenger processes sampled for the memory report
+#define SPAWN_MEMORY_SAMPLES 32
+
+pid_t spawn_role(int exec_mode, const char* path, const char* ipc_key, const IpcHandles* ipc,
+                 int (*process)(const IpcHandles*, int), const char* title, int id, const char* detail);
+int spawn_report_memory(int log_queue, Role role, const pid_t* pids, int count, const char* spawn_mode);
+
+#endif
@@ -0,0 +1,60 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+
+#include "common/config.h"
+#include "common/arrivals.h"
+
+/**
+ * Checks an ARRIVALS value.
+ *
+ * @param name Arrival process name, NULL for the default
+ * @return 1 if the name is known, 0 otherwise
+ */
+int arrivals_valid(const char* name) {
+    return !name || strcmp(name, ARRIVALS_POISSON) == 0 || strcmp(name, ARRIVALS_FIXED) == 0;
+}
+
+/**
+ * Reads the arrival process from ARRIVALS and ARRIVAL_INTERVAL.
+ *
+ * @param config Filled with the arrival process
+ */
+void arrivals_load(ArrivalConfig* config) {
+    const char* name = getenv("ARRIVALS");
+
+    config->process = name && strcmp(name, ARRIVALS_FIXED) == 0 ? ARRIVAL_PROCESS_FIXED : ARRIVAL_PROCESS_POISSON;
+    config->interval = CONFIG_GET_INT_OR("ARRIVAL_INTERVAL", 0);
+    if (config->interval < 0) config->interval = 0;
+}
+
+/**
+ * Time until the next passenger arrives.
+ * The caller supplies the randomness, so the discrete-event engine
+ * stays reproducible from its seed.
+ *
+ * @param config Arrival process
+ * @param uniform Random number in [0, 1)
+ * @return Gap in microseconds
+ */
+long long arrivals_next_gap(const ArrivalConfig* config, double uniform) {
+    long long mean = (long long)config->interval * 1000;
+
+    if (mean == 0 || config->process == ARRIVAL_PROCESS_FIXED) return mean;
+    return (long long)(-log(1.0 - uniform) * mean);
+}
+
+/**
+ * Sleeps until the next arrival, resuming after signals.
+ *
+ * @param usec Time to sleep in microseconds
+ */
+void arrivals_sleep(long long usec) {
+    struct timespec remaining;
+
+    remaining.tv_sec = usec / 1000000;
+    remaining.tv_nsec = (usec % 1000000) * 1000;
+    while (nanosleep(&remaining, &remaining) == -1 && errno == EINTR);
+}
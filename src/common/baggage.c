@@ -0,0 +1,134 @@
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "common/baggage.h"
+
+/**
+ * Splits the bag weights passengers draw into BAGGAGE_BUCKETS buckets.
+ * Only called before any passenger waits.
+ *
+ * @param baggage Baggage waiters of a terminal
+ * @param weight_min Lowest bag weight
+ * @param weight_max Highest bag weight
+ */
+void baggage_waiters_init(BaggageWaiters* baggage, int weight_min, int weight_max) {
+    baggage->weight_min = weight_min;
+    baggage->bucket_width = weight_max >= weight_min ? (weight_max - weight_min) / BAGGAGE_BUCKETS + 1 : 1;
+    for (int bucket = 0; bucket < BAGGAGE_BUCKETS; bucket++) {
+        baggage->buckets[bucket].generation = 0;
+        baggage->buckets[bucket].waiting = 0;
+    }
+}
+
+/**
+ * Bucket of a bag weight. Weights outside the configured range, as replayed
+ * traces may carry, go to the first or the last bucket.
+ *
+ * @param baggage Baggage waiters of a terminal
+ * @param weight Bag weight
+ * @return Bucket index
+ */
+int baggage_bucket(const BaggageWaiters* baggage, int weight) {
+    int bucket;
+
+    if (weight < baggage->weight_min) return 0;
+    bucket = (weight - baggage->weight_min) / baggage->bucket_width;
+    return bucket < BAGGAGE_BUCKETS ? bucket : BAGGAGE_BUCKETS - 1;
+}
+
+/**
+ * Starts waiting at baggage check. Must be called before the passenger
+ * looks at the docks: a ferry that docks after that changes the generation,
+ * so baggage_wait returns at once instead of missing it.
+ *
+ * @param state Shared state
+ * @param weight Bag weight of the passenger
+ * @return Generation to pass to baggage_wait
+ */
+uint32_t baggage_wait_begin(SharedState* state, int weight) {
+    BaggageBucket* bucket = &state->baggage.buckets[baggage_bucket(&state->baggage, weight)];
+    return __atomic_load_n(&bucket->generation, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Sleeps until a ferry that may take the bag docks, the port closes, a
+ * signal arrives or BAGGAGE_WAIT_TIMEOUT_MS pass. Passengers whose bags no
+ * docked ferry takes cost nothing while they wait.
+ *
+ * @param state Shared state
+ * @param weight Bag weight of the passenger
+ * @param generation Value returned by baggage_wait_begin
+ * @return 0 when woken or the generation already changed, -1 with errno set on timeout or signal
+ */
+int baggage_wait(SharedState* state, int weight, uint32_t generation) {
+    BaggageBucket* bucket = &state->baggage.buckets[baggage_bucket(&state->baggage, weight)];
+    struct timespec timeout = { BAGGAGE_WAIT_TIMEOUT_MS / 1000, (BAGGAGE_WAIT_TIMEOUT_MS % 1000) * 1000000L };
+    long status;
+
+    // Counted before sleeping: a ferry that docks from here on sees the waiter and wakes it
+    __atomic_fetch_add(&bucket->waiting, 1, __ATOMIC_SEQ_CST);
+    status = syscall(SYS_futex, &bucket->generation, FUTEX_WAIT, generation, &timeout, NULL, 0);
+    __atomic_fetch_sub(&bucket->waiting, 1, __ATOMIC_SEQ_CST);
+    if (status == -1 && errno == EAGAIN) return 0;
+    return status == 0 ? 0 : -1;
+}
+
+static void baggage_wake_bucket(BaggageBucket* bucket) {
+    __atomic_fetch_add(&bucket->generation, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&bucket->waiting, __ATOMIC_SEQ_CST) > 0) {
+        syscall(SYS_futex, &bucket->generation, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+/**
+ * Wakes the passengers whose bags a newly docked ferry may take: every
+ * bucket up to the one holding the limit. The heaviest of those passengers
+ * may still not fit and go back to sleep; lighter buckets never wake for it.
+ * Call after docks_publish.
+ *
+ * @param state Shared state
+ * @param baggage_limit Baggage limit of the docked ferry
+ */
+void baggage_wake(SharedState* state, int baggage_limit) {
+    if (baggage_limit < state->baggage.weight_min) return;
+    for (int bucket = baggage_bucket(&state->baggage, baggage_limit); bucket >= 0; bucket--) {
+        baggage_wake_bucket(&state->baggage.buckets[bucket]);
+    }
+}
+
+/**
+ * Wakes every passenger at baggage check, for the port closing.
+ * Async-signal-safe.
+ *
+ * @param state Shared state
+ */
+void baggage_wake_all(SharedState* state) {
+    for (int bucket = 0; bucket < BAGGAGE_BUCKETS; bucket++) baggage_wake_bucket(&state->baggage.buckets[bucket]);
+}
+
+/**
+ * Counts the passengers asleep at baggage check, as a ferry docking sees them.
+ *
+ * @param state Shared state
+ * @param baggage_limit Baggage limit of the ferry
+ * @param fitting Filled with the passengers in buckets the limit may fit
+ * @param heavier Filled with the passengers in heavier buckets
+ */
+void baggage_demand(const SharedState* state, int baggage_limit, int* fitting, int* heavier) {
+    int last = baggage_limit < state->baggage.weight_min ? -1 : baggage_bucket(&state->baggage, baggage_limit);
+
+    *fitting = 0;
+    *heavier = 0;
+    for (int bucket = 0; bucket < BAGGAGE_BUCKETS; bucket++) {
+        int waiting = __atomic_load_n(&state->baggage.buckets[bucket].waiting, __ATOMIC_RELAXED);
+        if (bucket <= last) {
+            *fitting += waiting;
+        } else {
+            *heavier += waiting;
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "common/control.h"
+
+static const char* const CONTROL_COMMANDS[] = { "depart-now", "close-port", "drain", "pause", "resume" };
+
+/**
+ * Opens the control channel: a FIFO anyone may write commands to, one per
+ * line, such as `echo "depart-now 2" > port.control`. A FIFO left behind by
+ * a run that crashed is replaced; any other file at the path is kept.
+ *
+ * @param channel Filled with the open channel
+ * @param path Path of the FIFO
+ * @return 0 on success, -1 with errno set otherwise (the channel is then closed)
+ */
+int control_open(ControlChannel* channel, const char* path) {
+    struct stat existing;
+
+    channel->fd = -1;
+    channel->length = 0;
+    channel->discarding = 0;
+    snprintf(channel->path, sizeof(channel->path), "%s", path);
+    if (lstat(path, &existing) == 0 && S_ISFIFO(existing.st_mode)) unlink(path);
+    if (mkfifo(path, 0600) == -1) return -1;
+    // Also opened for writing, so reads never see end of file between two writers
+    if ((channel->fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC)) == -1) {
+        unlink(path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Takes the next command off the channel without blocking. Lines longer
+ * than CONTROL_LINE_MAX are dropped whole, up to and including their newline.
+ *
+ * @param channel Control channel
+ * @param request Filled with the command, and its line even if malformed
+ * @return 1 with a command, 0 if no full line is waiting,
+ *         -1 with errno EINVAL for a line that is no command
+ */
+int control_receive(ControlChannel* channel, ControlRequest* request) {
+    char* end;
+    size_t used;
+
+    if (channel->fd == -1) return 0;
+    for (;;) {
+        while (!(end = memchr(channel->buffer, '\n', channel->length))) {
+            ssize_t count;
+            if (channel->length == sizeof(channel->buffer)) {
+                // The line will not fit: throw away what is left of it up to its newline
+                channel->length = 0;
+                channel->discarding = 1;
+            }
+            count = read(channel->fd, channel->buffer + channel->length, sizeof(channel->buffer) - channel->length);
+            if (count == -1 && errno == EINTR) continue;
+            if (count <= 0) return 0;
+            channel->length += (size_t)count;
+        }
+        *end = '\0';
+        used = (size_t)(end - channel->buffer) + 1;
+        if (!channel->discarding) snprintf(request->line, sizeof(request->line), "%s", channel->buffer);
+        channel->length -= used;
+        memmove(channel->buffer, channel->buffer + used, channel->length);
+        if (!channel->discarding) break;
+        channel->discarding = 0;
+    }
+    return control_parse(request->line, request) == 0 ? 1 : -1;
+}
+
+/**
+ * Parses a command line: a command name, optionally followed by its target.
+ *
+ * @param line Command line, without the newline
+ * @param request Filled with the command and its target, -1 if none is given
+ * @return 0 on success, -1 with errno EINVAL otherwise
+ */
+int control_parse(const char* line, ControlRequest* request) {
+    char name[CONTROL_LINE_MAX];
+    char* end;
+    long target = -1;
+    int used;
+
+    if (sscanf(line, "%63s%n", name, &used) == 1) {
+        line += used;
+        while (*line == ' ' || *line == '\t' || *line == '\r') line++;
+        if (*line) {
+            target = strtol(line, &end, 10);
+            while (*end == ' ' || *end == '\t' || *end == '\r') end++;
+            if (end == line || *end || target < 0 || target > INT_MAX) name[0] = '\0';
+        }
+        for (size_t i = 0; i < sizeof(CONTROL_COMMANDS) / sizeof(CONTROL_COMMANDS[0]); i++) {
+            if (strcmp(name, CONTROL_COMMANDS[i]) != 0) continue;
+            request->command = (ControlCommand)(i + CONTROL_DEPART_NOW);
+            request->target = (int)target;
+            return 0;
+        }
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+/**
+ * Name of a command, as written on the channel.
+ */
+const char* control_command_name(ControlCommand command) {
+    return CONTROL_COMMANDS[command - CONTROL_DEPART_NOW];
+}
+
+/**
+ * Closes the control channel and removes its FIFO.
+ *
+ * @param channel Control channel
+ */
+void control_close(ControlChannel* channel) {
+    if (channel->fd == -1) return;
+    close(channel->fd);
+    unlink(channel->path);
+    channel->fd = -1;
+}
@@ -1,12 +1,87 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <sys/msg.h>
 #include <sys/sem.h>
 #include <sys/shm.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
 
 #include "common/ipc.h"
+#include "common/ipc_local.h"
+#include "common/ipc_posix.h"
+#include "common/ipc_ring.h"
+
+static IpcBackend ipc_backend = IPC_BACKEND_SYSV;
+static int ipc_transport = -1;
+
+static const char* const TRANSPORT_NAMES[] = { "sysv", "posix", "ring" };
+
+/**
+ * Selects the implementation behind every wrapper in this file.
+ * Must be called before any IPC object is created.
+ * @param backend IPC_BACKEND_SYSV (default) or IPC_BACKEND_LOCAL
+ */
+void ipc_set_backend(IpcBackend backend) {
+    ipc_backend = backend;
+}
+
+/**
+ * Returns the currently selected IPC backend.
+ */
+IpcBackend ipc_get_backend(void) {
+    return ipc_backend;
+}
+
+/**
+ * Checks a TRANSPORT value.
+ * @param name Transport name, NULL for the default
+ * @return 1 if it names a transport, 0 otherwise
+ */
+int ipc_transport_valid(const char* name) {
+    if (!name) return 1;
+    for (size_t i = 0; i < sizeof(TRANSPORT_NAMES) / sizeof(TRANSPORT_NAMES[0]); i++) {
+        if (strcmp(name, TRANSPORT_NAMES[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Returns the queue transport selected by TRANSPORT.
+ * Read once per process; every role inherits the same environment.
+ * @return Selected transport, IPC_TRANSPORT_SYSV when not set
+ */
+IpcTransport ipc_get_transport(void) {
+    if (ipc_transport == -1) {
+        const char* name = getenv(IPC_TRANSPORT_ENV);
+        ipc_transport = IPC_TRANSPORT_SYSV;
+        for (size_t i = 0; name && i < sizeof(TRANSPORT_NAMES) / sizeof(TRANSPORT_NAMES[0]); i++) {
+            if (strcmp(name, TRANSPORT_NAMES[i]) == 0) ipc_transport = (int)i;
+        }
+    }
+    return (IpcTransport)ipc_transport;
+}
+
+/**
+ * Returns the identifier a participant gives in its requests.
+ * This is the thread ID, which equals the PID in single-threaded processes,
+ * so participants stay distinguishable when roles run as threads of one process.
+ * @return Caller's reply identifier
+ */
+long ipc_self_id(void) {
+    return (long)syscall(SYS_gettid);
+}
+
+/**
+ * Wakes every blocked wait with EINTR.
+ * Only meaningful for the local backend; System V waits are interrupted by signals.
+ */
+void ipc_interrupt_waiters(void) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) local_interrupt_waiters();
+}
 
 /**
  * Creates a new message queue with the specified key.
@@ -14,6 +89,9 @@
  * @return Queue ID on success, -1 on error
  */
 int queue_create(key_t queue_key) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_queue_create(queue_key);
+    if (ipc_get_transport() == IPC_TRANSPORT_POSIX) return posix_queue_create(queue_key);
+    if (ipc_get_transport() == IPC_TRANSPORT_RING) return ring_queue_create(queue_key);
     return msgget(queue_key, IPC_CREAT | IPC_EXCL | 0600);
 }
 
@@ -23,6 +101,9 @@ int queue_create(key_t queue_key) {
  * @return Queue ID on success, -1 on error
  */
 int queue_open(key_t queue_key) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_queue_open(queue_key);
+    if (ipc_get_transport() == IPC_TRANSPORT_POSIX) return posix_queue_open(queue_key);
+    if (ipc_get_transport() == IPC_TRANSPORT_RING) return ring_queue_open(queue_key);
     return msgget(queue_key, 0);
 }
 
@@ -32,6 +113,9 @@ int queue_open(key_t queue_key) {
  * @return 0 on success, -1 on error
  */
 int queue_close(int queue_id) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_queue_close(queue_id);
+    if (ipc_get_transport() == IPC_TRANSPORT_POSIX) return posix_queue_close(queue_id);
+    if (ipc_get_transport() == IPC_TRANSPORT_RING) return ring_queue_close(queue_id);
     return msgctl(queue_id, IPC_RMID, NULL);
 }
 
@@ -48,6 +132,52 @@ int queue_close_if_exists(key_t queue_key) {
     return q;
 }
 
+/**
+ * Sends a message to a queue (msgsnd).
+ * Does NOT retry on EINTR so callers keep their existing retry policy.
+ * @param queue_id The message queue identifier
+ * @param msg Message starting with a long mtype
+ * @param size Size of the message body, excluding mtype
+ * @param flags 0 or IPC_NOWAIT
+ * @return 0 on success, -1 on error
+ */
+int queue_send(int queue_id, const void* msg, size_t size, int flags) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_queue_send(queue_id, msg, size, flags);
+    if (ipc_get_transport() == IPC_TRANSPORT_POSIX) return posix_queue_send(queue_id, msg, size, flags);
+    if (ipc_get_transport() == IPC_TRANSPORT_RING) return ring_queue_send(queue_id, msg, size, flags);
+    return msgsnd(queue_id, msg, size, flags);
+}
+
+/**
+ * Receives a message from a queue (msgrcv).
+ * Does NOT retry on EINTR so callers keep their existing retry policy.
+ * @param queue_id The message queue identifier
+ * @param msg Buffer receiving mtype followed by the message body
+ * @param size Size of the message body, excluding mtype
+ * @param type 0 for any, >0 for exact type, <0 for lowest type <= |type|
+ * @param flags 0 or IPC_NOWAIT
+ * @return Number of bytes received on success, -1 on error
+ */
+ssize_t queue_receive(int queue_id, void* msg, size_t size, long type, int flags) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_queue_receive(queue_id, msg, size, type, flags);
+    if (ipc_get_transport() == IPC_TRANSPORT_POSIX) return posix_queue_receive(queue_id, msg, size, type, flags);
+    if (ipc_get_transport() == IPC_TRANSPORT_RING) return ring_queue_receive(queue_id, msg, size, type, flags);
+    return msgrcv(queue_id, msg, size, type, flags);
+}
+
+/**
+ * Applies a single semaphore operation using the selected backend.
+ * @param sem_id The semaphore set identifier
+ * @param op The operation to perform
+ * @return 0 on success, -1 on error
+ */
+static int sem_apply(int sem_id, struct sembuf* op) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) {
+        return local_sem_op(sem_id, op->sem_num, op->sem_op, op->sem_flg & IPC_NOWAIT);
+    }
+    return semop(sem_id, op, 1);
+}
+
 /**
  * Creates a new semaphore set with the specified key and count.
  * @param sem_key The IPC key for the semaphore set
@@ -56,6 +186,7 @@ int queue_close_if_exists(key_t queue_key) {
  * @return Semaphore set ID on success, -1 on error
  */
 int sem_create(key_t sem_key, int semaphore_count, unsigned short* initial_values) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_sem_create(sem_key, semaphore_count, initial_values);
     int sem_id = semget(sem_key, semaphore_count, IPC_CREAT | IPC_EXCL | 0600);
     if (sem_id == -1) return -1;
 
@@ -78,6 +209,7 @@ int sem_create(key_t sem_key, int semaphore_count, unsigned short* initial_value
  * @return Semaphore set ID on success, -1 on error
  */
 int sem_open(key_t sem_key, int semaphore_count) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_sem_open(sem_key, semaphore_count);
     return semget(sem_key, semaphore_count, IPC_CREAT | 0600);
 }
 
@@ -87,6 +219,7 @@ int sem_open(key_t sem_key, int semaphore_count) {
  * @return 0 on success, -1 on error
  */
 int sem_close(int sem_id) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_sem_close(sem_id);
     return semctl(sem_id, 0, IPC_RMID);
 }
 
@@ -95,6 +228,7 @@ int sem_close(int sem_id) {
  * @param sem_key The IPC key for the semaphore set
  */
 void sem_close_if_exists(key_t sem_key) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return;
     int sem_id = semget(sem_key, 1, 0);
     if (sem_id != -1) {
         sem_close(sem_id);
@@ -109,6 +243,7 @@ void sem_close_if_exists(key_t sem_key) {
  */
 int sem_get_val(int sem_id, unsigned short sem_num) {
     int retval;
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_sem_get_val(sem_id, sem_num);
     while ((retval = semctl(sem_id, sem_num, GETVAL)) == -1) {
         if (errno != EINTR) break;
     }
@@ -125,7 +260,7 @@ int sem_get_val(int sem_id, unsigned short sem_num) {
 int sem_signal_noundo(int sem_id, unsigned short sem_num, int value) {
     int retval;
     struct sembuf op = {sem_num, value, 0};
-    while ((retval = semop(sem_id, &op, 1)) == -1) {
+    while ((retval = sem_apply(sem_id, &op)) == -1) {
         if (errno != EINTR) break;
     }
     return retval;
@@ -141,7 +276,7 @@ int sem_signal_noundo(int sem_id, unsigned short sem_num, int value) {
 int sem_wait_single_noundo(int sem_id, unsigned short sem_num) {
     int retval;
     struct sembuf op = {sem_num, -1, 0};
-    while ((retval = semop(sem_id, &op, 1)) == -1) {
+    while ((retval = sem_apply(sem_id, &op)) == -1) {
         if (errno != EINTR) break;
     }
     return retval;
@@ -157,7 +292,7 @@ int sem_wait_single_noundo(int sem_id, unsigned short sem_num) {
 int sem_wait_single(int sem_id, unsigned short sem_num) {
     int retval;
     struct sembuf op = {sem_num, -1, SEM_UNDO};
-    while ((retval = semop(sem_id, &op, 1)) == -1) {
+    while ((retval = sem_apply(sem_id, &op)) == -1) {
         if (errno != EINTR) break;
     }
     return retval;
@@ -172,7 +307,7 @@ int sem_wait_single(int sem_id, unsigned short sem_num) {
  */
 int sem_wait_single_nointr(int sem_id, unsigned short sem_num) {
     struct sembuf op = {sem_num, -1, SEM_UNDO};
-    return semop(sem_id, &op, 1);
+    return sem_apply(sem_id, &op);
 }
 
 /**
@@ -184,7 +319,23 @@ int sem_wait_single_nointr(int sem_id, unsigned short sem_num) {
  */
 int sem_wait_single_nointr_noundo(int sem_id, unsigned short sem_num) {
     struct sembuf op = {sem_num, -1, 0};
-    return semop(sem_id, &op, 1);
+    return sem_apply(sem_id, &op);
+}
+
+/**
+ * Tries to decrement a single semaphore without blocking and without SEM_UNDO flag.
+ * Retries on EINTR.
+ * @param sem_id The semaphore set identifier
+ * @param sem_num The semaphore number within the set
+ * @return 0 on success, -1 on error (EAGAIN if the semaphore is zero)
+ */
+int sem_trywait_single_noundo(int sem_id, unsigned short sem_num) {
+    int retval;
+    struct sembuf op = {sem_num, -1, IPC_NOWAIT};
+    while ((retval = sem_apply(sem_id, &op)) == -1) {
+        if (errno != EINTR) break;
+    }
+    return retval;
 }
 
 /**
@@ -197,7 +348,7 @@ int sem_wait_single_nointr_noundo(int sem_id, unsigned short sem_num) {
 int sem_signal_single_noundo(int sem_id, unsigned short sem_num) {
     int retval;
     struct sembuf op = {sem_num, 1, 0};
-    while ((retval = semop(sem_id, &op, 1)) == -1) {
+    while ((retval = sem_apply(sem_id, &op)) == -1) {
         if (errno != EINTR) break;
     }
     return retval;
@@ -213,7 +364,7 @@ int sem_signal_single_noundo(int sem_id, unsigned short sem_num) {
 int sem_signal_single(int sem_id, unsigned short sem_num) {
     int retval;
     struct sembuf op = {sem_num, 1, SEM_UNDO};
-    while ((retval = semop(sem_id, &op, 1)) == -1) {
+    while ((retval = sem_apply(sem_id, &op)) == -1) {
         if (errno != EINTR) break;
     }
     return retval;
@@ -226,6 +377,7 @@ int sem_signal_single(int sem_id, unsigned short sem_num) {
  * @return Shared memory ID on success, -1 on error
  */
 int shm_create(key_t shm_key, size_t size) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_shm_create(shm_key, size);
     return shmget(shm_key, size, IPC_CREAT | 0600);
 }
 
@@ -235,6 +387,7 @@ int shm_create(key_t shm_key, size_t size) {
  * @return Shared memory ID on success, -1 on error
  */
 int shm_open(key_t shm_key) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_shm_open(shm_key);
     return shmget(shm_key, 0, 0);
 }
 
@@ -245,6 +398,7 @@ int shm_open(key_t shm_key) {
  * @return 0 on success, -1 on error
  */
 int shm_close(int shm_id) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_shm_close(shm_id);
     return shmctl(shm_id, IPC_RMID, NULL);
 }
 
@@ -265,6 +419,7 @@ void shm_close_if_exists(key_t shm_key) {
  * @return Pointer to the attached memory on success, (void*)-1 on error
  */
 void* shm_attach(int shm_id) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return local_shm_attach(shm_id);
     return shmat(shm_id, NULL, 0);
 }
 
@@ -274,5 +429,77 @@ void* shm_attach(int shm_id) {
  * @return 0 on success, -1 on error
  */
 int shm_detach(const void* addr) {
+    if (ipc_backend == IPC_BACKEND_LOCAL) return 0;
     return shmdt(addr);
-}
\ No newline at end of file
+}
+
+// Objects every terminal has its own copy of, in the order of their terminal key ids
+static const int IPC_TERMINAL_KEY_IDS[IPC_KEY_TERMINAL_STRIDE] = {
+    IPC_KEY_SHM_ID,
+    IPC_KEY_SEM_SECURITY_ID,
+    IPC_KEY_SEM_RAMP_ID,
+    IPC_KEY_SEM_CURRENT_FERRY
+};
+
+/**
+ * Generates the key of a terminal's copy of an IPC object.
+ * Terminal 0 uses the plain ids, so a single-terminal port keeps its keys.
+ * @param ipc_key Path used to generate IPC keys
+ * @param id IPC_KEY_* id of the object
+ * @param terminal Terminal index
+ * @return IPC key, -1 on error
+ */
+key_t ipc_terminal_key(const char* ipc_key, int id, int terminal) {
+    if (terminal == 0) return ftok(ipc_key, id);
+    for (int slot = 0; slot < IPC_KEY_TERMINAL_STRIDE; slot++) {
+        if (IPC_TERMINAL_KEY_IDS[slot] == id) {
+            return ftok(ipc_key, IPC_KEY_TERMINAL_BASE + (terminal - 1) * IPC_KEY_TERMINAL_STRIDE + slot);
+        }
+    }
+    // Not a per-terminal object: shared by every terminal
+    return ftok(ipc_key, id);
+}
+
+/**
+ * Opens every IPC object of a terminal created by the main process.
+ * The log queue is optional: roles log nothing if it is missing.
+ * @param ipc_key Path used to generate IPC keys
+ * @param terminal Terminal index, 0 for a single-terminal port
+ * @param handles Filled with the object identifiers
+ * @return 0 on success, -1 if a required object cannot be opened
+ */
+int ipc_handles_open(const char* ipc_key, int terminal, IpcHandles* handles) {
+    key_t log_queue_key = ftok(ipc_key, IPC_KEY_LOG_ID);
+
+    handles->terminal = terminal;
+    handles->log_queue = log_queue_key != -1 ? queue_open(log_queue_key) : -1;
+    handles->sem_security = sem_open(ipc_terminal_key(ipc_key, IPC_KEY_SEM_SECURITY_ID, terminal), 1);
+    handles->sem_ramp = sem_open(ipc_terminal_key(ipc_key, IPC_KEY_SEM_RAMP_ID, terminal), 1);
+    handles->sem_current_ferry = sem_open(ipc_terminal_key(ipc_key, IPC_KEY_SEM_CURRENT_FERRY, terminal), 1);
+    handles->shm_id = shm_open(ipc_terminal_key(ipc_key, IPC_KEY_SHM_ID, terminal));
+    handles->shm = handles->shm_id != -1 ? shm_attach(handles->shm_id) : (void*)-1;
+    // A segment laid out by another build is not ours to read
+    if (handles->shm != (void*)-1 && shared_state_check((const SharedState*)handles->shm) != 0) {
+        shm_detach(handles->shm);
+        handles->shm = (void*)-1;
+    }
+
+    if (handles->sem_security == -1 ||
+        handles->sem_ramp == -1 || handles->sem_current_ferry == -1 ||
+        handles->shm == (void*)-1) {
+        if (handles->shm != (void*)-1) shm_detach(handles->shm);
+        handles->shm = (void*)-1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Releases what ipc_handles_open acquired for this process.
+ * The objects themselves stay, they are removed by the main process.
+ * @param handles Handles returned by ipc_handles_open
+ */
+void ipc_handles_close(IpcHandles* handles) {
+    if (handles->shm != (void*)-1) shm_detach(handles->shm);
+    handles->shm = (void*)-1;
+}
@@ -0,0 +1,618 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "common/ipc_local.h"
+
+/**
+ * A queued message. The payload holds the mtype followed by the message body,
+ * exactly as it was passed to local_queue_send.
+ */
+typedef struct LocalMessage {
+    struct LocalMessage* next;
+    long type;
+    size_t size;
+    char payload[];
+} LocalMessage;
+
+/**
+ * A thread blocked in local_queue_receive. Each waiter owns its condition
+ * variable so a send wakes exactly one receiver that can accept the message.
+ */
+typedef struct LocalWaiter {
+    struct LocalWaiter* next;
+    long type;
+    int woken;
+    pthread_cond_t cond;
+} LocalWaiter;
+
+typedef struct LocalQueue {
+    int in_use;
+    int removed;
+    key_t key;
+    size_t bytes;
+    LocalMessage* head;
+    LocalMessage* tail;
+    LocalWaiter* waiters;
+    pthread_cond_t not_full;
+} LocalQueue;
+
+typedef struct LocalSemaphore {
+    int value;
+    pthread_cond_t cond;
+} LocalSemaphore;
+
+typedef struct LocalSemSet {
+    int in_use;
+    int removed;
+    key_t key;
+    int count;
+    LocalSemaphore* sems;
+} LocalSemSet;
+
+typedef struct LocalShm {
+    int in_use;
+    key_t key;
+    size_t size;
+    void* addr;
+} LocalShm;
+
+// A single lock guards every local object. Contention is dominated by the
+// waits themselves, and one lock keeps interrupt delivery trivially consistent.
+static pthread_mutex_t local_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long interrupt_generation = 0;
+
+static LocalQueue queues[LOCAL_IPC_MAX_OBJECTS];
+static LocalSemSet sem_sets[LOCAL_IPC_MAX_OBJECTS];
+static LocalShm shm_segments[LOCAL_IPC_MAX_OBJECTS];
+
+/**
+ * Checks whether a message type satisfies a msgrcv-style type selector.
+ * @param selector 0 for any, >0 for exact match, <0 for any type <= |selector|
+ * @param type Message type
+ * @return 1 on match, 0 otherwise
+ */
+static int type_matches(long selector, long type) {
+    if (selector == 0) return 1;
+    if (selector > 0) return type == selector;
+    return type <= -selector;
+}
+
+/**
+ * Looks up a live queue by identifier. Caller must hold local_lock.
+ * @return Queue pointer or NULL with errno set to EINVAL
+ */
+static LocalQueue* queue_get(int queue_id) {
+    if (queue_id < 0 || queue_id >= LOCAL_IPC_MAX_OBJECTS || !queues[queue_id].in_use || queues[queue_id].removed) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return &queues[queue_id];
+}
+
+/**
+ * Recycles the slot of a removed queue once nobody uses it. Caller must hold local_lock.
+ */
+static void queue_release_if_idle(LocalQueue* queue) {
+    if (queue->removed && !queue->waiters && !queue->head) queue->in_use = 0;
+}
+
+/**
+ * Looks up a live semaphore set by identifier. Caller must hold local_lock.
+ * @return Semaphore set pointer or NULL with errno set to EINVAL
+ */
+static LocalSemSet* sem_set_get(int sem_id) {
+    if (sem_id < 0 || sem_id >= LOCAL_IPC_MAX_OBJECTS || !sem_sets[sem_id].in_use || sem_sets[sem_id].removed) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return &sem_sets[sem_id];
+}
+
+/**
+ * Creates a new process-local message queue.
+ * @param queue_key Key identifying the queue
+ * @return Queue ID on success, -1 on error (EEXIST if key is taken, ENOSPC if table is full)
+ */
+int local_queue_create(key_t queue_key) {
+    int queue_id = -1;
+
+    pthread_mutex_lock(&local_lock);
+    for (int i = 0; i < LOCAL_IPC_MAX_OBJECTS; i++) {
+        if (queues[i].in_use && !queues[i].removed && queues[i].key == queue_key) {
+            pthread_mutex_unlock(&local_lock);
+            errno = EEXIST;
+            return -1;
+        }
+        if (queue_id == -1 && !queues[i].in_use) queue_id = i;
+    }
+    if (queue_id == -1) {
+        pthread_mutex_unlock(&local_lock);
+        errno = ENOSPC;
+        return -1;
+    }
+    memset(&queues[queue_id], 0, sizeof(LocalQueue));
+    queues[queue_id].in_use = 1;
+    queues[queue_id].key = queue_key;
+    pthread_cond_init(&queues[queue_id].not_full, NULL);
+    pthread_mutex_unlock(&local_lock);
+    return queue_id;
+}
+
+/**
+ * Opens an existing process-local message queue.
+ * @param queue_key Key identifying the queue
+ * @return Queue ID on success, -1 with errno ENOENT if it does not exist
+ */
+int local_queue_open(key_t queue_key) {
+    pthread_mutex_lock(&local_lock);
+    for (int i = 0; i < LOCAL_IPC_MAX_OBJECTS; i++) {
+        if (queues[i].in_use && !queues[i].removed && queues[i].key == queue_key) {
+            pthread_mutex_unlock(&local_lock);
+            return i;
+        }
+    }
+    pthread_mutex_unlock(&local_lock);
+    errno = ENOENT;
+    return -1;
+}
+
+/**
+ * Removes a process-local queue. New sends fail with EIDRM and blocked senders
+ * are released. Unlike System V, messages already queued are still delivered;
+ * receivers get EIDRM once nothing matching is left, so a logger draining the
+ * queue does not lose the final entries.
+ * @param queue_id Queue identifier
+ * @return 0 on success, -1 on error
+ */
+int local_queue_close(int queue_id) {
+    LocalQueue* queue;
+
+    pthread_mutex_lock(&local_lock);
+    if ((queue = queue_get(queue_id)) == NULL) {
+        pthread_mutex_unlock(&local_lock);
+        return -1;
+    }
+    queue->removed = 1;
+    for (LocalWaiter* waiter = queue->waiters; waiter; waiter = waiter->next) {
+        pthread_cond_signal(&waiter->cond);
+    }
+    pthread_cond_broadcast(&queue->not_full);
+    queue_release_if_idle(queue);
+    pthread_mutex_unlock(&local_lock);
+    return 0;
+}
+
+/**
+ * Appends a message to a process-local queue (msgsnd semantics).
+ * Blocks while the queue holds LOCAL_QUEUE_MAX_BYTES unless IPC_NOWAIT is set.
+ * @param queue_id Queue identifier
+ * @param msg Message starting with a long mtype
+ * @param size Size of the message body, excluding mtype
+ * @param flags 0 or IPC_NOWAIT
+ * @return 0 on success, -1 on error (EAGAIN, EINTR, EIDRM, EINVAL)
+ */
+int local_queue_send(int queue_id, const void* msg, size_t size, int flags) {
+    LocalQueue* queue;
+    LocalMessage* entry;
+    LocalWaiter** link;
+    unsigned long generation;
+    size_t total = sizeof(long) + size;
+
+    entry = malloc(sizeof(LocalMessage) + total);
+    if (!entry) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(entry->payload, msg, total);
+    entry->type = *(const long*)msg;
+    entry->size = size;
+    entry->next = NULL;
+
+    pthread_mutex_lock(&local_lock);
+    generation = interrupt_generation;
+    while (1) {
+        if ((queue = queue_get(queue_id)) == NULL) {
+            if (queue_id >= 0 && queue_id < LOCAL_IPC_MAX_OBJECTS && queues[queue_id].removed) errno = EIDRM;
+            pthread_mutex_unlock(&local_lock);
+            free(entry);
+            return -1;
+        }
+        if (queue->bytes + size <= LOCAL_QUEUE_MAX_BYTES || !queue->head) break;
+        if (flags & IPC_NOWAIT) {
+            pthread_mutex_unlock(&local_lock);
+            free(entry);
+            errno = EAGAIN;
+            return -1;
+        }
+        if (generation != interrupt_generation) {
+            pthread_mutex_unlock(&local_lock);
+            free(entry);
+            errno = EINTR;
+            return -1;
+        }
+        pthread_cond_wait(&queue->not_full, &local_lock);
+    }
+
+    if (queue->tail) queue->tail->next = entry; else queue->head = entry;
+    queue->tail = entry;
+    queue->bytes += size;
+
+    // Hand the message to the first receiver that is able to take it
+    for (link = &queue->waiters; *link; link = &(*link)->next) {
+        if (!(*link)->woken && type_matches((*link)->type, entry->type)) {
+            (*link)->woken = 1;
+            pthread_cond_signal(&(*link)->cond);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&local_lock);
+    return 0;
+}
+
+/**
+ * Removes the first message matching a type selector (msgrcv semantics).
+ * @param queue_id Queue identifier
+ * @param msg Buffer receiving mtype followed by the body
+ * @param size Size of the body buffer, excluding mtype
+ * @param type 0 for first message, >0 for exact type, <0 for lowest type <= |type|
+ * @param flags 0 or IPC_NOWAIT
+ * @return Body size on success, -1 on error (ENOMSG, EINTR, EIDRM, EINVAL, E2BIG)
+ */
+ssize_t local_queue_receive(int queue_id, void* msg, size_t size, long type, int flags) {
+    LocalQueue* queue;
+    LocalMessage** link;
+    LocalMessage** found;
+    LocalMessage* prev;
+    LocalMessage* found_prev;
+    LocalMessage* entry;
+    LocalWaiter waiter;
+    unsigned long generation;
+    ssize_t received;
+
+    if (queue_id < 0 || queue_id >= LOCAL_IPC_MAX_OBJECTS) {
+        errno = EINVAL;
+        return -1;
+    }
+    queue = &queues[queue_id];
+
+    pthread_mutex_lock(&local_lock);
+    generation = interrupt_generation;
+    while (1) {
+        if (!queue->in_use) {
+            pthread_mutex_unlock(&local_lock);
+            errno = EINVAL;
+            return -1;
+        }
+
+        // Find the first matching message, or the lowest type for negative selectors
+        found = NULL;
+        found_prev = NULL;
+        prev = NULL;
+        for (link = &queue->head; *link; prev = *link, link = &(*link)->next) {
+            if (!type_matches(type, (*link)->type)) continue;
+            if (!found || (type < 0 && (*link)->type < (*found)->type)) {
+                found = link;
+                found_prev = prev;
+                if (type >= 0) break;
+            }
+        }
+        if (found) break;
+
+        if (queue->removed) {
+            queue_release_if_idle(queue);
+            pthread_mutex_unlock(&local_lock);
+            errno = EIDRM;
+            return -1;
+        }
+        if (flags & IPC_NOWAIT) {
+            pthread_mutex_unlock(&local_lock);
+            errno = ENOMSG;
+            return -1;
+        }
+        if (generation != interrupt_generation) {
+            pthread_mutex_unlock(&local_lock);
+            errno = EINTR;
+            return -1;
+        }
+
+        waiter.type = type;
+        waiter.woken = 0;
+        pthread_cond_init(&waiter.cond, NULL);
+        waiter.next = queue->waiters;
+        queue->waiters = &waiter;
+        pthread_cond_wait(&waiter.cond, &local_lock);
+        for (LocalWaiter** w = &queue->waiters; *w; w = &(*w)->next) {
+            if (*w == &waiter) {
+                *w = waiter.next;
+                break;
+            }
+        }
+        pthread_cond_destroy(&waiter.cond);
+    }
+
+    entry = *found;
+    if (entry->size > size) {
+        pthread_mutex_unlock(&local_lock);
+        errno = E2BIG;
+        return -1;
+    }
+    *found = entry->next;
+    if (queue->tail == entry) queue->tail = found_prev;
+    queue->bytes -= entry->size;
+    pthread_cond_signal(&queue->not_full);
+    queue_release_if_idle(queue);
+    pthread_mutex_unlock(&local_lock);
+
+    memcpy(msg, entry->payload, sizeof(long) + entry->size);
+    received = (ssize_t)entry->size;
+    free(entry);
+    return received;
+}
+
+/**
+ * Creates a new process-local semaphore set.
+ * @param sem_key Key identifying the set
+ * @param semaphore_count Number of semaphores in the set
+ * @param initial_values Initial values (can be NULL for all zero)
+ * @return Semaphore set ID on success, -1 on error
+ */
+int local_sem_create(key_t sem_key, int semaphore_count, unsigned short* initial_values) {
+    int sem_id = -1;
+    LocalSemSet* set;
+
+    pthread_mutex_lock(&local_lock);
+    for (int i = 0; i < LOCAL_IPC_MAX_OBJECTS; i++) {
+        if (sem_sets[i].in_use && !sem_sets[i].removed && sem_sets[i].key == sem_key) {
+            pthread_mutex_unlock(&local_lock);
+            errno = EEXIST;
+            return -1;
+        }
+        if (sem_id == -1 && !sem_sets[i].in_use) sem_id = i;
+    }
+    if (sem_id == -1) {
+        pthread_mutex_unlock(&local_lock);
+        errno = ENOSPC;
+        return -1;
+    }
+    set = &sem_sets[sem_id];
+    set->sems = calloc(semaphore_count, sizeof(LocalSemaphore));
+    if (!set->sems) {
+        pthread_mutex_unlock(&local_lock);
+        errno = ENOMEM;
+        return -1;
+    }
+    set->in_use = 1;
+    set->removed = 0;
+    set->key = sem_key;
+    set->count = semaphore_count;
+    for (int i = 0; i < semaphore_count; i++) {
+        set->sems[i].value = initial_values ? initial_values[i] : 0;
+        pthread_cond_init(&set->sems[i].cond, NULL);
+    }
+    pthread_mutex_unlock(&local_lock);
+    return sem_id;
+}
+
+/**
+ * Opens an existing process-local semaphore set or creates it (zeroed) if missing.
+ * @param sem_key Key identifying the set
+ * @param semaphore_count Number of semaphores in the set
+ * @return Semaphore set ID on success, -1 on error
+ */
+int local_sem_open(key_t sem_key, int semaphore_count) {
+    pthread_mutex_lock(&local_lock);
+    for (int i = 0; i < LOCAL_IPC_MAX_OBJECTS; i++) {
+        if (sem_sets[i].in_use && !sem_sets[i].removed && sem_sets[i].key == sem_key) {
+            pthread_mutex_unlock(&local_lock);
+            return i;
+        }
+    }
+    pthread_mutex_unlock(&local_lock);
+    return local_sem_create(sem_key, semaphore_count, NULL);
+}
+
+/**
+ * Removes a process-local semaphore set. Blocked waiters fail with EIDRM.
+ * @param sem_id Semaphore set identifier
+ * @return 0 on success, -1 on error
+ */
+int local_sem_close(int sem_id) {
+    LocalSemSet* set;
+
+    pthread_mutex_lock(&local_lock);
+    if ((set = sem_set_get(sem_id)) == NULL) {
+        pthread_mutex_unlock(&local_lock);
+        return -1;
+    }
+    set->removed = 1;
+    for (int i = 0; i < set->count; i++) {
+        pthread_cond_broadcast(&set->sems[i].cond);
+    }
+    pthread_mutex_unlock(&local_lock);
+    return 0;
+}
+
+/**
+ * Reads the current value of a process-local semaphore.
+ * @return Semaphore value on success, -1 on error
+ */
+int local_sem_get_val(int sem_id, unsigned short sem_num) {
+    LocalSemSet* set;
+    int value;
+
+    pthread_mutex_lock(&local_lock);
+    if ((set = sem_set_get(sem_id)) == NULL || sem_num >= set->count) {
+        pthread_mutex_unlock(&local_lock);
+        errno = EINVAL;
+        return -1;
+    }
+    value = set->sems[sem_num].value;
+    pthread_mutex_unlock(&local_lock);
+    return value;
+}
+
+/**
+ * Applies a semop-style operation to a process-local semaphore.
+ * Positive values signal, -1 waits until the value can be decremented.
+ * Waits return EINTR when local_interrupt_waiters is called, mirroring a
+ * signal interrupting semop in the process engine.
+ * @param sem_id Semaphore set identifier
+ * @param sem_num Semaphore number within the set
+ * @param value Amount to add (negative to wait)
+ * @param nowait Fail with EAGAIN instead of blocking
+ * @return 0 on success, -1 on error
+ */
+int local_sem_op(int sem_id, unsigned short sem_num, int value, int nowait) {
+    LocalSemSet* set;
+    LocalSemaphore* sem;
+    unsigned long generation;
+
+    pthread_mutex_lock(&local_lock);
+    generation = interrupt_generation;
+    if ((set = sem_set_get(sem_id)) == NULL || sem_num >= set->count) {
+        pthread_mutex_unlock(&local_lock);
+        errno = EINVAL;
+        return -1;
+    }
+    sem = &set->sems[sem_num];
+
+    if (value >= 0) {
+        sem->value += value;
+        if (value == 1) pthread_cond_signal(&sem->cond);
+        else if (value > 1) pthread_cond_broadcast(&sem->cond);
+        pthread_mutex_unlock(&local_lock);
+        return 0;
+    }
+
+    while (sem->value + value < 0) {
+        if (nowait) {
+            pthread_mutex_unlock(&local_lock);
+            errno = EAGAIN;
+            return -1;
+        }
+        if (generation != interrupt_generation) {
+            pthread_mutex_unlock(&local_lock);
+            errno = EINTR;
+            return -1;
+        }
+        pthread_cond_wait(&sem->cond, &local_lock);
+        if (set->removed) {
+            pthread_mutex_unlock(&local_lock);
+            errno = EIDRM;
+            return -1;
+        }
+    }
+    sem->value += value;
+    pthread_mutex_unlock(&local_lock);
+    return 0;
+}
+
+/**
+ * Allocates (or returns the existing) process-local shared segment.
+ * @param shm_key Key identifying the segment
+ * @param size Segment size in bytes, zero-initialized
+ * @return Segment ID on success, -1 on error
+ */
+int local_shm_create(key_t shm_key, size_t size) {
+    int shm_id = -1;
+
+    pthread_mutex_lock(&local_lock);
+    for (int i = 0; i < LOCAL_IPC_MAX_OBJECTS; i++) {
+        if (shm_segments[i].in_use && shm_segments[i].key == shm_key) {
+            pthread_mutex_unlock(&local_lock);
+            return i;
+        }
+        if (shm_id == -1 && !shm_segments[i].in_use) shm_id = i;
+    }
+    // Aligned like a System V segment would be, as far as cache lines go
+    if (shm_id == -1 || posix_memalign(&shm_segments[shm_id].addr, LOCAL_SHM_ALIGNMENT, size) != 0) {
+        pthread_mutex_unlock(&local_lock);
+        errno = shm_id == -1 ? ENOSPC : ENOMEM;
+        return -1;
+    }
+    memset(shm_segments[shm_id].addr, 0, size);
+    shm_segments[shm_id].in_use = 1;
+    shm_segments[shm_id].key = shm_key;
+    shm_segments[shm_id].size = size;
+    pthread_mutex_unlock(&local_lock);
+    return shm_id;
+}
+
+/**
+ * Finds an existing process-local segment.
+ * @return Segment ID on success, -1 with errno ENOENT otherwise
+ */
+int local_shm_open(key_t shm_key) {
+    pthread_mutex_lock(&local_lock);
+    for (int i = 0; i < LOCAL_IPC_MAX_OBJECTS; i++) {
+        if (shm_segments[i].in_use && shm_segments[i].key == shm_key) {
+            pthread_mutex_unlock(&local_lock);
+            return i;
+        }
+    }
+    pthread_mutex_unlock(&local_lock);
+    errno = ENOENT;
+    return -1;
+}
+
+/**
+ * Frees a process-local segment. All threads must be done with it.
+ * @return 0 on success, -1 on error
+ */
+int local_shm_close(int shm_id) {
+    pthread_mutex_lock(&local_lock);
+    if (shm_id < 0 || shm_id >= LOCAL_IPC_MAX_OBJECTS || !shm_segments[shm_id].in_use) {
+        pthread_mutex_unlock(&local_lock);
+        errno = EINVAL;
+        return -1;
+    }
+    free(shm_segments[shm_id].addr);
+    memset(&shm_segments[shm_id], 0, sizeof(LocalShm));
+    pthread_mutex_unlock(&local_lock);
+    return 0;
+}
+
+/**
+ * Returns the address of a process-local segment.
+ * @return Segment address on success, (void*)-1 on error
+ */
+void* local_shm_attach(int shm_id) {
+    void* addr;
+
+    pthread_mutex_lock(&local_lock);
+    if (shm_id < 0 || shm_id >= LOCAL_IPC_MAX_OBJECTS || !shm_segments[shm_id].in_use) {
+        pthread_mutex_unlock(&local_lock);
+        errno = EINVAL;
+        return (void*)-1;
+    }
+    addr = shm_segments[shm_id].addr;
+    pthread_mutex_unlock(&local_lock);
+    return addr;
+}
+
+/**
+ * Interrupts every blocked local wait with EINTR.
+ * This is the threaded counterpart of broadcasting a signal to the process group:
+ * wrappers that retry on EINTR simply wait again, while the *_nointr variants
+ * return to the caller so it can notice port closure.
+ */
+void local_interrupt_waiters(void) {
+    pthread_mutex_lock(&local_lock);
+    interrupt_generation++;
+    for (int i = 0; i < LOCAL_IPC_MAX_OBJECTS; i++) {
+        if (queues[i].in_use) {
+            for (LocalWaiter* waiter = queues[i].waiters; waiter; waiter = waiter->next) {
+                pthread_cond_signal(&waiter->cond);
+            }
+            pthread_cond_broadcast(&queues[i].not_full);
+        }
+        if (sem_sets[i].in_use) {
+            for (int j = 0; j < sem_sets[i].count; j++) {
+                pthread_cond_broadcast(&sem_sets[i].sems[j].cond);
+            }
+        }
+    }
+    pthread_mutex_unlock(&local_lock);
+}
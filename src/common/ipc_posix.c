@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <mqueue.h>
+#include <sys/msg.h>
+
+#include "common/ipc_posix.h"
+
+/**
+ * A POSIX queue this process has opened for one type of a channel.
+ * Forked roles inherit the descriptors along with the table.
+ *
+ * A type-0 receive must return the oldest message of every channel, which
+ * no single queue can tell: the receiver takes the head of each channel into
+ * the table and returns the one sent first. The heads it did not return stay
+ * held by the receiving process for its next receive, so a queue read by
+ * several processes may only be read with exact types. The log queue has
+ * a single reader, the logger.
+ */
+typedef struct PosixChannel {
+    int queue_id;
+    long type;
+    mqd_t mq;
+    ssize_t held;                   // Size of the held head, -1 if none
+    char head[POSIX_MQ_MESSAGE_MAX];
+} PosixChannel;
+
+// What a channel carries: the send sequence, then mtype and the message body
+typedef struct PosixEnvelope {
+    unsigned long long sequence;    // CLOCK_MONOTONIC at send, in ns: the order messages were sent in
+    long mtype;
+} PosixEnvelope;
+
+/**
+ * A queue this process has created or opened, with the key its channels are
+ * named after.
+ */
+typedef struct PosixQueue {
+    int queue_id;
+    key_t key;
+} PosixQueue;
+
+static PosixChannel channels[POSIX_MQ_MAX_OPEN];
+static int channel_count = 0;
+static PosixQueue queues[POSIX_MQ_MAX_QUEUES];
+static int queue_count = 0;
+
+/**
+ * Records the key of a queue, so its channels can be named later.
+ * @param queue_id The message queue identifier
+ * @param queue_key The IPC key it was created or opened with
+ * @return 0 on success, -1 with errno EMFILE if the table is full
+ */
+static int posix_queue_remember(int queue_id, key_t queue_key) {
+    int i;
+
+    for (i = 0; i < queue_count && queues[i].queue_id != queue_id; i++) {}
+    if (i == POSIX_MQ_MAX_QUEUES) {
+        errno = EMFILE;
+        return -1;
+    }
+    if (i == queue_count) queue_count++;
+    queues[i].queue_id = queue_id;
+    queues[i].key = queue_key;
+    return 0;
+}
+
+/**
+ * Looks up the key of a queue this process has created or opened.
+ * @param queue_id The message queue identifier
+ * @param queue_key Filled with the key
+ * @return 0 on success, -1 with errno EINVAL for an unknown queue
+ */
+static int posix_queue_key(int queue_id, key_t* queue_key) {
+    for (int i = 0; i < queue_count; i++) {
+        if (queues[i].queue_id == queue_id) {
+            *queue_key = queues[i].key;
+            return 0;
+        }
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+/**
+ * Checks whether a message type has a channel.
+ * @param type Message type
+ * @return 1 for types 1..POSIX_MQ_CHANNEL_TYPES, 0 otherwise
+ */
+static int posix_channel_type(long type) {
+    return type >= 1 && type <= POSIX_MQ_CHANNEL_TYPES;
+}
+
+static void posix_channel_name(key_t queue_key, long type, char* name, size_t size) {
+    snprintf(name, size, "/ferry-%08x-%lx", (unsigned int)queue_key, type);
+}
+
+/**
+ * Removes the POSIX queues of every channel type of a queue.
+ * Descriptors still open keep working until they are closed.
+ * @param queue_key The IPC key for the message queue
+ */
+static void posix_channels_unlink(key_t queue_key) {
+    char name[64];
+
+    for (long type = 1; type <= POSIX_MQ_CHANNEL_TYPES; type++) {
+        posix_channel_name(queue_key, type, name, sizeof(name));
+        mq_unlink(name);
+    }
+}
+
+/**
+ * Checks whether the System V queue behind a channel is gone.
+ * @param queue_id The message queue identifier
+ * @return 1 with errno set if removed, 0 otherwise
+ */
+static int posix_queue_removed(int queue_id) {
+    struct msqid_ds info;
+    return msgctl(queue_id, IPC_STAT, &info) == -1;
+}
+
+/**
+ * Returns the channel of one type, opening its POSIX queue on first use.
+ * The queue is created by whichever side gets there first, sized for the
+ * envelope it carries.
+ * @param queue_id The message queue identifier
+ * @param type Channel type
+ * @param message_size Size of the envelope: sequence, mtype and message body
+ * @return Channel on success, NULL on error
+ */
+static PosixChannel* posix_channel_open(int queue_id, long type, size_t message_size) {
+    struct mq_attr attr;
+    key_t queue_key;
+    char name[64];
+    mqd_t mq;
+
+    for (int i = 0; i < channel_count; i++) {
+        if (channels[i].queue_id == queue_id && channels[i].type == type) return &channels[i];
+    }
+    if (channel_count == POSIX_MQ_MAX_OPEN) {
+        errno = EMFILE;
+        return NULL;
+    }
+    if (posix_queue_key(queue_id, &queue_key) == -1) return NULL;
+    // Creating a channel of a removed queue would leak it
+    if (posix_queue_removed(queue_id)) return NULL;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.mq_maxmsg = POSIX_MQ_MAX_MESSAGES;
+    attr.mq_msgsize = message_size;
+    posix_channel_name(queue_key, type, name, sizeof(name));
+    // Blocking, so a full channel hands each free slot to the sender waiting longest
+    mq = mq_open(name, O_RDWR | O_CREAT, 0600, &attr);
+    if (mq == (mqd_t)-1) return NULL;
+
+    channels[channel_count].queue_id = queue_id;
+    channels[channel_count].type = type;
+    channels[channel_count].mq = mq;
+    channels[channel_count].held = -1;
+    return &channels[channel_count++];
+}
+
+/**
+ * Computes the CLOCK_REALTIME deadline mq_timedsend and mq_timedreceive take.
+ * @param deadline Filled with the deadline
+ * @param timeout_ms Milliseconds from now, 0 for a deadline already passed
+ */
+static void posix_deadline(struct timespec* deadline, int timeout_ms) {
+    if (!timeout_ms) {
+        deadline->tv_sec = 0;
+        deadline->tv_nsec = 0;
+        return;
+    }
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * Creates the System V queue marking the channels and clears channels left
+ * over from an earlier run with the same key.
+ * @param queue_key The IPC key for the message queue
+ * @return Queue ID on success, -1 on error
+ */
+int posix_queue_create(key_t queue_key) {
+    int queue_id = msgget(queue_key, IPC_CREAT | IPC_EXCL | 0600);
+
+    if (queue_id == -1) return -1;
+    if (posix_queue_remember(queue_id, queue_key) == -1) {
+        msgctl(queue_id, IPC_RMID, NULL);
+        return -1;
+    }
+    posix_channels_unlink(queue_key);
+    return queue_id;
+}
+
+/**
+ * Opens an existing queue. Channels are opened on first use.
+ * @param queue_key The IPC key for the message queue
+ * @return Queue ID on success, -1 on error
+ */
+int posix_queue_open(key_t queue_key) {
+    int queue_id = msgget(queue_key, 0);
+
+    if (queue_id == -1 || posix_queue_remember(queue_id, queue_key) == -1) return -1;
+    return queue_id;
+}
+
+/**
+ * Removes a queue with all of its channels. Blocked waiters notice within
+ * POSIX_MQ_POLL_MS and fail with EIDRM or EINVAL.
+ * @param queue_id The message queue identifier
+ * @return 0 on success, -1 on error
+ */
+int posix_queue_close(int queue_id) {
+    key_t queue_key;
+    int kept = 0;
+
+    if (posix_queue_key(queue_id, &queue_key) == -1) return -1;
+    posix_channels_unlink(queue_key);
+    for (int i = 0; i < channel_count; i++) {
+        if (channels[i].queue_id == queue_id) {
+            mq_close(channels[i].mq);
+            continue;
+        }
+        channels[kept++] = channels[i];
+    }
+    channel_count = kept;
+    for (int i = 0; i < queue_count; i++) {
+        if (queues[i].queue_id == queue_id) queues[i] = queues[--queue_count];
+    }
+    return msgctl(queue_id, IPC_RMID, NULL);
+}
+
+/**
+ * Sends a message to the POSIX queue of its type, stamped with the time it
+ * was sent.
+ * Does NOT retry on EINTR, like msgsnd.
+ * @param queue_id The message queue identifier
+ * @param msg Message starting with a long mtype
+ * @param size Size of the message body, excluding mtype
+ * @param flags 0 or IPC_NOWAIT
+ * @return 0 on success, -1 on error, errno EINVAL for a type without a channel
+ */
+int posix_queue_send(int queue_id, const void* msg, size_t size, int flags) {
+    long type = *(const long*)msg;
+    size_t message_size = size + sizeof(long);
+    size_t envelope_size = message_size + offsetof(PosixEnvelope, mtype);
+    char envelope[POSIX_MQ_MESSAGE_MAX] __attribute__((aligned(sizeof(PosixEnvelope))));
+    struct timespec now;
+    struct timespec deadline;
+    PosixChannel* channel;
+
+    if (!posix_channel_type(type) || envelope_size > sizeof(envelope)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(channel = posix_channel_open(queue_id, type, envelope_size))) return -1;
+
+    memcpy(envelope + offsetof(PosixEnvelope, mtype), msg, message_size);
+
+    while (1) {
+        // Stamped at every attempt: a sender that waited for room was not first
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        ((PosixEnvelope*)envelope)->sequence = (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+        posix_deadline(&deadline, (flags & IPC_NOWAIT) ? 0 : POSIX_MQ_POLL_MS);
+        if (mq_timedsend(channel->mq, envelope, envelope_size, 0, &deadline) == 0) break;
+        if (errno != ETIMEDOUT) return -1;
+        if (flags & IPC_NOWAIT) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (posix_queue_removed(queue_id)) return -1;
+    }
+    return 0;
+}
+
+/**
+ * Receives a message with msgrcv-style type selection over the channel types
+ * 1..POSIX_MQ_CHANNEL_TYPES: the oldest message for type 0, the oldest of
+ * the lowest type for a negative type. Heads taken off channels but not
+ * returned stay held by this process, see PosixChannel.
+ * Does NOT retry on EINTR, like msgrcv.
+ * @param queue_id The message queue identifier
+ * @param msg Buffer receiving mtype followed by the message body
+ * @param size Size of the message body, excluding mtype
+ * @param type 0 for any, >0 for exact type, <0 for lowest type <= |type|
+ * @param flags 0 or IPC_NOWAIT
+ * @return Number of bytes received on success, -1 on error, errno EINVAL for a type without a channel
+ */
+ssize_t posix_queue_receive(int queue_id, void* msg, size_t size, long type, int flags) {
+    PosixChannel* selected[POSIX_MQ_CHANNEL_TYPES];
+    struct pollfd pfds[POSIX_MQ_CHANNEL_TYPES];
+    struct timespec passed;
+    size_t message_size = size + sizeof(long);
+    size_t envelope_size = message_size + offsetof(PosixEnvelope, mtype);
+    long first = type > 0 ? type : 1;
+    long last = type > 0 ? type : (type == 0 ? POSIX_MQ_CHANNEL_TYPES : -type);
+    int count;
+
+    if ((type > 0 && !posix_channel_type(type)) || envelope_size > POSIX_MQ_MESSAGE_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (last - first >= POSIX_MQ_CHANNEL_TYPES) last = first + POSIX_MQ_CHANNEL_TYPES - 1;
+    count = (int)(last - first + 1);
+    posix_deadline(&passed, 0);
+
+    for (int i = 0; i < count; i++) {
+        if (!(selected[i] = posix_channel_open(queue_id, first + i, envelope_size))) return -1;
+        pfds[i].fd = (int)selected[i]->mq;
+        pfds[i].events = POLLIN;
+    }
+
+    while (1) {
+        PosixChannel* oldest = NULL;
+
+        // One poll tells which empty heads can be refilled, instead of a failed mq_receive per channel
+        if (poll(pfds, count, 0) == -1) return -1;
+        for (int i = 0; i < count; i++) {
+            PosixChannel* channel = selected[i];
+            if (channel->held < 0 && (pfds[i].revents & POLLIN)) {
+                channel->held = mq_timedreceive(channel->mq, channel->head, sizeof(channel->head), NULL, &passed);
+                if (channel->held < 0 && errno != ETIMEDOUT) return -1;
+            }
+            if (channel->held < 0) continue;
+            // Lowest type first, unless any type is wanted: then the first sent
+            if (!oldest) oldest = channel;
+            if (type != 0) break;
+            if (((PosixEnvelope*)channel->head)->sequence < ((PosixEnvelope*)oldest->head)->sequence) oldest = channel;
+        }
+        if (oldest) {
+            ssize_t received = oldest->held - (ssize_t)offsetof(PosixEnvelope, mtype);
+            memcpy(msg, oldest->head + offsetof(PosixEnvelope, mtype),
+                   (size_t)received < message_size ? (size_t)received : message_size);
+            oldest->held = -1;
+            return received - (ssize_t)sizeof(long);
+        }
+        if (flags & IPC_NOWAIT) {
+            errno = ENOMSG;
+            return -1;
+        }
+        int ready = poll(pfds, count, POSIX_MQ_POLL_MS);
+        if (ready == -1) return -1;
+        if (ready == 0 && posix_queue_removed(queue_id)) return -1;
+    }
+}
@@ -0,0 +1,296 @@
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/shm.h>
+#include <sys/syscall.h>
+
+#include "common/ipc_ring.h"
+#include "common/state_lock.h"
+
+/**
+ * A message slot. Messages may be taken out of order (by type), so a slot
+ * stays in the ring marked taken until every slot before it is gone too.
+ */
+typedef struct RingSlot {
+    long type;
+    size_t size;
+    int taken;
+    char body[RING_MESSAGE_MAX];
+} RingSlot;
+
+/**
+ * The shared ring. head and tail only grow; the slot of a position is
+ * position % RING_SLOTS. seq changes on every send, on receives that free
+ * space in a full ring and on removal; it is the futex word blocked senders
+ * and receivers sleep on.
+ *
+ * The lock is robust, like the state locks: a role killed while holding it
+ * hands it to the next locker. A slot is published only once it is written
+ * whole, so the next locker never finds half a message in the ring.
+ */
+typedef struct RingQueue {
+    pthread_mutex_t lock;
+    uint32_t seq;
+    int waiters;
+    int removed;
+    unsigned long head;
+    unsigned long tail;
+    RingSlot slots[RING_SLOTS];
+} RingQueue;
+
+typedef struct RingAttachment {
+    int queue_id;
+    RingQueue* ring;
+} RingAttachment;
+
+// Rings this process has attached; forked roles inherit the attachments
+static RingAttachment attachments[RING_MAX_ATTACHED];
+
+/**
+ * Returns the ring of a queue, attaching it on first use.
+ * @param queue_id Shared memory identifier of the ring
+ * @return Ring on success, NULL with errno set on error
+ */
+static RingQueue* ring_get(int queue_id) {
+    RingAttachment* free_attachment = NULL;
+    void* addr;
+
+    for (int i = 0; i < RING_MAX_ATTACHED; i++) {
+        if (attachments[i].ring && attachments[i].queue_id == queue_id) return attachments[i].ring;
+        if (!attachments[i].ring && !free_attachment) free_attachment = &attachments[i];
+    }
+    if (!free_attachment) {
+        errno = EMFILE;
+        return NULL;
+    }
+    if ((addr = shmat(queue_id, NULL, 0)) == (void*)-1) return NULL;
+    free_attachment->queue_id = queue_id;
+    free_attachment->ring = (RingQueue*)addr;
+    return free_attachment->ring;
+}
+
+static void ring_forget(int queue_id) {
+    for (int i = 0; i < RING_MAX_ATTACHED; i++) {
+        if (attachments[i].ring && attachments[i].queue_id == queue_id) {
+            shmdt(attachments[i].ring);
+            attachments[i].ring = NULL;
+        }
+    }
+}
+
+/**
+ * Sleeps until the ring changes. Must be called with the lock held; the lock
+ * is released while sleeping and held again on return.
+ */
+static void ring_wait(RingQueue* ring) {
+    uint32_t seen = ring->seq;
+
+    ring->waiters++;
+    state_mutex_unlock(&ring->lock);
+    syscall(SYS_futex, &ring->seq, FUTEX_WAIT, seen, NULL, NULL, 0);
+    state_mutex_lock(&ring->lock);
+    ring->waiters--;
+}
+
+/**
+ * Records a change and wakes every sleeper so each can recheck its condition.
+ * Must be called with the lock held.
+ */
+static void ring_changed(RingQueue* ring) {
+    ring->seq++;
+    if (ring->waiters > 0) syscall(SYS_futex, &ring->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * Checks whether a message type satisfies a msgrcv-style type selector.
+ */
+static int ring_type_matches(long selector, long type) {
+    if (selector == 0) return 1;
+    if (selector > 0) return type == selector;
+    return type <= -selector;
+}
+
+/**
+ * Drops taken slots from the head, then slides the remaining messages together
+ * if taken slots are still trapped behind an unread one. A message is marked
+ * unread at its new slot only once copied whole, and taken at its old one
+ * after that: a holder killed midway leaves at worst one message twice.
+ */
+static void ring_compact(RingQueue* ring) {
+    unsigned long kept;
+
+    while (ring->head != ring->tail && ring->slots[ring->head % RING_SLOTS].taken) ring->head++;
+    if (ring->tail - ring->head < RING_SLOTS) return;
+
+    kept = ring->head;
+    for (unsigned long position = ring->head; position != ring->tail; position++) {
+        RingSlot* slot = &ring->slots[position % RING_SLOTS];
+        if (slot->taken) continue;
+        if (kept != position) {
+            RingSlot* moved = &ring->slots[kept % RING_SLOTS];
+            moved->type = slot->type;
+            moved->size = slot->size;
+            memcpy(moved->body, slot->body, slot->size);
+            __atomic_store_n(&moved->taken, 0, __ATOMIC_RELEASE);
+            __atomic_store_n(&slot->taken, 1, __ATOMIC_RELEASE);
+        }
+        kept++;
+    }
+    ring->tail = kept;
+}
+
+/**
+ * Creates a ring with the specified key.
+ * @param queue_key The IPC key for the message queue
+ * @return Queue ID on success, -1 on error
+ */
+int ring_queue_create(key_t queue_key) {
+    RingQueue* ring;
+    int status;
+    int queue_id = shmget(queue_key, sizeof(RingQueue), IPC_CREAT | IPC_EXCL | 0600);
+
+    if (queue_id == -1) return -1;
+    if (!(ring = ring_get(queue_id))) {
+        shmctl(queue_id, IPC_RMID, NULL);
+        return -1;
+    }
+    if ((status = state_mutex_init(&ring->lock)) != 0) {
+        ring_forget(queue_id);
+        shmctl(queue_id, IPC_RMID, NULL);
+        errno = status;
+        return -1;
+    }
+    return queue_id;
+}
+
+/**
+ * Opens an existing ring. It is attached on first use.
+ * @param queue_key The IPC key for the message queue
+ * @return Queue ID on success, -1 on error
+ */
+int ring_queue_open(key_t queue_key) {
+    return shmget(queue_key, 0, 0);
+}
+
+/**
+ * Removes a ring. Blocked senders and receivers wake up and fail with EIDRM;
+ * the memory is released once every process has detached.
+ * @param queue_id The message queue identifier
+ * @return 0 on success, -1 on error
+ */
+int ring_queue_close(int queue_id) {
+    RingQueue* ring = ring_get(queue_id);
+
+    if (!ring) return -1;
+    state_mutex_lock(&ring->lock);
+    ring->removed = 1;
+    ring_changed(ring);
+    state_mutex_unlock(&ring->lock);
+    ring_forget(queue_id);
+    return shmctl(queue_id, IPC_RMID, NULL);
+}
+
+/**
+ * Appends a message to the ring.
+ * Never fails with EINTR: the ring has nothing a signal could interrupt.
+ * @param queue_id The message queue identifier
+ * @param msg Message starting with a long mtype
+ * @param size Size of the message body, excluding mtype
+ * @param flags 0 or IPC_NOWAIT
+ * @return 0 on success, -1 on error
+ */
+int ring_queue_send(int queue_id, const void* msg, size_t size, int flags) {
+    RingQueue* ring = ring_get(queue_id);
+    RingSlot* slot;
+
+    if (!ring) return -1;
+    if (size > RING_MESSAGE_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    state_mutex_lock(&ring->lock);
+    while (!ring->removed && ring->tail - ring->head == RING_SLOTS) {
+        ring_compact(ring);
+        if (ring->tail - ring->head < RING_SLOTS) break;
+        if (flags & IPC_NOWAIT) {
+            state_mutex_unlock(&ring->lock);
+            errno = EAGAIN;
+            return -1;
+        }
+        ring_wait(ring);
+    }
+    if (ring->removed) {
+        state_mutex_unlock(&ring->lock);
+        errno = EIDRM;
+        return -1;
+    }
+
+    // Written whole before tail publishes it
+    slot = &ring->slots[ring->tail % RING_SLOTS];
+    slot->type = *(const long*)msg;
+    slot->size = size;
+    slot->taken = 0;
+    memcpy(slot->body, (const char*)msg + sizeof(long), size);
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+    ring_changed(ring);
+    state_mutex_unlock(&ring->lock);
+    return 0;
+}
+
+/**
+ * Takes a message from the ring with msgrcv-style type selection: the oldest
+ * matching message, or for a negative selector the oldest of the lowest type.
+ * @param queue_id The message queue identifier
+ * @param msg Buffer receiving mtype followed by the message body
+ * @param size Size of the message body, excluding mtype
+ * @param type 0 for any, >0 for exact type, <0 for lowest type <= |type|
+ * @param flags 0 or IPC_NOWAIT
+ * @return Number of bytes received on success, -1 on error
+ */
+ssize_t ring_queue_receive(int queue_id, void* msg, size_t size, long type, int flags) {
+    RingQueue* ring = ring_get(queue_id);
+    RingSlot* found;
+    size_t received;
+    int was_full;
+
+    if (!ring) return -1;
+
+    state_mutex_lock(&ring->lock);
+    while (1) {
+        if (ring->removed) {
+            state_mutex_unlock(&ring->lock);
+            errno = EIDRM;
+            return -1;
+        }
+        found = NULL;
+        for (unsigned long position = ring->head; position != ring->tail; position++) {
+            RingSlot* slot = &ring->slots[position % RING_SLOTS];
+            if (slot->taken || !ring_type_matches(type, slot->type)) continue;
+            if (!found || slot->type < found->type) found = slot;
+            if (type >= 0) break;
+        }
+        if (found) break;
+        if (flags & IPC_NOWAIT) {
+            state_mutex_unlock(&ring->lock);
+            errno = ENOMSG;
+            return -1;
+        }
+        ring_wait(ring);
+    }
+
+    received = found->size < size ? found->size : size;
+    *(long*)msg = found->type;
+    memcpy((char*)msg + sizeof(long), found->body, received);
+    // Only senders wait for space, and only on a full ring
+    was_full = ring->tail - ring->head == RING_SLOTS;
+    found->taken = 1;
+    ring_compact(ring);
+    if (was_full) ring_changed(ring);
+    state_mutex_unlock(&ring->lock);
+    return (ssize_t)received;
+}
@@ -32,5 +32,63 @@ void log_message(int queue, Role role, int identifier, const char* message, ...)
 
     va_end(args);
 
-    while (msgsnd(queue, &msg, MSG_SIZE(msg), 0) == -1 && errno == EINTR) {}
-}
\ No newline at end of file
+    while (queue_send(queue, &msg, MSG_SIZE(msg), 0) == -1 && errno == EINTR) {}
+}
+
+/**
+ * Asks the logger to finish once it has written everything still queued.
+ * Sent when no role is left to log, so nothing queued is lost when the
+ * queue is removed.
+ * 
+ * @param queue The message queue ID for logging
+ */
+void log_end(int queue) {
+    log_message(queue, ROLE_PORT_MANAGER, LOG_END_IDENTIFIER, "");
+}
+
+/**
+ * Prints the final statistics block.
+ * Shared by the logger and the engines that do not run a logger process,
+ * so every engine reports in the format the tests parse.
+ * 
+ * @param out Destination stream (terminal or log file)
+ * @param stats Statistics to print
+ */
+void log_statistics(FILE* out, const SimulationStats* stats) {
+    fprintf(out, "\n=== Simulation Statistics ===\n");
+    fprintf(out, "Passengers spawned:                   %d\n", stats->passengers_spawned);
+    fprintf(out, "Passengers passed security:           %d\n", stats->passengers_screened_passed);
+    fprintf(out, "Passengers rejected security:         %d\n", stats->passengers_screened_rejected);
+    fprintf(out, "Passengers boarded:                   %d\n", stats->passengers_boarded);
+    fprintf(out, "Passengers rejected attempts (bag):   %d\n", stats->passengers_rejected_baggage);
+    fprintf(out, "Total ferry trips:                    %d\n", stats->total_ferry_trips);
+    fprintf(out, "=============================\n\n");
+}
+/**
+ * Prints the statistics of one terminal on a single line, ahead of the
+ * statistics block of the whole port.
+ * 
+ * @param out Destination stream (terminal or log file)
+ * @param terminal Terminal index
+ * @param stats Statistics of the terminal
+ */
+void log_terminal_statistics(FILE* out, int terminal, const SimulationStats* stats) {
+    fprintf(out, "Terminal %d: spawned %d, passed security %d, rejected security %d, boarded %d, rejected attempts (bag) %d, ferry trips %d\n",
+            terminal, stats->passengers_spawned, stats->passengers_screened_passed, stats->passengers_screened_rejected,
+            stats->passengers_boarded, stats->passengers_rejected_baggage, stats->total_ferry_trips);
+}
+
+/**
+ * Adds the statistics of one terminal to the totals of the port.
+ * 
+ * @param total Accumulated statistics
+ * @param stats Statistics to add
+ */
+void stats_add(SimulationStats* total, const SimulationStats* stats) {
+    total->passengers_spawned += stats->passengers_spawned;
+    total->passengers_boarded += stats->passengers_boarded;
+    total->passengers_rejected_baggage += stats->passengers_rejected_baggage;
+    total->total_ferry_trips += stats->total_ferry_trips;
+    total->passengers_screened_passed += stats->passengers_screened_passed;
+    total->passengers_screened_rejected += stats->passengers_screened_rejected;
+}
@@ -0,0 +1,168 @@
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "common/mailbox.h"
+
+/**
+ * Frees every mailbox of a terminal. Only called before any role uses them.
+ *
+ * @param mailboxes Reply mailboxes
+ */
+void mailboxes_init(Mailboxes* mailboxes) {
+    for (int mailbox = 0; mailbox < MAILBOX_SLOTS; mailbox++) mailboxes->boxes[mailbox].state = MAILBOX_FREE;
+}
+
+/**
+ * Claims a mailbox for the answer to a request. Claim it before sending the
+ * request, and send its index with the request.
+ *
+ * @param mailboxes Reply mailboxes
+ * @param hint Where to start looking, such as the passenger id
+ * @return Mailbox on success, -1 with errno EAGAIN if every mailbox is taken
+ */
+int mailbox_claim(Mailboxes* mailboxes, int hint) {
+    for (int i = 0; i < MAILBOX_SLOTS; i++) {
+        int mailbox = (int)(((unsigned int)hint + i) % MAILBOX_SLOTS);
+        uint32_t expected = MAILBOX_FREE;
+        if (__atomic_compare_exchange_n(&mailboxes->boxes[mailbox].state, &expected, MAILBOX_WAITING, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return mailbox;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * Sleeps until the request is answered, then frees the mailbox. Signals do
+ * not end the wait. Once the time is up the mailbox stays held: wait again,
+ * or withdraw the request if nobody may answer it any more.
+ *
+ * @param mailboxes Reply mailboxes
+ * @param mailbox Mailbox of the request
+ * @param timeout_ms Longest wait, -1 to wait for the answer however long it takes
+ * @return Value the request was accepted with, 0 if refused, -1 with errno ETIMEDOUT if not answered in time
+ */
+int mailbox_wait(Mailboxes* mailboxes, int mailbox, int timeout_ms) {
+    uint32_t* state = &mailboxes->boxes[mailbox].state;
+    uint32_t answer = __atomic_load_n(state, __ATOMIC_ACQUIRE);
+    int value;
+    struct timespec deadline;
+    struct timespec now;
+    struct timespec left;
+
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+    while (answer == MAILBOX_WAITING || answer == MAILBOX_SLEEPING) {
+        // Marked before sleeping, so only answers to a sleeping owner cost a wake-up
+        if (answer == MAILBOX_WAITING
+            && !__atomic_compare_exchange_n(state, &answer, MAILBOX_SLEEPING, 0,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) continue;
+        if (timeout_ms >= 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            left.tv_sec = deadline.tv_sec - now.tv_sec;
+            left.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+            if (left.tv_nsec < 0) {
+                left.tv_sec--;
+                left.tv_nsec += 1000000000L;
+            }
+            if (left.tv_sec < 0) {
+                errno = ETIMEDOUT;
+                return -1;
+            }
+        }
+        syscall(SYS_futex, state, FUTEX_WAIT, MAILBOX_SLEEPING, timeout_ms >= 0 ? &left : NULL, NULL, 0);
+        answer = __atomic_load_n(state, __ATOMIC_ACQUIRE);
+    }
+    value = answer == MAILBOX_ACCEPTED ? mailboxes->boxes[mailbox].value : 0;
+    __atomic_store_n(state, MAILBOX_FREE, __ATOMIC_RELEASE);
+    return value;
+}
+
+/**
+ * Withdraws a request nobody may answer any more. Whoever takes it later
+ * finds it withdrawn, and its answer frees the mailbox. An answer that came
+ * first is taken instead.
+ *
+ * @param mailboxes Reply mailboxes
+ * @param mailbox Mailbox of the request
+ * @return -1 if withdrawn, otherwise the answer as mailbox_wait returns it
+ */
+int mailbox_withdraw(Mailboxes* mailboxes, int mailbox) {
+    uint32_t* state = &mailboxes->boxes[mailbox].state;
+    uint32_t answer = __atomic_load_n(state, __ATOMIC_ACQUIRE);
+    int value;
+
+    while (answer == MAILBOX_WAITING || answer == MAILBOX_SLEEPING) {
+        if (__atomic_compare_exchange_n(state, &answer, MAILBOX_WITHDRAWN, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return -1;
+    }
+    value = answer == MAILBOX_ACCEPTED ? mailboxes->boxes[mailbox].value : 0;
+    __atomic_store_n(state, MAILBOX_FREE, __ATOMIC_RELEASE);
+    return value;
+}
+
+/**
+ * Frees a mailbox whose request was never sent.
+ *
+ * @param mailboxes Reply mailboxes
+ * @param mailbox Mailbox
+ */
+void mailbox_release(Mailboxes* mailboxes, int mailbox) {
+    __atomic_store_n(&mailboxes->boxes[mailbox].state, MAILBOX_FREE, __ATOMIC_RELEASE);
+}
+
+/**
+ * Answers a request straight in the requester's mailbox, waking the
+ * requester only if it already sleeps. The answer to a withdrawn request
+ * only frees the mailbox.
+ *
+ * @param mailboxes Reply mailboxes
+ * @param mailbox Mailbox of the request
+ * @param accepted 0 to refuse the request, any positive value to accept it,
+ *        which the requester gets back from mailbox_wait
+ * @return 1 if the requester gets the answer, 0 if it withdrew the request
+ */
+int mailbox_post(Mailboxes* mailboxes, int mailbox, int accepted) {
+    uint32_t* state = &mailboxes->boxes[mailbox].state;
+    uint32_t answer = accepted ? MAILBOX_ACCEPTED : MAILBOX_REFUSED;
+    uint32_t expected = __atomic_load_n(state, __ATOMIC_ACQUIRE);
+
+    // Nobody else writes a claimed or withdrawn mailbox: the state published below carries the value
+    mailboxes->boxes[mailbox].value = accepted;
+
+    while (1) {
+        if (expected == MAILBOX_WITHDRAWN) {
+            __atomic_store_n(state, MAILBOX_FREE, __ATOMIC_RELEASE);
+            return 0;
+        }
+        if (__atomic_compare_exchange_n(state, &expected, answer, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) break;
+    }
+    if (expected == MAILBOX_SLEEPING) syscall(SYS_futex, state, FUTEX_WAKE, 1, NULL, NULL, 0);
+    return 1;
+}
+
+/**
+ * Counts the mailboxes held by a requester, answered or not. Once every
+ * passenger has exited, any left are requests nobody answered. Withdrawn
+ * requests are left out: their passengers knew nobody would.
+ *
+ * @param mailboxes Reply mailboxes
+ * @return Mailboxes neither free nor withdrawn
+ */
+int mailbox_pending(const Mailboxes* mailboxes) {
+    int pending = 0;
+
+    for (int mailbox = 0; mailbox < MAILBOX_SLOTS; mailbox++) {
+        uint32_t state = __atomic_load_n(&mailboxes->boxes[mailbox].state, __ATOMIC_RELAXED);
+        if (state != MAILBOX_FREE && state != MAILBOX_WITHDRAWN) pending++;
+    }
+    return pending;
+}
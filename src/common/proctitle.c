@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/prctl.h>
+
+#include "common/proctitle.h"
+
+extern char** environ;
+
+static char* title_area;
+static size_t title_area_size;
+
+/**
+ * Prepares the process title area.
+ * The argument and environment strings are contiguous in memory; they are
+ * moved to the heap so the whole block can hold a new title, which is what
+ * ps and pkill -f read from /proc/<pid>/cmdline. argv and environ keep working
+ * through the moved copies.
+ *
+ * @param argc Argument count of main
+ * @param argv Argument vector of main
+ */
+void proctitle_init(int argc, char** argv) {
+    char* start;
+    char* end;
+    char** env_copy;
+    int env_count = 0;
+
+    if (argc < 1 || !argv[0]) return;
+
+    start = argv[0];
+    end = argv[0] + strlen(argv[0]) + 1;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i] == end) end = argv[i] + strlen(argv[i]) + 1;
+    }
+    while (environ[env_count]) {
+        if (environ[env_count] == end) end = environ[env_count] + strlen(environ[env_count]) + 1;
+        env_count++;
+    }
+
+    env_copy = malloc(sizeof(char*) * (env_count + 1));
+    if (!env_copy) return;
+    for (int i = 0; i < env_count; i++) {
+        if (!(env_copy[i] = strdup(environ[i]))) return;
+    }
+    env_copy[env_count] = NULL;
+    for (int i = 0; i < argc; i++) {
+        if (!(argv[i] = strdup(argv[i]))) return;
+    }
+    environ = env_copy;
+
+    title_area = start;
+    title_area_size = end - start;
+}
+
+/**
+ * Sets the process title shown by ps and matched by pkill -f, and the
+ * short command name. Used by roles forked without exec, which would
+ * otherwise all show the command line of the main program.
+ *
+ * @param title printf-style format of the title
+ */
+void proctitle_set(const char* title, ...) {
+    char buffer[256];
+    va_list args;
+
+    va_start(args, title);
+    vsnprintf(buffer, sizeof(buffer), title, args);
+    va_end(args);
+
+    prctl(PR_SET_NAME, buffer, 0, 0, 0);
+    if (!title_area) return;
+    memset(title_area, 0, title_area_size);
+    strncpy(title_area, buffer, title_area_size - 1);
+}
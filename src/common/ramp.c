@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "common/ramp.h"
+#include "common/timescale.h"
+
+/**
+ * Empties a ring. Entry i is ready for a passenger to fill at position i.
+ */
+static void ramp_ring_init(RampRing* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    for (uint32_t position = 0; position < RAMP_LANE_SLOTS; position++) ring->entries[position].sequence = position;
+}
+
+/**
+ * Empties the ramp lane of every dock. Only called before any role uses them:
+ * ramp slots open when a ferry docks.
+ *
+ * @param state Shared state
+ */
+void ramp_lanes_init(SharedState* state) {
+    for (int dock = 0; dock < DOCK_MAX; dock++) {
+        RampLane* lane = &state->ramps[dock];
+        for (int vip = 0; vip <= 1; vip++) {
+            lane->slots[vip].available = 0;
+            lane->slots[vip].waiting = 0;
+            ramp_ring_init(&lane->requests[vip]);
+        }
+        ramp_ring_init(&lane->exits);
+        lane->doorbell.rings = 0;
+        lane->doorbell.sleeping = 0;
+        lane->boardings = 0;
+    }
+}
+
+/**
+ * Takes a ramp slot, sleeping while there is none. Taking a free slot
+ * stays in user space.
+ *
+ * @param slots Ramp slots of the passenger's kind
+ * @return 0 with a slot, -1 with errno EINTR when woken without one
+ *         (a signal, the port closing or RAMP_WAIT_TIMEOUT_MS passing)
+ */
+int ramp_slot_wait(RampSlots* slots) {
+    struct timespec timeout = { RAMP_WAIT_TIMEOUT_MS / 1000, (RAMP_WAIT_TIMEOUT_MS % 1000) * 1000000L };
+    int32_t available;
+
+    if (ramp_slot_trywait(slots) == 0) return 0;
+    // Counted before sleeping: a slot posted from here on wakes the waiter
+    __atomic_fetch_add(&slots->waiting, 1, __ATOMIC_SEQ_CST);
+    available = __atomic_load_n(&slots->available, __ATOMIC_SEQ_CST);
+    if (available <= 0) syscall(SYS_futex, &slots->available, FUTEX_WAIT, available, &timeout, NULL, 0);
+    __atomic_fetch_sub(&slots->waiting, 1, __ATOMIC_SEQ_CST);
+    if (ramp_slot_trywait(slots) == 0) return 0;
+    errno = EINTR;
+    return -1;
+}
+
+/**
+ * Takes a ramp slot if one is free.
+ *
+ * @param slots Ramp slots
+ * @return 0 with a slot, -1 with errno EAGAIN otherwise
+ */
+int ramp_slot_trywait(RampSlots* slots) {
+    int32_t available = __atomic_load_n(&slots->available, __ATOMIC_RELAXED);
+
+    while (available > 0) {
+        if (__atomic_compare_exchange_n(&slots->available, &available, available - 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return 0;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * Opens ramp slots and wakes as many sleeping passengers.
+ *
+ * @param slots Ramp slots
+ * @param count Slots to open
+ */
+void ramp_slot_post(RampSlots* slots, int count) {
+    if (count <= 0) return;
+    __atomic_fetch_add(&slots->available, count, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&slots->waiting, __ATOMIC_SEQ_CST) > 0) {
+        syscall(SYS_futex, &slots->available, FUTEX_WAKE, count, NULL, NULL, 0);
+    }
+}
+
+/**
+ * Number of ramp slots nobody has taken.
+ *
+ * @param slots Ramp slots
+ * @return Free slots
+ */
+int ramp_slot_value(const RampSlots* slots) {
+    return __atomic_load_n(&slots->available, __ATOMIC_RELAXED);
+}
+
+/**
+ * Appends an entry to a ring without a lock. Passengers claim a position by
+ * moving the tail on, fill its entry, then publish it through the entry's
+ * sequence, so the ferry never reads a half-written entry.
+ *
+ * @param ring Ring of a ramp lane
+ * @param entry Entry to append, its sequence is ignored
+ * @return 0 on success, -1 with errno EAGAIN if the ring is full
+ */
+int ramp_ring_push(RampRing* ring, const RampEntry* entry) {
+    uint32_t position = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    RampEntry* slot;
+
+    while (1) {
+        slot = &ring->entries[position % RAMP_LANE_SLOTS];
+        int32_t distance = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - position);
+        if (distance == 0) {
+            if (__atomic_compare_exchange_n(&ring->tail, &position, position + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (distance < 0) {
+            errno = EAGAIN;
+            return -1;
+        } else {
+            position = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+    slot->pid = entry->pid;
+    slot->passenger_id = entry->passenger_id;
+    slot->weight = entry->weight;
+    slot->vip = entry->vip;
+    slot->mailbox = entry->mailbox;
+    slot->boarding = entry->boarding;
+    __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * Takes the oldest entry off a ring. Only the ferry at the dock pops.
+ *
+ * @param ring Ring of a ramp lane
+ * @param entry Filled with the entry
+ * @return 0 on success, -1 with errno ENOMSG if the ring is empty
+ */
+int ramp_ring_pop(RampRing* ring, RampEntry* entry) {
+    uint32_t position = ring->head;
+    RampEntry* slot = &ring->entries[position % RAMP_LANE_SLOTS];
+
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+        errno = ENOMSG;
+        return -1;
+    }
+    *entry = *slot;
+    // The entry is free again for the passenger claiming it one lap later
+    __atomic_store_n(&slot->sequence, position + RAMP_LANE_SLOTS, __ATOMIC_RELEASE);
+    ring->head = position + 1;
+    return 0;
+}
+
+/**
+ * Appends a request or exit to a ring of a ramp lane, then rings the
+ * doorbell of the lane for the ferry at the dock.
+ *
+ * @param lane Ramp lane of the dock
+ * @param ring Request ring of the passenger's kind, or the exit ring of the lane
+ * @param entry Entry to append
+ * @return 0 on success, -1 with errno EAGAIN if the ring is full
+ */
+int ramp_send(RampLane* lane, RampRing* ring, const RampEntry* entry) {
+    if (ramp_ring_push(ring, entry) == -1) return -1;
+    ramp_doorbell_ring(lane);
+    return 0;
+}
+
+/**
+ * Takes the next entry off the ramp lane of a dock without blocking:
+ * exits first, then VIP requests, then regular ones.
+ *
+ * @param lane Ramp lane of the dock
+ * @param entry Filled with the entry
+ * @return RAMP_MESSAGE_EXIT, RAMP_PRIORITY_VIP or RAMP_PRIORITY_REGULAR,
+ *         -1 with errno ENOMSG if the lane is empty
+ */
+int ramp_receive(RampLane* lane, RampEntry* entry) {
+    if (ramp_ring_pop(&lane->exits, entry) == 0) return RAMP_MESSAGE_EXIT;
+    if (ramp_ring_pop(&lane->requests[1], entry) == 0) return RAMP_PRIORITY_VIP;
+    if (ramp_ring_pop(&lane->requests[0], entry) == 0) return RAMP_PRIORITY_REGULAR;
+    return -1;
+}
+
+/**
+ * Wakes the ferry at the dock of a lane if it sleeps. Costs a system call
+ * only then. Async-signal-safe.
+ *
+ * @param lane Ramp lane of the dock
+ */
+void ramp_doorbell_ring(RampLane* lane) {
+    // Rung after publishing: a ferry reading the doorbell before this sees the entry
+    __atomic_fetch_add(&lane->doorbell.rings, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&lane->doorbell.sleeping, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &lane->doorbell.rings, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+}
+
+/**
+ * Starts waiting on the doorbell of a lane. Must be called before the ferry
+ * looks at the lane and at what makes it depart: anything sent or ordered
+ * after that rings the doorbell, so ramp_lane_wait returns at once instead
+ * of missing it.
+ *
+ * @param lane Ramp lane of the dock
+ * @return Rings to pass to ramp_lane_wait
+ */
+uint32_t ramp_lane_wait_begin(RampLane* lane) {
+    return __atomic_load_n(&lane->doorbell.rings, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Sleeps until the doorbell of a lane rings, a signal arrives or a
+ * deadline passes. Only the ferry at the dock waits, with its lane empty.
+ *
+ * @param lane Ramp lane of the dock
+ * @param rings Value returned by ramp_lane_wait_begin
+ * @param deadline time_scale_now() to wake at, LLONG_MAX for none
+ * @return 0 when rung or the doorbell already rang, -1 with errno set
+ *         (ETIMEDOUT at the deadline, EINTR on a signal)
+ */
+int ramp_lane_wait(RampLane* lane, uint32_t rings, long long deadline) {
+    struct timespec timeout;
+    long status;
+
+    if (deadline != LLONG_MAX) {
+        long long wall = time_scale_wall_usec(deadline - time_scale_now());
+        if (wall <= 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        timeout.tv_sec = wall / 1000000;
+        timeout.tv_nsec = (wall % 1000000) * 1000;
+    }
+    __atomic_store_n(&lane->doorbell.sleeping, 1, __ATOMIC_SEQ_CST);
+    status = syscall(SYS_futex, &lane->doorbell.rings, FUTEX_WAIT, rings, deadline == LLONG_MAX ? NULL : &timeout, NULL, 0);
+    __atomic_store_n(&lane->doorbell.sleeping, 0, __ATOMIC_SEQ_CST);
+    if (status == -1 && errno == EAGAIN) return 0;
+    return status == 0 ? 0 : -1;
+}
+
+/**
+ * Rings the doorbell of every dock, for a departure order or the port
+ * closing. Async-signal-safe.
+ *
+ * @param state Shared state
+ */
+void ramp_wake_ferries(SharedState* state) {
+    for (int dock = 0; dock < DOCK_MAX; dock++) ramp_doorbell_ring(&state->ramps[dock]);
+}
+
+/**
+ * Wakes every passenger asleep for a ramp slot and every ferry asleep at
+ * its dock, for the port closing. Async-signal-safe.
+ *
+ * @param state Shared state
+ */
+void ramp_wake_all(SharedState* state) {
+    ramp_wake_ferries(state);
+    for (int dock = 0; dock < DOCK_MAX; dock++) {
+        for (int vip = 0; vip <= 1; vip++) {
+            syscall(SYS_futex, &state->ramps[dock].slots[vip].available, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+        }
+    }
+}
+
+/**
+ * Frees every lease, for a ferry opening its gate.
+ *
+ * @param leases Leases of the ferry
+ */
+void ramp_leases_init(RampLeases* leases) {
+    leases->held = 0;
+    for (int lease = 0; lease < RAMP_LANE_SLOTS; lease++) leases->leases[lease].owner = 0;
+}
+
+/**
+ * Leases a ramp slot to a passenger the ferry lets onto the ramp. A passenger
+ * holds its slot while it has a lease, so a free lease is always found.
+ *
+ * @param leases Leases of the ferry
+ * @param entry Ramp request of the passenger
+ * @param deadline time_scale_now() after which the passenger should be off the ramp
+ * @return Lease on success, -1 with errno EAGAIN if every lease is held
+ */
+int ramp_lease_grant(RampLeases* leases, const RampEntry* entry, long long deadline) {
+    for (int lease = 0; lease < RAMP_LANE_SLOTS; lease++) {
+        RampLease* held = &leases->leases[lease];
+        if (held->owner) continue;
+        held->owner = entry->pid;
+        held->passenger_id = entry->passenger_id;
+        held->vip = entry->vip;
+        held->reclaim = 0;
+        held->overdue = 0;
+        held->deadline = deadline;
+        leases->held++;
+        return lease;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * Ends the lease of a passenger who walked off the ramp.
+ *
+ * @param leases Leases of the ferry
+ * @param passenger_id Passenger
+ * @return 0 on success, -1 with errno ENOENT if the lease was already taken back
+ */
+int ramp_lease_end(RampLeases* leases, int passenger_id) {
+    for (int lease = 0; lease < RAMP_LANE_SLOTS && leases->held > 0; lease++) {
+        RampLease* held = &leases->leases[lease];
+        if (!held->owner || held->passenger_id != passenger_id) continue;
+        held->owner = 0;
+        leases->held--;
+        return 0;
+    }
+    errno = ENOENT;
+    return -1;
+}
+
+/**
+ * Checks whether a lease holder still runs. Exited passengers not yet reaped
+ * are zombies, which still take signals, so the state is read from /proc.
+ *
+ * @param owner Passenger process or thread
+ * @return 1 if it runs, 0 if it exited
+ */
+static int ramp_lease_owner_alive(long owner) {
+    char path[64];
+    char state = 0;
+    FILE* file;
+
+    snprintf(path, sizeof(path), "/proc/%ld/stat", owner);
+    if (!(file = fopen(path, "r"))) return errno != ENOENT;
+    // The state follows the command name, which ends with the last ')'
+    if (fscanf(file, "%*d (%*[^)]) %c", &state) != 1) state = 0;
+    fclose(file);
+    return state != 'Z' && state != 'X';
+}
+
+/**
+ * Marks the leases of passengers who exited on the ramp, and of passengers
+ * who outlived their lease. A holder that still runs may still walk onto the
+ * ferry, so its lease is only reported and keeps its slot: the holder is
+ * looked at again every RAMP_LEASE_PROBE_USEC until it exits one way or the
+ * other. Slots are taken back by ramp_lease_reclaim, once the ferry took
+ * every exit off the lane again: an exit sent just before the holder exited
+ * is never missed.
+ *
+ * @param leases Leases of the ferry
+ * @param now time_scale_now()
+ * @param probe 1 to check whether the holders still run, 0 to check deadlines only
+ * @return Leases marked
+ */
+int ramp_leases_check(RampLeases* leases, long long now, int probe) {
+    int marked = 0;
+
+    for (int lease = 0; lease < RAMP_LANE_SLOTS && leases->held > 0; lease++) {
+        RampLease* held = &leases->leases[lease];
+        if (!held->owner || held->reclaim) continue;
+        if (!probe && now < held->deadline) continue;
+        if (!ramp_lease_owner_alive(held->owner)) {
+            held->reclaim = RAMP_LEASE_ORPHANED;
+        } else if (now >= held->deadline) {
+            held->deadline = now + RAMP_LEASE_PROBE_USEC;
+            if (held->overdue) continue;
+            held->overdue = 1;
+            held->reclaim = RAMP_LEASE_EXPIRED;
+        } else {
+            continue;
+        }
+        marked++;
+    }
+    return marked;
+}
+
+/**
+ * Takes back the slot of a lease ramp_leases_check marked orphaned. A lease
+ * marked expired is only handed out to be reported: it stays held.
+ *
+ * @param leases Leases of the ferry
+ * @param reclaimed Filled with the lease taken back or reported
+ * @return RAMP_LEASE_ORPHANED with a lease taken back, RAMP_LEASE_EXPIRED
+ *         with a lease reported, 0 if none is marked; call again until 0
+ */
+int ramp_lease_reclaim(RampLeases* leases, RampLease* reclaimed) {
+    for (int lease = 0; lease < RAMP_LANE_SLOTS && leases->held > 0; lease++) {
+        RampLease* held = &leases->leases[lease];
+        if (!held->owner || !held->reclaim) continue;
+        *reclaimed = *held;
+        held->reclaim = 0;
+        if (reclaimed->reclaim == RAMP_LEASE_ORPHANED) {
+            held->owner = 0;
+            leases->held--;
+        }
+        return reclaimed->reclaim;
+    }
+    return 0;
+}
+
+/**
+ * Earliest deadline the ferry must wake at for its leases: the first lease
+ * to expire, or now if one is already marked to be taken back.
+ *
+ * @param leases Leases of the ferry
+ * @return time_scale_now() to wake at, LLONG_MAX if no lease is held
+ */
+long long ramp_leases_next_deadline(const RampLeases* leases) {
+    long long deadline = LLONG_MAX;
+
+    for (int lease = 0; lease < RAMP_LANE_SLOTS && leases->held > 0; lease++) {
+        const RampLease* held = &leases->leases[lease];
+        if (!held->owner) continue;
+        if (held->reclaim) return 0;
+        if (held->deadline < deadline) deadline = held->deadline;
+    }
+    return deadline;
+}
@@ -0,0 +1,130 @@
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "common/security_ring.h"
+
+/**
+ * Empties the security ring of a terminal. Only called before any role
+ * uses it.
+ *
+ * @param ring Security ring
+ */
+void security_ring_init(SecurityRing* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->doorbell = 0;
+    ring->sleeping = 0;
+    ring->closed = 0;
+    for (uint32_t position = 0; position < SECURITY_RING_SLOTS; position++) ring->requests[position].sequence = position;
+}
+
+/**
+ * Queues a screening request without a lock, the way ramp_ring_push does,
+ * then rings the doorbell. Costs the same however many passengers wait.
+ *
+ * @param ring Security ring
+ * @param request Request to queue, its sequence is ignored
+ * @return 0 on success, -1 with errno EAGAIN if the ring is full
+ */
+int security_ring_push(SecurityRing* ring, const SecurityRequest* request) {
+    uint32_t position = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    SecurityRequest* slot;
+
+    while (1) {
+        slot = &ring->requests[position % SECURITY_RING_SLOTS];
+        int32_t distance = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - position);
+        if (distance == 0) {
+            if (__atomic_compare_exchange_n(&ring->tail, &position, position + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (distance < 0) {
+            errno = EAGAIN;
+            return -1;
+        } else {
+            position = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+    slot->pid = request->pid;
+    slot->passenger_id = request->passenger_id;
+    slot->gender = request->gender;
+    slot->dangerous = request->dangerous;
+    slot->mailbox = request->mailbox;
+    __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+
+    // Rung after publishing: a manager reading the doorbell before this sees the request
+    __atomic_fetch_add(&ring->doorbell, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->sleeping, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &ring->doorbell, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+    return 0;
+}
+
+/**
+ * Takes the oldest request off the ring. Only the security manager pops.
+ *
+ * @param ring Security ring
+ * @param request Filled with the request
+ * @return 0 on success, -1 with errno ENOMSG if the ring is empty
+ */
+int security_ring_pop(SecurityRing* ring, SecurityRequest* request) {
+    uint32_t position = ring->head;
+    SecurityRequest* slot = &ring->requests[position % SECURITY_RING_SLOTS];
+
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+        errno = ENOMSG;
+        return -1;
+    }
+    *request = *slot;
+    __atomic_store_n(&slot->sequence, position + SECURITY_RING_SLOTS, __ATOMIC_RELEASE);
+    ring->head = position + 1;
+    return 0;
+}
+
+/**
+ * Sleeps until a request is queued, the ring is closed or a deadline
+ * passes. Only the security manager waits: with no passenger at a station
+ * it gives no deadline, otherwise the end of the next screening.
+ *
+ * @param ring Security ring
+ * @param deadline Absolute CLOCK_MONOTONIC time to wake at, NULL for none
+ * @return 0 when a request may be queued, -1 with errno ETIMEDOUT once the
+ *         deadline passed, or EIDRM once the ring is closed and empty with
+ *         no deadline to wait for
+ */
+int security_ring_wait(SecurityRing* ring, const struct timespec* deadline) {
+    while (1) {
+        uint32_t doorbell = __atomic_load_n(&ring->doorbell, __ATOMIC_SEQ_CST);
+        const SecurityRequest* next = &ring->requests[ring->head % SECURITY_RING_SLOTS];
+
+        if (__atomic_load_n(&next->sequence, __ATOMIC_ACQUIRE) == ring->head + 1) return 0;
+        if (!deadline && __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE)) {
+            errno = EIDRM;
+            return -1;
+        }
+        __atomic_store_n(&ring->sleeping, 1, __ATOMIC_SEQ_CST);
+        // A push or close after the doorbell was read changes it, and the wait returns at once.
+        // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline, so no clock is read here
+        long result = syscall(SYS_futex, &ring->doorbell, FUTEX_WAIT_BITSET, doorbell, deadline, NULL,
+                              FUTEX_BITSET_MATCH_ANY);
+        int timed_out = result == -1 && errno == ETIMEDOUT;
+        __atomic_store_n(&ring->sleeping, 0, __ATOMIC_SEQ_CST);
+        if (timed_out) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+    }
+}
+
+/**
+ * Closes the ring once no passenger is left to screen: the security
+ * manager finishes its stations and exits.
+ *
+ * @param ring Security ring
+ */
+void security_ring_close(SecurityRing* ring) {
+    __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&ring->doorbell, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &ring->doorbell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
@@ -0,0 +1,48 @@
+#include <stddef.h>
+#include <errno.h>
+
+#include "common/state.h"
+
+/**
+ * Size of the shared state of a terminal.
+ *
+ * @param ferry_count Number of ferries in the fleet
+ * @return Segment size in bytes
+ */
+size_t shared_state_size(int ferry_count) {
+    return sizeof(SharedState) + (size_t)ferry_count * sizeof(FerryState);
+}
+
+/**
+ * Describes a freshly created shared state in its header.
+ *
+ * @param state Shared state, not yet used by any role
+ * @param ferry_count Number of ferries in the fleet
+ */
+void shared_state_header_init(SharedState* state, int ferry_count) {
+    state->header.magic = SHARED_STATE_MAGIC;
+    state->header.version = SHARED_STATE_VERSION;
+    state->header.size = (uint32_t)shared_state_size(ferry_count);
+    state->header.ferry_count = (uint32_t)ferry_count;
+    state->header.ferries_offset = (uint32_t)offsetof(SharedState, ferries);
+    state->header.ferry_stride = (uint32_t)sizeof(FerryState);
+}
+
+/**
+ * Checks that a mapped segment is a shared state laid out like this build
+ * expects it, so a tool or a role from another build does not misread it.
+ *
+ * @param state Mapped shared state
+ * @return 0 if it matches, -1 with errno set to EPROTO otherwise
+ */
+int shared_state_check(const SharedState* state) {
+    const SharedStateHeader* header = &state->header;
+
+    if (header->magic != SHARED_STATE_MAGIC || header->version != SHARED_STATE_VERSION ||
+        header->ferries_offset != offsetof(SharedState, ferries) || header->ferry_stride != sizeof(FerryState) ||
+        header->size != shared_state_size((int)header->ferry_count)) {
+        errno = EPROTO;
+        return -1;
+    }
+    return 0;
+}
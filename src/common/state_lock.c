@@ -0,0 +1,153 @@
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "common/state_lock.h"
+
+/**
+ * Initializes a mutex that lives in shared memory.
+ * The mutex is process-shared, so every role locks it where it is mapped,
+ * and robust, so a holder that dies does not leave it locked forever - what
+ * SEM_UNDO gave the System V semaphores it replaces. glibc implements it on a
+ * futex: an uncontended lock and unlock stay in user space.
+ *
+ * @param mutex Mutex in shared memory
+ * @return 0 on success, error number on error
+ */
+int state_mutex_init(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t attr;
+    int status;
+
+    if ((status = pthread_mutexattr_init(&attr)) != 0) return status;
+    status = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if (status == 0) status = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    if (status == 0) status = pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return status;
+}
+
+/**
+ * Locks a state mutex. If the previous holder died while holding it, the
+ * mutex is marked consistent and the caller gets it. The fields it guards are
+ * simple counters and flags, which is what SEM_UNDO recovery assumed as well.
+ * Not interrupted by signals: locks are only held for a few assignments.
+ *
+ * @param mutex Mutex in shared memory
+ * @return 0 on success, error number on error
+ */
+int state_mutex_lock(pthread_mutex_t* mutex) {
+    int status = pthread_mutex_lock(mutex);
+
+    if (status == EOWNERDEAD) status = pthread_mutex_consistent(mutex);
+    return status;
+}
+
+/**
+ * Unlocks a state mutex.
+ *
+ * @param mutex Mutex in shared memory
+ * @return 0 on success, error number on error
+ */
+int state_mutex_unlock(pthread_mutex_t* mutex) {
+    return pthread_mutex_unlock(mutex);
+}
+
+/**
+ * Initializes every lock of a terminal's shared state.
+ *
+ * @param state Shared state, not yet used by any role
+ * @return 0 on success, error number on error
+ */
+int state_locks_init(SharedState* state) {
+    int status;
+
+    for (int variant = 0; variant < SEM_STATE_MUTEX_VARIANT_COUNT; variant++) {
+        if ((status = state_mutex_init(&state->locks[variant].mutex)) != 0) return status;
+    }
+    return 0;
+}
+
+/**
+ * Starts reading data guarded by a sequence counter. Waits while a writer is
+ * in the middle of an update; writers only hold it for a few stores.
+ *
+ * @param sequence Sequence counter, even when no write is in progress
+ * @return Sequence to pass to state_seq_read_retry
+ */
+unsigned int state_seq_read_begin(const unsigned int* sequence) {
+    unsigned int start;
+    int spins = 0;
+
+    while ((start = __atomic_load_n(sequence, __ATOMIC_ACQUIRE)) & 1) {
+        // The writer may have been preempted mid-update, let it finish
+        if (++spins % 64 == 0) sched_yield();
+    }
+    return start;
+}
+
+/**
+ * Checks whether a read raced with a writer and has to be repeated.
+ *
+ * @param sequence Sequence counter
+ * @param start Value returned by state_seq_read_begin
+ * @return 1 if the data read may be torn, 0 if it is consistent
+ */
+int state_seq_read_retry(const unsigned int* sequence, unsigned int start) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(sequence, __ATOMIC_RELAXED) != start;
+}
+
+/**
+ * Starts an update of seqlock-guarded data. Writers must already exclude
+ * each other, with a state mutex.
+ *
+ * @param sequence Sequence counter, made odd
+ */
+void state_seq_write_begin(unsigned int* sequence) {
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * Publishes an update of seqlock-guarded data.
+ *
+ * @param sequence Sequence counter, made even again
+ */
+void state_seq_write_end(unsigned int* sequence) {
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Reads which ferry is docked where without taking a lock, so waiting
+ * passengers never hold up a ferry docking or leaving, nor each other.
+ *
+ * @param state Shared state
+ * @param docked Filled with the ferry at each dock, -1 for a free dock
+ * @return Number of docks
+ */
+int docks_snapshot(const SharedState* state, int docked[DOCK_MAX]) {
+    int dock_count = state->dock_count;
+    unsigned int start;
+
+    do {
+        start = state_seq_read_begin(&state->docks_sequence);
+        for (int dock = 0; dock < dock_count; dock++) {
+            docked[dock] = __atomic_load_n(&state->docked_ferry[dock], __ATOMIC_RELAXED);
+        }
+    } while (state_seq_read_retry(&state->docks_sequence, start));
+    return dock_count;
+}
+
+/**
+ * Docks a ferry at a dock or frees it. The caller holds the current ferry
+ * lock, which keeps ferry managers from writing at the same time.
+ *
+ * @param state Shared state
+ * @param dock Dock index
+ * @param ferry Ferry identifier, -1 to free the dock
+ */
+void docks_publish(SharedState* state, int dock, int ferry) {
+    state_seq_write_begin(&state->docks_sequence);
+    __atomic_store_n(&state->docked_ferry[dock], ferry, __ATOMIC_RELAXED);
+    state_seq_write_end(&state->docks_sequence);
+}
@@ -0,0 +1,51 @@
+#include <string.h>
+
+#include "common/stats.h"
+#include "common/logging.h"
+
+/**
+ * Clears every shard. Only called before any role counts.
+ *
+ * @param stats Shared statistics
+ */
+void stats_reset(SharedStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+static void stats_load(const SimulationStats* shard, SimulationStats* out) {
+    out->passengers_spawned = __atomic_load_n(&shard->passengers_spawned, __ATOMIC_ACQUIRE);
+    out->passengers_boarded = __atomic_load_n(&shard->passengers_boarded, __ATOMIC_ACQUIRE);
+    out->passengers_rejected_baggage = __atomic_load_n(&shard->passengers_rejected_baggage, __ATOMIC_ACQUIRE);
+    out->total_ferry_trips = __atomic_load_n(&shard->total_ferry_trips, __ATOMIC_ACQUIRE);
+    out->passengers_screened_passed = __atomic_load_n(&shard->passengers_screened_passed, __ATOMIC_ACQUIRE);
+    out->passengers_screened_rejected = __atomic_load_n(&shard->passengers_screened_rejected, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Adds up the shards into one set of statistics, while roles keep counting.
+ * Counters only grow, so if two passes over every shard read the same
+ * values, all of them held at once at the end of the first pass: the
+ * snapshot is consistent (a passenger counted as screened is also counted as
+ * spawned). After STATS_SNAPSHOT_ATTEMPTS passes that differ, the last pass
+ * is returned as is.
+ *
+ * @param stats Shared statistics
+ * @param snapshot Filled with the totals
+ * @return 1 if the snapshot is consistent, 0 if counters kept changing
+ */
+int stats_snapshot(const SharedStats* stats, SimulationStats* snapshot) {
+    SimulationStats previous[STATS_SHARDS];
+    SimulationStats current[STATS_SHARDS];
+    int consistent = 0;
+
+    for (int shard = 0; shard < STATS_SHARDS; shard++) stats_load(&stats->shards[shard].counts, &previous[shard]);
+    for (int attempt = 1; attempt < STATS_SNAPSHOT_ATTEMPTS && !consistent; attempt++) {
+        for (int shard = 0; shard < STATS_SHARDS; shard++) stats_load(&stats->shards[shard].counts, &current[shard]);
+        consistent = memcmp(previous, current, sizeof(current)) == 0;
+        memcpy(previous, current, sizeof(current));
+    }
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    for (int shard = 0; shard < STATS_SHARDS; shard++) stats_add(snapshot, &previous[shard]);
+    return consistent;
+}
@@ -0,0 +1,68 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+
+#include "common/config.h"
+#include "common/terminals.h"
+
+/**
+ * Number of terminals from TERMINAL_COUNT.
+ *
+ * @return Terminal count, 1 when not set
+ */
+int terminals_count(void) {
+    return CONFIG_GET_INT_OR("TERMINAL_COUNT", 1);
+}
+
+/**
+ * Terminal the calling role belongs to, inherited through TERMINAL_ENV.
+ *
+ * @return Terminal index, 0 when not set
+ */
+int terminals_current(void) {
+    return CONFIG_GET_INT_OR(TERMINAL_ENV, 0);
+}
+
+/**
+ * Splits the passengers of the port between its terminals.
+ * Each terminal gets a contiguous block of passenger ids, the first ones
+ * one passenger more when the count does not divide evenly.
+ *
+ * @param passenger_count Passengers of the whole port
+ * @param terminal_count Number of terminals
+ * @param terminal Terminal index
+ * @param first_id Filled with the first passenger id of the terminal
+ * @param count Filled with the number of passengers of the terminal
+ */
+void terminals_share(int passenger_count, int terminal_count, int terminal, int* first_id, int* count) {
+    int base = passenger_count / terminal_count;
+    int extra = passenger_count % terminal_count;
+
+    *count = base + (terminal < extra);
+    *first_id = terminal * base + (terminal < extra ? terminal : extra);
+}
+
+/**
+ * Pins the calling process to the CPUs of a terminal. CPUs are dealt to the
+ * terminals round-robin, so terminals run on separate cores whenever there are
+ * at least as many cores as terminals. Children inherit the affinity.
+ *
+ * @param terminal Terminal index
+ * @param terminal_count Number of terminals
+ * @return 0 on success, -1 on error
+ */
+int terminals_pin(int terminal, int terminal_count) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    if (cpus <= 0) return -1;
+    CPU_ZERO(&set);
+    if (cpus < terminal_count) {
+        CPU_SET(terminal % cpus, &set);
+    } else {
+        for (long cpu = terminal; cpu < cpus && cpu < CPU_SETSIZE; cpu += terminal_count) CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set);
+}
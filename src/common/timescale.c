@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+#include "common/timescale.h"
+
+static double scale = 0;
+
+/**
+ * Checks a TIME_SCALE value.
+ *
+ * @param value Time scale, NULL for the default
+ * @return 1 if it is a positive number, 0 otherwise
+ */
+int time_scale_valid(const char* value) {
+    char* end;
+    double parsed;
+
+    if (!value) return 1;
+    parsed = strtod(value, &end);
+    return end != value && *end == '\0' && parsed > 0;
+}
+
+/**
+ * Speed of simulated time relative to wall-clock time, from TIME_SCALE.
+ * Read once per process; every role inherits the same environment.
+ *
+ * @return Time scale, 1 when not set
+ */
+double time_scale(void) {
+    if (scale == 0) {
+        const char* value = getenv(TIME_SCALE_ENV);
+        scale = value && time_scale_valid(value) ? strtod(value, NULL) : 1;
+    }
+    return scale;
+}
+
+/**
+ * Converts a simulated duration to wall-clock time.
+ *
+ * @param usec Simulated duration in microseconds
+ * @return Wall-clock duration in microseconds
+ */
+long long time_scale_wall_usec(long long usec) {
+    return (long long)(usec / time_scale());
+}
+
+/**
+ * Simulated time on a monotonic clock.
+ *
+ * @return Simulated microseconds since an arbitrary starting point
+ */
+long long time_scale_now(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)(((long long)now.tv_sec * 1000000 + now.tv_nsec / 1000) * time_scale());
+}
+
+/**
+ * Sleeps for a simulated duration, resuming after signals.
+ *
+ * @param usec Simulated duration in microseconds
+ */
+void time_scale_sleep(long long usec) {
+    struct timespec remaining;
+    long long wall = time_scale_wall_usec(usec);
+
+    if (wall <= 0) return;
+    remaining.tv_sec = wall / 1000000;
+    remaining.tv_nsec = (wall % 1000000) * 1000;
+    while (nanosleep(&remaining, &remaining) == -1 && errno == EINTR);
+}
+
+/**
+ * Moves a CLOCK_MONOTONIC timestamp forward by a simulated duration.
+ *
+ * @param deadline Timestamp to move, normalized on return
+ * @param usec Simulated duration in microseconds
+ */
+void time_scale_deadline(struct timespec* deadline, long long usec) {
+    long long nsec = deadline->tv_nsec + time_scale_wall_usec(usec) * 1000;
+
+    deadline->tv_sec += nsec / 1000000000;
+    deadline->tv_nsec = nsec % 1000000000;
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common/trace.h"
+
+/**
+ * Maps a trace file. Pages are read in as the trace is consumed,
+ * so traces far larger than memory replay in constant space.
+ *
+ * Two formats are accepted:
+ * - Binary: TraceBinaryHeader followed by TraceBinaryRecord entries
+ * - CSV: arrival_ms,gender,vip,bag_weight,dangerous per line, gender M/W/F or 1/2.
+ *   Lines starting with anything but a digit (header, comments) are skipped.
+ *
+ * @param path Trace file
+ * @param trace Filled with the mapped trace
+ * @return 0 on success, -1 on error
+ */
+int trace_open(const char* path, Trace* trace) {
+    struct stat st;
+    int fd;
+
+    memset(trace, 0, sizeof(*trace));
+    fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    trace->size = st.st_size;
+    if (trace->size > 0) {
+        void* data = mmap(NULL, trace->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(data, trace->size, MADV_SEQUENTIAL);
+        trace->data = data;
+    }
+    close(fd);
+
+    if (trace->size >= sizeof(TraceBinaryHeader) && memcmp(trace->data, TRACE_BINARY_MAGIC, 4) == 0) {
+        const TraceBinaryHeader* header = (const TraceBinaryHeader*)trace->data;
+        if (header->version != TRACE_BINARY_VERSION ||
+            header->count > (trace->size - sizeof(TraceBinaryHeader)) / sizeof(TraceBinaryRecord)) {
+            trace_close(trace);
+            return -1;
+        }
+        trace->binary = 1;
+        trace->offset = sizeof(TraceBinaryHeader);
+    }
+    trace->first_arrival = -1;
+    return 0;
+}
+
+/**
+ * Number of records in the trace.
+ * Binary traces store it in the header, CSV traces are scanned once.
+ *
+ * @param trace Mapped trace
+ * @return Record count
+ */
+long trace_count(const Trace* trace) {
+    long count = 0;
+    int line_start = 1;
+
+    if (trace->binary) return (long)((const TraceBinaryHeader*)trace->data)->count;
+    for (size_t i = 0; i < trace->size; i++) {
+        if (line_start && isdigit((unsigned char)trace->data[i])) count++;
+        line_start = trace->data[i] == '\n';
+    }
+    return count;
+}
+
+/**
+ * Parses one CSV field as a non-negative number.
+ *
+ * @return Pointer past the field and its separator, NULL if malformed
+ */
+static const char* trace_csv_field(const char* field, const char* end, long long* value) {
+    *value = 0;
+    if (field >= end || !isdigit((unsigned char)*field)) return NULL;
+    while (field < end && isdigit((unsigned char)*field)) *value = *value * 10 + (*field++ - '0');
+    while (field < end && (*field == ' ' || *field == '\r')) field++;
+    if (field < end && *field == ',') field++;
+    while (field < end && *field == ' ') field++;
+    return field;
+}
+
+static int trace_next_csv(Trace* trace, TraceEntry* entry) {
+    const char* data = trace->data;
+
+    while (trace->offset < trace->size) {
+        const char* line = data + trace->offset;
+        const char* end = memchr(line, '\n', trace->size - trace->offset);
+        const char* field = line;
+        long long values[4];
+        int gender;
+
+        if (!end) end = data + trace->size;
+        trace->offset = end - data + 1;
+        trace->line++;
+        if (!isdigit((unsigned char)*line)) continue;
+
+        if (!(field = trace_csv_field(field, end, &values[0]))) return -1;
+        switch (field < end ? toupper((unsigned char)*field) : 0) {
+            case '1': case 'M': gender = 1; break;
+            case '2': case 'W': case 'F': gender = 2; break;
+            default: return -1;
+        }
+        while (field < end && *field != ',') field++;
+        if (field < end) field++;
+        for (int i = 1; i < 4; i++) {
+            if (!(field = trace_csv_field(field, end, &values[i]))) return -1;
+        }
+
+        entry->arrival = values[0];
+        entry->gender = gender;
+        entry->vip = values[1] != 0;
+        entry->bag_weight = (int)values[2];
+        entry->dangerous = values[3] != 0;
+        return 1;
+    }
+    return 0;
+}
+
+static int trace_next_binary(Trace* trace, TraceEntry* entry) {
+    const TraceBinaryRecord* record;
+
+    if (trace->read >= (long)((const TraceBinaryHeader*)trace->data)->count) return 0;
+    record = (const TraceBinaryRecord*)(trace->data + trace->offset);
+    trace->offset += sizeof(TraceBinaryRecord);
+    trace->line++;
+    if (record->gender != 1 && record->gender != 2) return -1;
+
+    entry->arrival = (long long)record->arrival;
+    entry->gender = record->gender;
+    entry->vip = record->vip != 0;
+    entry->bag_weight = (int)record->bag_weight;
+    entry->dangerous = record->dangerous != 0;
+    return 1;
+}
+
+/**
+ * Reads the next recorded arrival. Arrival times are made relative to the
+ * first record and must not go backwards.
+ *
+ * @param trace Mapped trace
+ * @param entry Filled with the next arrival
+ * @return 1 if an entry was read, 0 at the end of the trace, -1 if the record at trace->line is malformed
+ */
+int trace_next(Trace* trace, TraceEntry* entry) {
+    int status = trace->binary ? trace_next_binary(trace, entry) : trace_next_csv(trace, entry);
+
+    if (status != 1) return status;
+    if (trace->first_arrival == -1) {
+        trace->first_arrival = entry->arrival;
+        trace->last_arrival = entry->arrival;
+    }
+    if (entry->arrival < trace->last_arrival) return -1;
+    trace->last_arrival = entry->arrival;
+    entry->arrival -= trace->first_arrival;
+    trace->read++;
+    return 1;
+}
+
+/**
+ * Unmaps a trace.
+ *
+ * @param trace Trace opened by trace_open
+ */
+void trace_close(Trace* trace) {
+    if (trace->data) munmap((void*)trace->data, trace->size);
+    trace->data = NULL;
+    trace->size = 0;
+}
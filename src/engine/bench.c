@@ -0,0 +1,1245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "common/config.h"
+#include "common/ipc.h"
+#include "common/state.h"
+#include "common/state_lock.h"
+#include "common/stats.h"
+#include "common/baggage.h"
+#include "common/ramp.h"
+#include "common/security_ring.h"
+#include "common/mailbox.h"
+#include "common/macros.h"
+#include "engine/bench.h"
+
+/**
+ * What the benchmarked processes share: the mutex under test and the
+ * counter it protects, as SharedState holds its locks next to its fields,
+ * and a set of sharded statistics.
+ */
+typedef struct BenchShared {
+    pthread_mutex_t mutex;
+    long counter;
+    int stop;
+    int ready;
+    struct timespec docked_at;
+    long busy;                  // CPU microseconds of the waiters of the control benchmark
+    long grant_ns;              // Request to grant, summed over the passengers of the boarding benchmark
+    SharedStats stats;
+} BenchShared;
+
+// Ferries taking turns at the dock in the docks benchmark
+#define BENCH_FLEET 10
+
+// Rounds of the baggage benchmark, and how long its waiters wait for a ferry in each
+#define BENCH_BAGGAGE_ROUNDS 5
+#define BENCH_BAGGAGE_IDLE_MS 100
+// Bag weight of its waiters, and baggage limit of its ferry
+#define BENCH_BAGGAGE_WEIGHT 10
+
+// Boardings per passenger in the ramp benchmark, and the ramp slots its ferry opens
+#define BENCH_RAMP_BOARDINGS 5000
+#define BENCH_RAMP_CAPACITY_REG 4
+#define BENCH_RAMP_CAPACITY_VIP 2
+
+// Boardings per passenger in the boarding benchmark, and the mean time each
+// passenger spends away from the ramp between two, in microseconds
+#define BENCH_BOARDING_ROUNDS 200
+#define BENCH_BOARDING_GAP_USEC 2000
+
+// Rounds of the control benchmark per way of notifying, and how long its
+// passengers wait before a depart-now and before the closure
+#define BENCH_CONTROL_ROUNDS 3
+#define BENCH_CONTROL_IDLE_MS 100
+
+// Replies waiting for passengers in front of each request in the security benchmark
+static const int BENCH_SECURITY_BACKLOGS[] = { 0, 50, 200, 400 };
+
+typedef enum BenchKind {
+    BENCH_LOCKS,
+    BENCH_STATS,
+    BENCH_DOCKS,
+    BENCH_LAYOUT,
+    BENCH_BAGGAGE,
+    BENCH_RAMP,
+    BENCH_SECURITY,
+    BENCH_CONTROL,
+    BENCH_BOARDING
+} BenchKind;
+
+// The ramp queue message passengers and ferries exchanged before the ramp lanes
+typedef struct BenchRampMessage {
+    long mtype;           // RAMP_MESSAGE_EXIT..RAMP_PRIORITY_REGULAR, or PID for response
+    long pid;
+    int approved;
+    int passenger_id;
+    int weight;
+    int is_vip;
+} BenchRampMessage;
+
+// The security queue message, requests typed 1 and replies typed by pid
+typedef struct BenchSecurityMessage {
+    long mtype;
+    int gender;
+    long pid;
+    int passenger_id;
+    int dangerous_weapon;
+    int frustration;
+} BenchSecurityMessage;
+
+// FerryState as it was laid out before each ferry got a cache line of its own
+typedef struct BenchPackedFerry {
+    int ferry_id;
+    int baggage_limit;
+    int passenger_count;
+    int baggage_weight_total;
+    FerryStatus status;
+} BenchPackedFerry;
+
+typedef struct BenchOp {
+    const char* name;
+    void (*count)(BenchShared* shared, int sem_id, int worker);
+} BenchOp;
+
+static void count_sysv(BenchShared* shared, int sem_id, int worker) {
+    (void)worker;
+    sem_wait_single(sem_id, 0);
+    shared->counter++;
+    sem_signal_single(sem_id, 0);
+}
+
+static void count_mutex(BenchShared* shared, int sem_id, int worker) {
+    (void)sem_id; (void)worker;
+    state_mutex_lock(&shared->mutex);
+    shared->counter++;
+    state_mutex_unlock(&shared->mutex);
+}
+
+static void count_atomic(BenchShared* shared, int sem_id, int worker) {
+    (void)sem_id; (void)worker;
+    STATS_INC(&shared->stats, 0, passengers_boarded);
+}
+
+static void count_sharded(BenchShared* shared, int sem_id, int worker) {
+    (void)sem_id;
+    STATS_INC(&shared->stats, worker, passengers_boarded);
+}
+
+// The state semaphores as they were (semop with SEM_UNDO), and what replaced them
+static const BenchOp LOCKS[] = {
+    { "SysV semaphore", count_sysv },
+    { "State mutex",    count_mutex }
+};
+
+// A statistic under its old lock, as a single atomic and as the shards roles use
+static const BenchOp COUNTERS[] = {
+    { "State mutex",    count_mutex },
+    { "Atomic",         count_atomic },
+    { "Sharded atomic", count_sharded }
+};
+
+static void bench_loop(const BenchOp* op, BenchShared* shared, int sem_id, int worker, int iterations) {
+    for (int i = 0; i < iterations; i++) op->count(shared, sem_id, worker);
+}
+
+/**
+ * Times one counter update in a number of processes at once.
+ *
+ * @param op Update under test
+ * @param shared Shared memory, counters reset here
+ * @param sem_id Semaphore set for the System V lock
+ * @param processes Number of processes, 1 runs in the caller
+ * @param iterations Iterations per process
+ * @return Nanoseconds per update, negative if an update was lost
+ */
+static double bench_time(const BenchOp* op, BenchShared* shared, int sem_id, int processes, int iterations) {
+    struct timespec start, end;
+    SimulationStats totals;
+    int started = 0;
+
+    shared->counter = 0;
+    stats_reset(&shared->stats);
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (processes == 1) {
+        bench_loop(op, shared, sem_id, 0, iterations);
+    } else {
+        for (int p = 0; p < processes; p++) {
+            pid_t pid = fork();
+            if (pid == -1) {
+                perror("Bench: Failed to fork");
+                break;
+            }
+            if (pid == 0) {
+                bench_loop(op, shared, sem_id, p, iterations);
+                _exit(0);
+            }
+            started++;
+        }
+        while (started > 0 && wait(NULL) != -1) started--;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    stats_snapshot(&shared->stats, &totals);
+    if (shared->counter + totals.passengers_boarded != (long)processes * iterations) return -1;
+    return TIMESPEC_DIFF(start, end) * 1e9 / ((double)processes * iterations);
+}
+
+/**
+ * Prints one table row per update, uncontended and contended.
+ *
+ * @return 0 on success, 1 if an update was lost
+ */
+static int bench_table(const BenchOp* ops, size_t count, BenchShared* shared, int sem_id, int processes, int iterations) {
+    int status = 0;
+
+    printf("%-16s %16s %16s\n", "Update", "Uncontended", "Contended");
+    for (size_t i = 0; i < count; i++) {
+        double alone = bench_time(&ops[i], shared, sem_id, 1, iterations);
+        double contended = bench_time(&ops[i], shared, sem_id, processes, iterations);
+        if (alone < 0 || contended < 0) {
+            printf("%-16s lost updates: counter does not match\n", ops[i].name);
+            status = 1;
+            continue;
+        }
+        printf("%-16s %13.1f ns %13.1f ns\n", ops[i].name, alone, contended);
+    }
+    return status;
+}
+
+/**
+ * Checks that a holder dying does not leave a state mutex locked:
+ * a child takes the lock and exits, then the parent takes it.
+ *
+ * @param shared Shared memory holding the mutex
+ * @return 0 if the lock was recovered, -1 otherwise
+ */
+static int bench_owner_death(BenchShared* shared) {
+    pid_t pid = fork();
+
+    if (pid == -1) return -1;
+    if (pid == 0) {
+        state_mutex_lock(&shared->mutex);
+        _exit(0);
+    }
+    if (waitpid(pid, NULL, 0) == -1) return -1;
+    if (state_mutex_lock(&shared->mutex) != 0) return -1;
+    return state_mutex_unlock(&shared->mutex) == 0 ? 0 : -1;
+}
+
+/**
+ * Reads the docks in a loop until told to stop, like passengers polling at
+ * baggage check, either under the current ferry lock or through the seqlock.
+ *
+ * @return Number of reads
+ */
+static long bench_docks_reader(BenchShared* shared, SharedState* state, int seqlock) {
+    int docked[DOCK_MAX];
+    long reads = 0;
+
+    __atomic_fetch_add(&shared->ready, 1, __ATOMIC_RELAXED);
+    while (!__atomic_load_n(&shared->stop, __ATOMIC_RELAXED)) {
+        if (seqlock) {
+            docks_snapshot(state, docked);
+        } else {
+            state_mutex_lock(&state->locks[SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY].mutex);
+            for (int dock = 0; dock < state->dock_count; dock++) docked[dock] = state->docked_ferry[dock];
+            state_mutex_unlock(&state->locks[SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY].mutex);
+        }
+        reads++;
+    }
+    return reads;
+}
+
+/**
+ * Takes the current ferry lock for the writer, counting whether it had to wait.
+ *
+ * @return 1 if the lock was held by someone else, 0 otherwise
+ */
+static int bench_docks_lock(SharedState* state) {
+    pthread_mutex_t* lock = &state->locks[SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY].mutex;
+    int status = pthread_mutex_trylock(lock);
+
+    if (status == EOWNERDEAD) pthread_mutex_consistent(lock);
+    if (status != EBUSY) return 0;
+    state_mutex_lock(lock);
+    return 1;
+}
+
+/**
+ * Times a ferry docking and leaving, the way ferry managers do, while
+ * readers poll the docks.
+ *
+ * @param state Shared state of the docks
+ * @param readers Number of reader processes
+ * @param seqlock 1 if readers use the seqlock, 0 for the current ferry lock
+ * @param iterations Dock and leave cycles
+ * @param reads_per_second Filled with the reads of all readers per second
+ * @param blocked Filled with the share of lock acquisitions the writer waited for
+ * @return Nanoseconds per cycle
+ */
+static double bench_docks_time(BenchShared* shared, SharedState* state, int readers, int seqlock, int iterations,
+                               double* reads_per_second, double* blocked) {
+    struct timespec start, end;
+    int started = 0;
+    long waits = 0;
+
+    shared->stop = 0;
+    shared->ready = 0;
+    shared->counter = 0;
+    fflush(stdout);
+    for (int r = 0; r < readers; r++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Bench: Failed to fork");
+            break;
+        }
+        if (pid == 0) {
+            long reads = bench_docks_reader(shared, state, seqlock);
+            __atomic_fetch_add(&shared->counter, reads, __ATOMIC_RELAXED);
+            _exit(0);
+        }
+        started++;
+    }
+    // Time the ferry only once every reader is polling
+    while (__atomic_load_n(&shared->ready, __ATOMIC_RELAXED) < started) sched_yield();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        waits += bench_docks_lock(state);
+        docks_publish(state, 0, i % BENCH_FLEET);
+        state_mutex_unlock(&state->locks[SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY].mutex);
+        waits += bench_docks_lock(state);
+        docks_publish(state, 0, -1);
+        state_mutex_unlock(&state->locks[SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY].mutex);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    __atomic_store_n(&shared->stop, 1, __ATOMIC_RELAXED);
+    while (started > 0 && wait(NULL) != -1) started--;
+    *reads_per_second = shared->counter / TIMESPEC_DIFF(start, end);
+    *blocked = 100.0 * waits / (2.0 * iterations);
+    return TIMESPEC_DIFF(start, end) * 1e9 / iterations;
+}
+
+/**
+ * Prints how long a ferry takes to dock and leave with no readers and with
+ * BENCH_PROCESSES readers, under the current ferry lock and the seqlock.
+ */
+static void bench_docks(BenchShared* shared, SharedState* state, int readers, int iterations) {
+    static const char* MODES[] = { "State mutex", "Seqlock" };
+    char contended[32];
+
+    snprintf(contended, sizeof(contended), "%d readers", readers);
+    printf("%-16s %16s %16s %16s %16s\n", "Readers use", "No readers", contended, "Writer waited", "Reads/s");
+    for (int seqlock = 0; seqlock <= 1; seqlock++) {
+        double reads_per_second;
+        double blocked;
+        double alone = bench_docks_time(shared, state, 0, seqlock, iterations, &reads_per_second, &blocked);
+        double busy = bench_docks_time(shared, state, readers, seqlock, iterations, &reads_per_second, &blocked);
+        printf("%-16s %13.1f ns %13.1f ns %15.2f%% %16.0f\n", MODES[seqlock], alone, busy, blocked, reads_per_second);
+    }
+}
+
+/**
+ * Prints where each region of SharedState starts, as roles and tools see it.
+ *
+ * @return 1 if every region starts on a cache line, 0 otherwise
+ */
+static int bench_layout_print(void) {
+    size_t offsets[] = {
+        offsetof(SharedState, header), offsetof(SharedState, port_open), offsetof(SharedState, locks),
+        offsetof(SharedState, stats), offsetof(SharedState, baggage), offsetof(SharedState, ramps),
+        offsetof(SharedState, security), offsetof(SharedState, mailboxes), offsetof(SharedState, ferries)
+    };
+    int aligned = sizeof(StateLock) % CACHE_LINE_SIZE == 0 && sizeof(StatsShard) % CACHE_LINE_SIZE == 0 &&
+                  sizeof(BaggageBucket) % CACHE_LINE_SIZE == 0 && sizeof(RampLane) % CACHE_LINE_SIZE == 0 &&
+                  sizeof(SecurityRing) % CACHE_LINE_SIZE == 0 && sizeof(Mailbox) % CACHE_LINE_SIZE == 0 &&
+                  sizeof(FerryState) % CACHE_LINE_SIZE == 0;
+
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        if (offsets[i] % CACHE_LINE_SIZE != 0) aligned = 0;
+    }
+    printf("SharedState layout (version %d): header %zu, port and docks %zu, locks %zu (%zu each), "
+           "statistics %zu (%zu per shard), baggage buckets %zu (%zu each), ramp lanes %zu (%zu each), "
+           "security ring %zu, reply mailboxes %zu (%zu each), ferries %zu (%zu each)\n",
+           SHARED_STATE_VERSION, offsets[0], offsets[1], offsets[2], sizeof(StateLock),
+           offsets[3], sizeof(StatsShard), offsets[4], sizeof(BaggageBucket), offsets[5], sizeof(RampLane),
+           offsets[6], offsets[7], sizeof(Mailbox), offsets[8], sizeof(FerryState));
+    printf("Every region starts on a cache line: %s\n", aligned ? "yes" : "no");
+    return aligned;
+}
+
+/**
+ * Times counter updates by writer processes, each at its own offset, while
+ * reader processes poll the first bytes of the area.
+ *
+ * @param area Area the offsets are relative to
+ * @param offsets Offset of the counter of each writer
+ * @param writers Number of writer processes
+ * @param readers Number of reader processes
+ * @param iterations Updates per writer
+ * @return Nanoseconds per update
+ */
+static double bench_layout_time(BenchShared* shared, char* area, const size_t* offsets, int writers, int readers, int iterations) {
+    struct timespec start, end;
+    pid_t pids[2 * BENCH_LAYOUT_WORKERS_MAX];
+    int started = 0;
+
+    shared->stop = 0;
+    shared->ready = 0;
+    fflush(stdout);
+    for (int w = 0; w < writers + readers; w++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Bench: Failed to fork");
+            break;
+        }
+        if (pid == 0) {
+            __atomic_fetch_add(&shared->ready, 1, __ATOMIC_RELAXED);
+            while (__atomic_load_n(&shared->ready, __ATOMIC_RELAXED) < writers + readers) sched_yield();
+            if (w < writers) {
+                int* counter = (int*)(area + offsets[w]);
+                for (int i = 0; i < iterations; i++) __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+            } else {
+                const int* docks = (const int*)area;
+                while (!__atomic_load_n(&shared->stop, __ATOMIC_RELAXED)) {
+                    for (int dock = 0; dock < DOCK_MAX; dock++) (void)__atomic_load_n(&docks[dock], __ATOMIC_RELAXED);
+                }
+            }
+            _exit(0);
+        }
+        pids[started++] = pid;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int w = 0; w < started && w < writers; w++) waitpid(pids[w], NULL, 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    __atomic_store_n(&shared->stop, 1, __ATOMIC_RELAXED);
+    for (int w = writers; w < started; w++) waitpid(pids[w], NULL, 0);
+    return TIMESPEC_DIFF(start, end) * 1e9 / ((double)writers * iterations);
+}
+
+/**
+ * Shows false sharing in the old and the new layout: ferry managers writing
+ * their own ferries, packed or one per cache line, and statistics written
+ * next to the docks passengers poll, or on a line of their own.
+ *
+ * @param area Scratch area of BENCH_LAYOUT_WORKERS_MAX cache lines and more
+ * @param processes Number of processes
+ * @param iterations Updates per writer
+ */
+static void bench_layout(BenchShared* shared, char* area, int processes, int iterations) {
+    size_t packed[BENCH_LAYOUT_WORKERS_MAX];
+    size_t aligned[BENCH_LAYOUT_WORKERS_MAX];
+    int readers = processes > 1 ? processes - 1 : 0;
+
+    printf("%-16s %16s %16s\n", "Update", "Packed", "Cache line");
+    for (int w = 0; w < processes; w++) {
+        packed[w] = w * sizeof(BenchPackedFerry) + offsetof(BenchPackedFerry, passenger_count);
+        aligned[w] = w * sizeof(FerryState) + offsetof(FerryState, passenger_count);
+    }
+    printf("%-16s %13.1f ns %13.1f ns\n", "Ferry records",
+           bench_layout_time(shared, area, packed, processes, 0, iterations),
+           bench_layout_time(shared, area, aligned, processes, 0, iterations));
+
+    // One statistics writer; the old layout kept the counters right after the docks
+    packed[0] = DOCK_MAX * sizeof(int);
+    aligned[0] = CACHE_LINE_SIZE;
+    printf("%-16s %13.1f ns %13.1f ns\n", "Docks and stats",
+           bench_layout_time(shared, area, packed, 1, readers, iterations),
+           bench_layout_time(shared, area, aligned, 1, readers, iterations));
+}
+
+/**
+ * Waits at baggage check for the ferry of the baggage benchmark, the way
+ * passengers did before weight buckets (polling every 10 ms) or now.
+ * Counts every look at the docks in shared->counter.
+ *
+ * @param buckets 1 to sleep in the weight bucket, 0 to poll
+ * @param latency Filled with the nanoseconds from the ferry docking to the waiter seeing it
+ */
+static void bench_baggage_waiter(BenchShared* shared, SharedState* state, int buckets, double* latency) {
+    struct timespec seen;
+    int docked[DOCK_MAX];
+
+    __atomic_fetch_add(&shared->ready, 1, __ATOMIC_RELAXED);
+    while (1) {
+        uint32_t generation = baggage_wait_begin(state, BENCH_BAGGAGE_WEIGHT);
+        __atomic_fetch_add(&shared->counter, 1, __ATOMIC_RELAXED);
+        docks_snapshot(state, docked);
+        if (docked[0] != -1 && state->ferries[docked[0]].baggage_limit >= BENCH_BAGGAGE_WEIGHT) break;
+        if (buckets) {
+            baggage_wait(state, BENCH_BAGGAGE_WEIGHT, generation);
+        } else {
+            usleep(10000);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &seen);
+    *latency = TIMESPEC_DIFF(shared->docked_at, seen) * 1e9;
+}
+
+/**
+ * Runs rounds of passengers waiting at baggage check: they wait
+ * BENCH_BAGGAGE_IDLE_MS with no ferry docked, then a ferry that takes their
+ * bags docks and wakes them.
+ *
+ * @param state Shared state with one dock, ferries[0] taking every bag
+ * @param latencies Room for the latency of every waiter
+ * @param waiters Number of waiter processes
+ * @param buckets 1 to sleep in weight buckets, 0 to poll
+ * @param idle_checks Filled with the looks at the docks per second while no ferry is docked
+ * @param cpu Filled with the CPU time of the waiters per round, in milliseconds
+ * @param first Filled with the mean latency of the first waiter to see the ferry, in microseconds
+ * @param last Filled with the mean latency of the last one, in microseconds
+ */
+static void bench_baggage_time(BenchShared* shared, SharedState* state, double* latencies, int waiters, int buckets,
+                               double* idle_checks, double* cpu, double* first, double* last) {
+    struct rusage before, after;
+    long checks = 0;
+
+    *first = 0;
+    *last = 0;
+    getrusage(RUSAGE_CHILDREN, &before);
+    for (int round = 0; round < BENCH_BAGGAGE_ROUNDS; round++) {
+        int started = 0;
+        double low = -1, high = 0;
+
+        docks_publish(state, 0, -1);
+        shared->ready = 0;
+        shared->counter = 0;
+        fflush(stdout);
+        for (int w = 0; w < waiters; w++) {
+            pid_t pid = fork();
+            if (pid == -1) {
+                perror("Bench: Failed to fork");
+                break;
+            }
+            if (pid == 0) {
+                bench_baggage_waiter(shared, state, buckets, &latencies[w]);
+                _exit(0);
+            }
+            started++;
+        }
+        while (__atomic_load_n(&shared->ready, __ATOMIC_RELAXED) < started) sched_yield();
+        usleep(BENCH_BAGGAGE_IDLE_MS * 1000);
+        checks += __atomic_load_n(&shared->counter, __ATOMIC_RELAXED);
+
+        // Dock the ferry the way a ferry manager does
+        clock_gettime(CLOCK_MONOTONIC, &shared->docked_at);
+        state_mutex_lock(&state->locks[SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY].mutex);
+        docks_publish(state, 0, 0);
+        state_mutex_unlock(&state->locks[SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY].mutex);
+        baggage_wake(state, state->ferries[0].baggage_limit);
+
+        for (int w = 0; w < started; w++) wait(NULL);
+        for (int w = 0; w < started; w++) {
+            if (low < 0 || latencies[w] < low) low = latencies[w];
+            if (latencies[w] > high) high = latencies[w];
+        }
+        *first += low / 1000.0 / BENCH_BAGGAGE_ROUNDS;
+        *last += high / 1000.0 / BENCH_BAGGAGE_ROUNDS;
+    }
+    getrusage(RUSAGE_CHILDREN, &after);
+    *idle_checks = checks / (BENCH_BAGGAGE_ROUNDS * BENCH_BAGGAGE_IDLE_MS / 1000.0);
+    *cpu = ((after.ru_utime.tv_sec - before.ru_utime.tv_sec + after.ru_stime.tv_sec - before.ru_stime.tv_sec) * 1e3 +
+            (after.ru_utime.tv_usec - before.ru_utime.tv_usec + after.ru_stime.tv_usec - before.ru_stime.tv_usec) / 1e3) /
+           BENCH_BAGGAGE_ROUNDS;
+}
+
+/**
+ * Prints what passengers waiting at baggage check cost while no ferry takes
+ * their bags, and how long a ferry docking takes to reach them, polling
+ * every 10 ms and sleeping in weight buckets.
+ *
+ * @param state Shared state, followed by a scratch area of BENCH_LAYOUT_WORKERS_MAX cache lines
+ * @param waiters Number of waiter processes
+ */
+static void bench_baggage(BenchShared* shared, SharedState* state, int waiters) {
+    static const char* MODES[] = { "Polling 10 ms", "Weight buckets" };
+    // The ferry record is followed by the latencies of the waiters
+    double* latencies = (double*)&state->ferries[1];
+
+    state->dock_count = 1;
+    state->ferries[0].ferry_id = 0;
+    state->ferries[0].baggage_limit = BENCH_BAGGAGE_WEIGHT;
+    baggage_waiters_init(&state->baggage, 0, BAGGAGE_BUCKETS * BENCH_BAGGAGE_WEIGHT);
+
+    printf("%-16s %16s %16s %16s %16s\n", "Waiters", "Idle checks/s", "CPU per round", "First wake", "Last wake");
+    for (int buckets = 0; buckets <= 1; buckets++) {
+        double idle_checks, cpu, first, last;
+        bench_baggage_time(shared, state, latencies, waiters, buckets, &idle_checks, &cpu, &first, &last);
+        printf("%-16s %16.0f %13.2f ms %13.1f us %13.1f us\n", MODES[buckets], idle_checks, cpu, first, last);
+    }
+}
+
+/**
+ * Boards a passenger of the ramp benchmark again and again, through the old
+ * ramp queue and slot semaphores or through the ramp lane of dock 0.
+ *
+ * @param lane Ramp lane, NULL for the queue
+ * @param mailboxes Mailboxes the lane answers in
+ * @param queue_id Ramp queue
+ * @param sem_id Regular and VIP slot semaphores
+ * @param passenger_id Passenger id, odd ones are VIP
+ */
+static void bench_ramp_passenger(BenchShared* shared, RampLane* lane, Mailboxes* mailboxes, int queue_id, int sem_id,
+                                 int passenger_id) {
+    int vip = passenger_id % 2;
+    BenchRampMessage message;
+    RampEntry request;
+
+    __atomic_fetch_add(&shared->ready, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < BENCH_RAMP_BOARDINGS; i++) {
+        if (!lane) {
+            sem_wait_single_nointr_noundo(sem_id, vip);
+            message.mtype = vip ? RAMP_PRIORITY_VIP : RAMP_PRIORITY_REGULAR;
+            message.pid = getpid();
+            message.passenger_id = passenger_id;
+            message.weight = 0;
+            message.is_vip = vip;
+            message.approved = 0;
+            msgsnd(queue_id, &message, MSG_SIZE(message), 0);
+            msgrcv(queue_id, &message, MSG_SIZE(message), getpid(), 0);
+            message.mtype = RAMP_MESSAGE_EXIT;
+            msgsnd(queue_id, &message, MSG_SIZE(message), 0);
+            continue;
+        }
+        while (ramp_slot_wait(&lane->slots[vip]) == -1) {}
+        request.passenger_id = passenger_id;
+        request.weight = 0;
+        request.vip = vip;
+        request.mailbox = mailbox_claim(mailboxes, passenger_id);
+        ramp_ring_push(&lane->requests[vip], &request);
+        mailbox_wait(mailboxes, request.mailbox, -1);
+        ramp_ring_push(&lane->exits, &request);
+    }
+}
+
+/**
+ * Takes the next message off the ramp the way the ferry manager does:
+ * exits first, then VIP requests, then regular ones.
+ *
+ * @param lane Ramp lane, NULL for the queue
+ * @param queue_id Ramp queue
+ * @param entry Filled with the message, mailbox holding the PID for the queue
+ * @return RAMP_MESSAGE_EXIT..RAMP_PRIORITY_REGULAR, -1 if the ramp is empty
+ */
+static int bench_ramp_receive(RampLane* lane, int queue_id, RampEntry* entry) {
+    BenchRampMessage message;
+
+    if (lane) return ramp_receive(lane, entry);
+    if (msgrcv(queue_id, &message, MSG_SIZE(message), -RAMP_PRIORITY_REGULAR, IPC_NOWAIT) == -1) return -1;
+    entry->passenger_id = message.passenger_id;
+    entry->vip = message.is_vip;
+    entry->mailbox = (int)message.pid;
+    return (int)message.mtype;
+}
+
+/**
+ * Plays the ferry at dock 0 while BENCH_PROCESSES passengers board: it
+ * grants every request and opens a slot again for every passenger leaving
+ * the ramp.
+ *
+ * @param lane Ramp lane, NULL for the queue
+ * @param mailboxes Mailboxes the lane answers in
+ * @param queue_id Ramp queue
+ * @param sem_id Regular and VIP slot semaphores
+ * @param passengers Number of passenger processes
+ * @param on_ramp Filled with the most passengers on the ramp at once
+ * @return Boardings per second
+ */
+static double bench_ramp_time(BenchShared* shared, RampLane* lane, Mailboxes* mailboxes, int queue_id, int sem_id,
+                              int passengers, int* on_ramp) {
+    static const int CAPACITY[] = { BENCH_RAMP_CAPACITY_REG, BENCH_RAMP_CAPACITY_VIP };
+    struct timespec start, end;
+    BenchRampMessage answer;
+    RampEntry entry;
+    long boarded = 0;
+    int usage = 0;
+    int started = 0;
+
+    *on_ramp = 0;
+    shared->ready = 0;
+    fflush(stdout);
+    for (int p = 0; p < passengers; p++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Bench: Failed to fork");
+            break;
+        }
+        if (pid == 0) {
+            bench_ramp_passenger(shared, lane, mailboxes, queue_id, sem_id, p);
+            _exit(0);
+        }
+        started++;
+    }
+    while (__atomic_load_n(&shared->ready, __ATOMIC_RELAXED) < started) sched_yield();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int vip = 0; vip <= 1; vip++) {
+        if (lane) {
+            ramp_slot_post(&lane->slots[vip], CAPACITY[vip]);
+        } else {
+            sem_signal_noundo(sem_id, vip, CAPACITY[vip]);
+        }
+    }
+    while (boarded < (long)started * BENCH_RAMP_BOARDINGS) {
+        int kind = bench_ramp_receive(lane, queue_id, &entry);
+        if (kind == -1) {
+            sched_yield();
+        } else if (kind == RAMP_MESSAGE_EXIT) {
+            usage--;
+            boarded++;
+            if (lane) {
+                ramp_slot_post(&lane->slots[entry.vip], 1);
+            } else {
+                sem_signal_single_noundo(sem_id, entry.vip);
+            }
+        } else {
+            if (++usage > *on_ramp) *on_ramp = usage;
+            if (lane) {
+                mailbox_post(mailboxes, entry.mailbox, 1);
+            } else {
+                answer.mtype = entry.mailbox;
+                answer.pid = entry.mailbox;
+                answer.approved = 1;
+                answer.passenger_id = entry.passenger_id;
+                answer.weight = 0;
+                answer.is_vip = entry.vip;
+                msgsnd(queue_id, &answer, MSG_SIZE(answer), 0);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    for (int p = 0; p < started; p++) wait(NULL);
+
+    // Slots left open for the next run
+    for (int vip = 0; vip <= 1; vip++) {
+        if (lane) {
+            while (ramp_slot_trywait(&lane->slots[vip]) != -1) {}
+        } else {
+            while (sem_trywait_single_noundo(sem_id, vip) != -1) {}
+        }
+    }
+    return boarded / TIMESPEC_DIFF(start, end);
+}
+
+/**
+ * Prints how fast passengers board through the ramp queue the ramp used to
+ * run on and through a ramp lane in shared memory, and checks that neither
+ * let more passengers onto the ramp than it has slots.
+ *
+ * @param state Shared state whose dock 0 lane is used
+ * @param passengers Number of passenger processes
+ * @return 0 on success, 1 if a ramp overflowed or the queue could not be created
+ */
+static int bench_ramp(BenchShared* shared, SharedState* state, int passengers) {
+    static const char* MODES[] = { "Message queue", "Shared lane" };
+    unsigned short slots[2] = { 0, 0 };
+    int status = 0;
+    int queue_id;
+    int sem_id;
+
+    // The System V queue the ramp lanes replaced, whatever TRANSPORT says
+    if ((queue_id = msgget(IPC_PRIVATE, IPC_CREAT | 0600)) == -1) {
+        perror("Bench: Failed to create ramp queue");
+        return 1;
+    }
+    if ((sem_id = sem_create(IPC_PRIVATE, 2, slots)) == -1) {
+        perror("Bench: Failed to create ramp slots");
+        msgctl(queue_id, IPC_RMID, NULL);
+        return 1;
+    }
+    ramp_lanes_init(state);
+    mailboxes_init(&state->mailboxes);
+
+    printf("%-16s %16s %16s\n", "Ramp", "Boardings/s", "Max on ramp");
+    for (int shared_lane = 0; shared_lane <= 1; shared_lane++) {
+        int on_ramp;
+        double rate = bench_ramp_time(shared, shared_lane ? &state->ramps[0] : NULL, &state->mailboxes, queue_id, sem_id,
+                                      passengers, &on_ramp);
+        printf("%-16s %16.0f %16d\n", MODES[shared_lane], rate, on_ramp);
+        if (on_ramp > BENCH_RAMP_CAPACITY_REG + BENCH_RAMP_CAPACITY_VIP) status = 1;
+    }
+    printf("Ramp capacity kept: %s\n", status == 0 ? "yes" : "no");
+
+    sem_close(sem_id);
+    msgctl(queue_id, IPC_RMID, NULL);
+    return status;
+}
+
+/**
+ * Times the security manager taking one request in: off the old security
+ * queue, behind replies not yet read by their passengers, or off the
+ * security ring, where replies never queue.
+ *
+ * @param ring Security ring, NULL for the queue
+ * @param queue_id Security queue, holding the backlog of replies
+ * @param iterations Requests to send and take
+ * @return Nanoseconds per request, negative if a request was lost
+ */
+static double bench_security_time(SecurityRing* ring, int queue_id, int iterations) {
+    struct timespec start, end;
+    BenchSecurityMessage message = { 1, 1, 1, 0, 0, 0 };
+    SecurityRequest request = { 0, 1, 0, 1, 0, 0 };
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        if (ring) {
+            request.passenger_id = i;
+            if (security_ring_push(ring, &request) == -1 || security_ring_pop(ring, &request) == -1) return -1;
+        } else {
+            message.mtype = 1;
+            message.passenger_id = i;
+            if (msgsnd(queue_id, &message, MSG_SIZE(message), 0) == -1 ||
+                msgrcv(queue_id, &message, MSG_SIZE(message), 1, IPC_NOWAIT) == -1) return -1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return TIMESPEC_DIFF(start, end) * 1e9 / iterations;
+}
+
+/**
+ * Prints the cost of security intake against the number of replies waiting
+ * for passengers: a typed receive on the shared queue walks past them, the
+ * security ring does not.
+ *
+ * @param state Shared state whose security ring is used
+ * @param iterations Requests per backlog
+ * @return 0 on success, 1 on error
+ */
+static int bench_security(SharedState* state, int iterations) {
+    BenchSecurityMessage reply = { 0, 1, 0, 0, 0, 0 };
+    int queued = 0;
+    int status = 0;
+    int queue_id;
+
+    // The System V queue the security ring replaced, whatever TRANSPORT says
+    if ((queue_id = msgget(IPC_PRIVATE, IPC_CREAT | 0600)) == -1) {
+        perror("Bench: Failed to create security queue");
+        return 1;
+    }
+    security_ring_init(&state->security);
+
+    printf("%-16s %16s %16s\n", "Backlog", "Message queue", "Shared ring");
+    for (size_t b = 0; b < sizeof(BENCH_SECURITY_BACKLOGS) / sizeof(BENCH_SECURITY_BACKLOGS[0]); b++) {
+        double queue_ns, ring_ns;
+
+        // Replies to passengers still screening, typed by pids above every request type
+        for (; queued < BENCH_SECURITY_BACKLOGS[b]; queued++) {
+            reply.mtype = 1000000 + queued;
+            reply.pid = reply.mtype;
+            if (msgsnd(queue_id, &reply, MSG_SIZE(reply), IPC_NOWAIT) == -1) {
+                perror("Bench: Failed to queue a reply");
+                status = 1;
+                break;
+            }
+        }
+        if (status) break;
+        queue_ns = bench_security_time(NULL, queue_id, iterations);
+        ring_ns = bench_security_time(&state->security, queue_id, iterations);
+        printf("%-16d %13.1f ns %13.1f ns\n", BENCH_SECURITY_BACKLOGS[b], queue_ns, ring_ns);
+        if (queue_ns < 0 || ring_ns < 0) status = 1;
+    }
+
+    msgctl(queue_id, IPC_RMID, NULL);
+    return status;
+}
+
+static long bench_cpu_usec(const struct rusage* usage) {
+    return (usage->ru_utime.tv_sec + usage->ru_stime.tv_sec) * 1000000L + usage->ru_utime.tv_usec + usage->ru_stime.tv_usec;
+}
+
+/**
+ * Boards a passenger of the boarding benchmark BENCH_BOARDING_ROUNDS times,
+ * a random 0.5 to 1.5 BENCH_BOARDING_GAP_USEC apart, and adds the time from
+ * each request to its grant to shared->grant_ns.
+ *
+ * @param lane Ramp lane of dock 0
+ * @param mailboxes Mailboxes the lane answers in
+ * @param passenger_id Passenger id
+ */
+static void bench_boarding_passenger(BenchShared* shared, RampLane* lane, Mailboxes* mailboxes, int passenger_id) {
+    struct timespec sent, granted;
+    RampEntry request = { 0, getpid(), passenger_id, 0, 0, 0, 0 };
+    unsigned int seed = (unsigned int)getpid();
+    long grant_ns = 0;
+
+    __atomic_fetch_add(&shared->ready, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < BENCH_BOARDING_ROUNDS; i++) {
+        usleep(BENCH_BOARDING_GAP_USEC / 2 + rand_r(&seed) % BENCH_BOARDING_GAP_USEC);
+        request.mailbox = mailbox_claim(mailboxes, passenger_id);
+        clock_gettime(CLOCK_MONOTONIC, &sent);
+        ramp_send(lane, &lane->requests[0], &request);
+        mailbox_wait(mailboxes, request.mailbox, -1);
+        clock_gettime(CLOCK_MONOTONIC, &granted);
+        grant_ns += (long)(TIMESPEC_DIFF(sent, granted) * 1e9);
+        ramp_send(lane, &lane->exits, &request);
+    }
+    __atomic_fetch_add(&shared->grant_ns, grant_ns, __ATOMIC_RELAXED);
+}
+
+/**
+ * Plays the ferry at dock 0 while BENCH_PROCESSES passengers board now and
+ * then: it grants every request. With the lane empty it sleeps 1 ms, as the
+ * boarding loop used to, or on the doorbell of the lane.
+ *
+ * @param lane Ramp lane of dock 0
+ * @param mailboxes Mailboxes the lane answers in
+ * @param passengers Number of passenger processes
+ * @param doorbell 1 to sleep on the doorbell, 0 to poll every millisecond
+ * @param grant_us Filled with the mean time from a request to its grant
+ * @param cpu Filled with the CPU time of the ferry per second, in milliseconds
+ * @param wakeups Filled with the times per second the ferry woke to find the lane still empty
+ */
+static void bench_boarding_time(BenchShared* shared, RampLane* lane, Mailboxes* mailboxes, int passengers, int doorbell,
+                                double* grant_us, double* cpu, double* wakeups) {
+    struct timespec start, end;
+    struct rusage before, after;
+    RampEntry entry;
+    long boarded = 0;
+    long idle = 0;
+    int slept = 0;
+    int started = 0;
+
+    shared->ready = 0;
+    shared->grant_ns = 0;
+    fflush(stdout);
+    for (int p = 0; p < passengers; p++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Bench: Failed to fork");
+            break;
+        }
+        if (pid == 0) {
+            bench_boarding_passenger(shared, lane, mailboxes, p);
+            _exit(0);
+        }
+        started++;
+    }
+    while (__atomic_load_n(&shared->ready, __ATOMIC_RELAXED) < started) sched_yield();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    getrusage(RUSAGE_SELF, &before);
+    while (boarded < (long)started * BENCH_BOARDING_ROUNDS) {
+        uint32_t rings = ramp_lane_wait_begin(lane);
+        int kind = ramp_receive(lane, &entry);
+        if (kind == -1 && slept) idle++;
+        slept = kind == -1;
+        if (kind == RAMP_MESSAGE_EXIT) {
+            boarded++;
+        } else if (kind != -1) {
+            mailbox_post(mailboxes, entry.mailbox, 1);
+        } else {
+            if (doorbell) {
+                ramp_lane_wait(lane, rings, LLONG_MAX);
+            } else {
+                usleep(1000);
+            }
+        }
+    }
+    getrusage(RUSAGE_SELF, &after);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    for (int p = 0; p < started; p++) wait(NULL);
+
+    *grant_us = started ? shared->grant_ns / 1e3 / ((double)started * BENCH_BOARDING_ROUNDS) : 0;
+    *cpu = (bench_cpu_usec(&after) - bench_cpu_usec(&before)) / 1e3 / TIMESPEC_DIFF(start, end);
+    *wakeups = idle / TIMESPEC_DIFF(start, end);
+}
+
+/**
+ * Prints how long a passenger waits for the ramp and what an idle ferry
+ * costs, with the ferry polling its lane every millisecond as it used to and
+ * sleeping on the doorbell of the lane.
+ *
+ * @param state Shared state whose dock 0 lane is used
+ * @param passengers Number of passenger processes
+ */
+static void bench_boarding(BenchShared* shared, SharedState* state, int passengers) {
+    static const char* MODES[] = { "Polling 1 ms", "Doorbell" };
+
+    ramp_lanes_init(state);
+    mailboxes_init(&state->mailboxes);
+
+    printf("%-16s %16s %16s %16s\n", "Ferry", "Grant latency", "Ferry CPU/s", "Empty wakeups/s");
+    for (int doorbell = 0; doorbell <= 1; doorbell++) {
+        double grant_us, cpu, wakeups;
+        bench_boarding_time(shared, &state->ramps[0], &state->mailboxes, passengers, doorbell, &grant_us, &cpu, &wakeups);
+        printf("%-16s %13.1f us %13.2f ms %16.0f\n", MODES[doorbell], grant_us, cpu, wakeups);
+    }
+}
+
+// Passenger process of the control benchmark: where it counts the signals it
+// takes, and whether SIGUSR2 closed the port for it
+static BenchShared* bench_control_shared;
+static volatile sig_atomic_t bench_control_closed = 0;
+
+static void bench_control_handler(int signum) {
+    __atomic_fetch_add(&bench_control_shared->counter, 1, __ATOMIC_RELAXED);
+    if (signum == SIGUSR2) bench_control_closed = 1;
+}
+
+/**
+ * Waits at baggage check for a ferry that never docks until the port closes,
+ * with the passenger signal handlers installed. Counts every signal taken in
+ * shared->counter and the CPU time spent waiting in shared->busy.
+ */
+static void bench_control_passenger(BenchShared* shared, SharedState* state) {
+    struct sigaction sa;
+    struct rusage before, after;
+
+    bench_control_shared = shared;
+    sa.sa_handler = bench_control_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+    sigaction(SIGUSR2, &sa, NULL);
+    getrusage(RUSAGE_SELF, &before);
+    __atomic_fetch_add(&shared->ready, 1, __ATOMIC_RELAXED);
+    while (!bench_control_closed && state->port_open) {
+        uint32_t generation = baggage_wait_begin(state, BENCH_BAGGAGE_WEIGHT);
+        if (bench_control_closed || !state->port_open) break;
+        baggage_wait(state, BENCH_BAGGAGE_WEIGHT, generation);
+    }
+    getrusage(RUSAGE_SELF, &after);
+    __atomic_fetch_add(&shared->busy, bench_cpu_usec(&after) - bench_cpu_usec(&before), __ATOMIC_RELAXED);
+}
+
+/**
+ * Runs rounds of passengers waiting at baggage check, in a process group of
+ * their own, through one depart-now and then the closure of the port. The
+ * broadcast does what the port manager used to: signal the whole group
+ * (SIGUSR1 for a departure, SIGUSR2 and SIGUSR1 for the closure), then clear
+ * port_open and wake the sleepers. The control channel bumps the record of
+ * the ferry for a departure, and only clears port_open and wakes the sleepers
+ * for the closure.
+ *
+ * @param state Shared state, ferries[0] the ferry asked to depart
+ * @param passengers Number of passenger processes
+ * @param broadcast 1 to signal the process group, 0 to notify like the control channel
+ * @param signals Filled with the signals the passengers took per depart-now
+ * @param close_ms Filled with the mean time from the closure to the last passenger exiting
+ * @param cpu Filled with the CPU time of the passengers per round, in milliseconds
+ */
+static void bench_control_time(BenchShared* shared, SharedState* state, int passengers, int broadcast,
+                               double* signals, double* close_ms, double* cpu) {
+    *signals = 0;
+    *close_ms = 0;
+    shared->busy = 0;
+    for (int round = 0; round < BENCH_CONTROL_ROUNDS; round++) {
+        struct timespec closed_at, empty_at;
+        pid_t group = 0;
+        int started = 0;
+
+        state->port_open = 1;
+        shared->ready = 0;
+        shared->counter = 0;
+        fflush(stdout);
+        for (int p = 0; p < passengers; p++) {
+            pid_t pid = fork();
+            if (pid == -1) {
+                perror("Bench: Failed to fork");
+                break;
+            }
+            if (pid == 0) {
+                setpgid(0, group);
+                bench_control_passenger(shared, state);
+                _exit(0);
+            }
+            // Set on both sides, whichever runs first
+            setpgid(pid, group);
+            if (!group) group = pid;
+            started++;
+        }
+        while (__atomic_load_n(&shared->ready, __ATOMIC_RELAXED) < started) sched_yield();
+        usleep(BENCH_CONTROL_IDLE_MS * 1000);
+
+        // depart-now for one ferry
+        if (broadcast && group) {
+            kill(-group, SIGUSR1);
+        } else {
+            __atomic_fetch_add(&state->ferries[0].depart_requests, 1, __ATOMIC_RELAXED);
+        }
+        usleep(BENCH_CONTROL_IDLE_MS * 1000);
+        *signals += (double)__atomic_load_n(&shared->counter, __ATOMIC_RELAXED) / BENCH_CONTROL_ROUNDS;
+
+        // close-port
+        clock_gettime(CLOCK_MONOTONIC, &closed_at);
+        if (broadcast && group) {
+            kill(-group, SIGUSR2);
+            kill(-group, SIGUSR1);
+        }
+        __atomic_store_n(&state->port_open, 0, __ATOMIC_SEQ_CST);
+        baggage_wake_all(state);
+        ramp_wake_all(state);
+        for (int p = 0; p < started; p++) wait(NULL);
+        clock_gettime(CLOCK_MONOTONIC, &empty_at);
+        *close_ms += TIMESPEC_DIFF(closed_at, empty_at) * 1e3 / BENCH_CONTROL_ROUNDS;
+    }
+    *cpu = shared->busy / 1e3 / BENCH_CONTROL_ROUNDS;
+}
+
+/**
+ * Prints what notifying the roles costs the passengers: the signals they
+ * take for a single ferry's departure, how long the closure takes to empty
+ * the port, and the CPU time they spend, with the process-group broadcasts
+ * the port manager used to send and with the control channel.
+ *
+ * @param state Shared state
+ * @param passengers Number of passenger processes
+ */
+static void bench_control(BenchShared* shared, SharedState* state, int passengers) {
+    static const char* MODES[] = { "Control channel", "Group signals" };
+
+    state->ferries[0].ferry_id = 0;
+    baggage_waiters_init(&state->baggage, 0, BAGGAGE_BUCKETS * BENCH_BAGGAGE_WEIGHT);
+
+    printf("%-16s %16s %16s %16s\n", "Notification", "Signals/depart", "Close to empty", "CPU per round");
+    for (int broadcast = 1; broadcast >= 0; broadcast--) {
+        double signals, close_ms, cpu;
+        bench_control_time(shared, state, passengers, broadcast, &signals, &close_ms, &cpu);
+        printf("%-16s %16.0f %13.1f ms %13.2f ms\n", MODES[broadcast], signals, close_ms, cpu);
+    }
+}
+
+/**
+ * Runs a benchmark on fresh shared memory and a fresh semaphore. The locks
+ * benchmark compares the System V semaphores the shared state used to be
+ * guarded by with the process-shared mutexes embedded in it now; the stats
+ * benchmark compares a locked counter with the sharded atomic statistics;
+ * the docks benchmark times a ferry docking while passengers read the docks
+ * under the lock or through the seqlock; the layout benchmark compares the
+ * packed and the cache line layouts of SharedState; the baggage benchmark
+ * compares passengers polling the docks with passengers asleep in weight
+ * buckets; the ramp benchmark compares boarding through the ramp queue with
+ * boarding through a ramp lane; the control benchmark compares the signals
+ * the port manager broadcast to its process group with the control channel;
+ * the boarding benchmark times ramp grants by a polling and a sleeping ferry.
+ * All these run with BENCH_PROCESSES processes.
+ * The security benchmark times security intake in one process.
+ *
+ * @param kind Benchmark to run
+ * @return 0 on success, 1 on error
+ */
+static int bench_shared(BenchKind kind) {
+    static const char* NAMES[] = { "Lock", "Statistics", "Docks", "Layout", "Baggage", "Ramp", "Security", "Control", "Boarding" };
+    unsigned short initial = 1;
+    int iterations = CONFIG_GET_INT_OR("BENCH_ITERATIONS", BENCH_ITERATIONS_DEFAULT);
+    int processes = CONFIG_GET_INT_OR("BENCH_PROCESSES", BENCH_PROCESSES_DEFAULT);
+    BenchShared* shared;
+    SharedState* state;
+    int shm_id;
+    int sem_id;
+    int status;
+
+    if (iterations < 1 || processes < 1) {
+        printf("BENCH_ITERATIONS and BENCH_PROCESSES must be positive\n");
+        return 1;
+    }
+    if ((kind == BENCH_LAYOUT || kind == BENCH_BAGGAGE) && processes > BENCH_LAYOUT_WORKERS_MAX) {
+        printf("BENCH=layout and BENCH=baggage run at most %d processes\n", BENCH_LAYOUT_WORKERS_MAX);
+        return 1;
+    }
+    // The docks live in a shared state of their own, right after the benchmark's data,
+    // followed by the scratch area of the layout benchmark
+    if ((shm_id = shm_create(IPC_PRIVATE, sizeof(BenchShared) + sizeof(SharedState) +
+                                          BENCH_LAYOUT_WORKERS_MAX * sizeof(FerryState))) == -1) {
+        perror("Bench: Failed to create shared memory");
+        return 1;
+    }
+    shared = (BenchShared*)shm_attach(shm_id);
+    // Segment goes away with the last detach
+    shm_close(shm_id);
+    if (shared == (void*)-1) {
+        perror("Bench: Failed to attach shared memory");
+        return 1;
+    }
+    if ((sem_id = sem_create(IPC_PRIVATE, 1, &initial)) == -1) {
+        perror("Bench: Failed to create semaphore");
+        shm_detach(shared);
+        return 1;
+    }
+    state_mutex_init(&shared->mutex);
+    state = (SharedState*)(shared + 1);
+    state_locks_init(state);
+    state->dock_count = DOCK_MAX;
+    for (int dock = 0; dock < DOCK_MAX; dock++) state->docked_ferry[dock] = -1;
+
+    if (kind == BENCH_BAGGAGE) {
+        printf("%s benchmark: %d rounds, %d waiting processes\n", NAMES[kind], BENCH_BAGGAGE_ROUNDS, processes);
+    } else if (kind == BENCH_RAMP) {
+        printf("%s benchmark: %d boardings per process, %d boarding processes\n", NAMES[kind], BENCH_RAMP_BOARDINGS, processes);
+    } else if (kind == BENCH_SECURITY) {
+        printf("%s benchmark: %d requests per backlog\n", NAMES[kind], iterations);
+    } else if (kind == BENCH_CONTROL) {
+        printf("%s benchmark: %d rounds, %d waiting passengers\n", NAMES[kind], BENCH_CONTROL_ROUNDS, processes);
+    } else if (kind == BENCH_BOARDING) {
+        printf("%s benchmark: %d passengers boarding %d times, %d us apart on average\n", NAMES[kind], processes,
+               BENCH_BOARDING_ROUNDS, BENCH_BOARDING_GAP_USEC);
+    } else {
+        printf("%s benchmark: %d iterations per process, %d contending processes\n", NAMES[kind], iterations, processes);
+    }
+    status = 0;
+    if (kind == BENCH_LOCKS) {
+        status = bench_table(LOCKS, sizeof(LOCKS) / sizeof(LOCKS[0]), shared, sem_id, processes, iterations);
+        if (bench_owner_death(shared) == 0) {
+            printf("Owner death: lock recovered\n");
+        } else {
+            printf("Owner death: lock NOT recovered\n");
+            status = 1;
+        }
+    } else if (kind == BENCH_STATS) {
+        status = bench_table(COUNTERS, sizeof(COUNTERS) / sizeof(COUNTERS[0]), shared, sem_id, processes, iterations);
+    } else if (kind == BENCH_DOCKS) {
+        bench_docks(shared, state, processes, iterations);
+    } else if (kind == BENCH_LAYOUT) {
+        if (!bench_layout_print()) status = 1;
+        bench_layout(shared, (char*)(state + 1), processes, iterations);
+    } else if (kind == BENCH_BAGGAGE) {
+        bench_baggage(shared, state, processes);
+    } else if (kind == BENCH_RAMP) {
+        status = bench_ramp(shared, state, processes);
+    } else if (kind == BENCH_SECURITY) {
+        status = bench_security(state, iterations);
+    } else if (kind == BENCH_CONTROL) {
+        bench_control(shared, state, processes);
+    } else {
+        bench_boarding(shared, state, processes);
+    }
+
+    sem_close(sem_id);
+    shm_detach(shared);
+    return status;
+}
+
+/**
+ * Runs the microbenchmark selected by BENCH.
+ *
+ * @param name Benchmark name
+ * @return 0 on success, 1 on error
+ */
+int bench_run(const char* name) {
+    if (strcmp(name, "locks") == 0) return bench_shared(BENCH_LOCKS);
+    if (strcmp(name, "stats") == 0) return bench_shared(BENCH_STATS);
+    if (strcmp(name, "docks") == 0) return bench_shared(BENCH_DOCKS);
+    if (strcmp(name, "layout") == 0) return bench_shared(BENCH_LAYOUT);
+    if (strcmp(name, "baggage") == 0) return bench_shared(BENCH_BAGGAGE);
+    if (strcmp(name, "ramp") == 0) return bench_shared(BENCH_RAMP);
+    if (strcmp(name, "security") == 0) return bench_shared(BENCH_SECURITY);
+    if (strcmp(name, "control") == 0) return bench_shared(BENCH_CONTROL);
+    if (strcmp(name, "boarding") == 0) return bench_shared(BENCH_BOARDING);
+    printf("Unknown BENCH: %s (expected locks, stats, docks, layout, baggage, ramp, security, control or boarding)\n", name);
+    return 1;
+}
@@ -0,0 +1,1162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "common/config.h"
+#include "common/state.h"
+#include "common/logging.h"
+#include "common/arrivals.h"
+#include "common/trace.h"
+#include "processes/passenger.h"
+#include "engine/des.h"
+
+#define GENDER_NAME(gender) ((gender) == GENDER_MAN ? "MALE" : "FEMALE")
+
+typedef enum DesEventType {
+    DES_EVENT_PASSENGER_ARRIVAL,
+    DES_EVENT_SECURITY_DONE,
+    DES_EVENT_GATE_OPEN,
+    DES_EVENT_DEPARTURE_DEADLINE,
+    DES_EVENT_BOARDING_DONE,
+    DES_EVENT_FERRY_RETURN,
+    DES_EVENT_PORT_CLOSE
+} DesEventType;
+
+typedef struct DesEvent {
+    SimTime time;
+    unsigned long long seq;     // Scheduling order, keeps simultaneous events FIFO
+    DesEventType type;
+    int subject;                // Passenger or ferry index
+    int detail;                 // Security station or ferry, depending on the event
+} DesEvent;
+
+// FIFO of passenger or ferry indices, linked through a separate next array
+typedef struct DesList {
+    int head;
+    int tail;
+    int size;
+} DesList;
+
+typedef struct DesPassenger {
+    PassengerTicket ticket;
+    int dangerous;
+    int frustration;
+    SimTime arrival;
+    SimTime wait_start;         // Start of the current wait at baggage check
+    int dock;                   // Dock whose ramp lane the passenger waits in
+} DesPassenger;
+
+typedef struct DesStation {
+    Gender gender;
+    int usage;
+} DesStation;
+
+typedef struct DesFerry {
+    FerryState state;
+    int running;
+    int gate_open;
+    int gate_close;
+    int on_ramp;
+    int on_ramp_vip;
+    int dock;
+    SimTime dock_time;
+} DesFerry;
+
+typedef struct Des {
+    const DesConfig* config;
+    FILE* log_file;
+    SimulationStats* stats;
+    SimTime now;
+    unsigned long long seq;
+    unsigned long long events;
+    unsigned long long rng;
+
+    // Binary min-heap ordered by (time, seq). Every passenger and ferry has at most
+    // one pending event, so the capacity is fixed up front.
+    DesEvent* heap;
+    int heap_size;
+    int heap_capacity;
+
+    DesPassenger* passengers;
+    int passenger_count;        // PASSENGER_COUNT, or fewer when the trace is shorter
+    int* passenger_next;
+    SimTime* board_times;       // Time to board of every boarded passenger
+    int board_count;
+    DesFerry* ferries;
+    int* ferry_next;
+
+    DesList* baggage_waiting;   // Passengers waiting at baggage check, one list per bag weight
+    BaggageWaiters baggage;     // Weight buckets, only to wake whom a docking ferry wakes in the other engines
+    DesList security_wait;      // Waiting for one of the security permits
+    DesList security_requests;  // Security manager message queue
+    int security_internal;      // Security manager internal queue, -1 if empty
+    int security_permits;
+    DesStation stations[SECURITY_STATIONS];
+    DesList ramp_vip[DOCK_MAX];     // Waiting for a VIP ramp slot, one line per dock
+    DesList ramp_regular[DOCK_MAX]; // Waiting for a regular ramp slot, one line per dock
+    DesList dock_queue;         // Ferries waiting for a dock
+
+    int docked_ferry[DOCK_MAX]; // Ferry boarding at each dock, -1 if the dock is free
+    int docked_count;
+    SimTime docks_busy_since;   // Since when at least one ferry has been docked
+    int port_open;
+    int max_baggage_limit;
+    int finished;
+    int stranded;
+
+    Trace trace;
+    int tracing;
+    SimTime trace_next_arrival; // Recorded arrival of the next passenger
+
+    int checkpointed;           // CHECKPOINT already written by this run
+} Des;
+
+/**
+ * Checkpoint file header. It is followed by the Des struct itself (pointers
+ * are rebuilt on load) and the contents of every table it points to. The
+ * layout is that of the build that wrote it, so des_size guards against
+ * resuming with another build.
+ */
+typedef struct DesCheckpointHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t des_size;
+    unsigned char model[DES_CONFIG_MODEL_SIZE];
+    int tracing;
+    unsigned long long seed;
+    SimulationStats stats;
+} DesCheckpointHeader;
+
+static void des_log(Des* des, Role role, int identifier, const char* message, ...) {
+    va_list args;
+    long long seconds;
+
+    if (!des->log_file) return;
+    seconds = des->now / DES_USEC_PER_SEC;
+    fprintf(des->log_file, "(%02lld:%02lld:%02lld) ", seconds / 3600, seconds / 60 % 60, seconds % 60);
+    if (identifier == -1) {
+        fprintf(des->log_file, "[%s] ", ROLE_NAMES[role - 1]);
+    } else {
+        fprintf(des->log_file, "[%s_%04d] ", ROLE_NAMES[role - 1], identifier);
+    }
+    va_start(args, message);
+    vfprintf(des->log_file, message, args);
+    va_end(args);
+    fputc('\n', des->log_file);
+}
+
+/**
+ * SplitMix64 generator. Each run owns its stream so results depend only on the seed.
+ *
+ * @return Pseudo-random value in the range of rand()
+ */
+static int des_rand(Des* des) {
+    unsigned long long z = (des->rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (int)((z ^ (z >> 31)) >> 33);
+}
+
+static double des_uniform(Des* des) {
+    return des_rand(des) / 2147483648.0;
+}
+
+static void list_push(DesList* list, int* next, int item) {
+    next[item] = -1;
+    if (list->tail == -1) list->head = item; else next[list->tail] = item;
+    list->tail = item;
+    list->size++;
+}
+
+static int list_pop(DesList* list, int* next) {
+    int item = list->head;
+    if (item == -1) return -1;
+    list->head = next[item];
+    if (list->head == -1) list->tail = -1;
+    list->size--;
+    return item;
+}
+
+static void list_init(DesList* list) {
+    list->head = -1;
+    list->tail = -1;
+    list->size = 0;
+}
+
+static int compare_sim_time(const void* a, const void* b) {
+    SimTime lhs = *(const SimTime*)a;
+    SimTime rhs = *(const SimTime*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static int event_before(const DesEvent* a, const DesEvent* b) {
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+
+static void des_schedule(Des* des, SimTime delay, DesEventType type, int subject, int detail) {
+    DesEvent event = { des->now + delay, des->seq++, type, subject, detail };
+    int index = des->heap_size++;
+
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!event_before(&event, &des->heap[parent])) break;
+        des->heap[index] = des->heap[parent];
+        index = parent;
+    }
+    des->heap[index] = event;
+}
+
+static DesEvent des_next_event(Des* des) {
+    DesEvent top = des->heap[0];
+    DesEvent last = des->heap[--des->heap_size];
+    int index = 0;
+
+    while (1) {
+        int child = index * 2 + 1;
+        if (child >= des->heap_size) break;
+        if (child + 1 < des->heap_size && event_before(&des->heap[child + 1], &des->heap[child])) child++;
+        if (!event_before(&des->heap[child], &last)) break;
+        des->heap[index] = des->heap[child];
+        index = child;
+    }
+    des->heap[index] = last;
+    return top;
+}
+
+static void port_close(Des* des, const char* reason);
+
+/**
+ * Closes the port once no passenger can make progress any more. Passengers whose
+ * bag exceeds every ferry limit would otherwise keep the port open forever.
+ */
+static void port_check_done(Des* des) {
+    if (des->port_open && des->finished + des->stranded == des->passenger_count) {
+        port_close(des, des->stranded ? "No ferry accepts the remaining baggage. Marking port as closed."
+                                      : "All passengers exited. Marking port as closed.");
+    }
+}
+
+static void passenger_finish(Des* des) {
+    des->finished++;
+    port_check_done(des);
+}
+
+static void passenger_exit_closed(Des* des, int passenger) {
+    des_log(des, ROLE_PASSENGER, passenger, "Port is closing, exiting the port.");
+    passenger_finish(des);
+}
+
+/**
+ * Station assignment of the security manager (see security_try_insert):
+ * an empty station takes any gender, a used station only the same gender.
+ *
+ * @return 1 if the passenger was assigned a station, 0 otherwise
+ */
+static int security_try_insert_at(Des* des, int passenger) {
+    const DesConfig* config = des->config;
+    DesPassenger* p = &des->passengers[passenger];
+
+    for (int station = 0; station < SECURITY_STATIONS; station++) {
+        DesStation* s = &des->stations[station];
+        if (s->usage == 0 || (s->usage < SECURITY_STATION_CAPACITY && s->gender == p->ticket.gender)) {
+            int duration = (des_rand(des) % (config->security_time_max - config->security_time_min + 1)) +
+                           config->security_time_min;
+            s->gender = p->ticket.gender;
+            s->usage++;
+            des_schedule(des, (SimTime)duration * 1000, DES_EVENT_SECURITY_DONE, passenger, station);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * One pass of the security manager loop: the internal queue goes first,
+ * pending requests may overtake it at most SECURITY_MAX_FRUSTRATION times.
+ */
+static void security_dispatch(Des* des) {
+    if (des->security_internal != -1 && security_try_insert_at(des, des->security_internal)) {
+        des->security_internal = -1;
+    }
+
+    while (des->security_requests.head != -1) {
+        int pending = des->security_requests.head;
+        int internal = des->security_internal;
+
+        if (internal != -1 && des->passengers[internal].frustration >= SECURITY_MAX_FRUSTRATION) break;
+
+        if (security_try_insert_at(des, pending)) {
+            list_pop(&des->security_requests, des->passenger_next);
+            des_log(des, ROLE_SECURITY_MANAGER, -1, "Passenger %d assigned to security station (gender: %s)",
+                    pending, GENDER_NAME(des->passengers[pending].ticket.gender));
+            if (internal != -1) {
+                des->passengers[internal].frustration++;
+                des_log(des, ROLE_SECURITY_MANAGER, -1, "FRUSTRATION_INCREMENT - passenger %d overtaken (frustration: %d)",
+                        internal, des->passengers[internal].frustration);
+            }
+        } else if (internal == -1) {
+            list_pop(&des->security_requests, des->passenger_next);
+            des_log(des, ROLE_SECURITY_MANAGER, -1, "No slot found, adding to internal queue");
+            des->security_internal = pending;
+        } else {
+            break;
+        }
+    }
+}
+
+static void security_request(Des* des, int passenger) {
+    DesPassenger* p = &des->passengers[passenger];
+
+    des->security_permits--;
+    if (!des->tracing) p->dangerous = (des_rand(des) % 100) < des->config->dangerous_item_chance;
+    des_log(des, ROLE_PASSENGER, passenger, "Requested security station allocation (gender: %s)",
+            GENDER_NAME(p->ticket.gender));
+    list_push(&des->security_requests, des->passenger_next, passenger);
+    security_dispatch(des);
+}
+
+static void passenger_to_security(Des* des, int passenger) {
+    des->passengers[passenger].ticket.state = PASSENGER_WAITING;
+    des_log(des, ROLE_PASSENGER, passenger, "Passed baggage check");
+    des_log(des, ROLE_PASSENGER, passenger, "Waiting for security");
+    if (!des->port_open) {
+        passenger_exit_closed(des, passenger);
+    } else if (des->security_permits > 0) {
+        security_request(des, passenger);
+    } else {
+        list_push(&des->security_wait, des->passenger_next, passenger);
+    }
+}
+
+static void baggage_accept(Des* des, int passenger, int dock, int limit) {
+    DesPassenger* p = &des->passengers[passenger];
+
+    p->dock = dock;
+    if (des->config->dock_count > 1) {
+        des_log(des, ROLE_PASSENGER, passenger, "Baggage meets the limit (bag: %d, ferry_limit: %d, dock: %d)",
+                p->ticket.bag_weight, limit, dock);
+    } else {
+        des_log(des, ROLE_PASSENGER, passenger, "Baggage meets the limit (bag: %d, ferry_limit: %d)",
+                p->ticket.bag_weight, limit);
+    }
+    passenger_to_security(des, passenger);
+}
+
+static void baggage_check(Des* des, int passenger) {
+    DesPassenger* p = &des->passengers[passenger];
+    int docked_limit = -1;
+
+    // Like the passenger process, scan the docks from a different one per passenger
+    for (int i = 0; i < des->config->dock_count; i++) {
+        int dock = (passenger + i) % des->config->dock_count;
+        int ferry_id = des->docked_ferry[dock];
+        int limit;
+
+        if (ferry_id == -1) continue;
+        limit = des->ferries[ferry_id].state.baggage_limit;
+        if (limit >= p->ticket.bag_weight) {
+            baggage_accept(des, passenger, dock, limit);
+            return;
+        }
+        if (limit > docked_limit) docked_limit = limit;
+    }
+    if (docked_limit != -1) {
+        des_log(des, ROLE_PASSENGER, passenger, "BAGGAGE_REJECTED - bag: %d exceeds ferry_limit: %d",
+                p->ticket.bag_weight, docked_limit);
+    }
+    p->wait_start = des->now;
+    list_push(&des->baggage_waiting[p->ticket.bag_weight - des->config->passenger_bag_min],
+              des->passenger_next, passenger);
+}
+
+/**
+ * Lets passengers from the ramp lines of a dock onto the ramp of the ferry
+ * docked there, VIP line first, while slots and ferry capacity allow.
+ */
+static void ramp_admit(Des* des, int dock) {
+    const DesConfig* config = des->config;
+    DesFerry* ferry;
+    int ferry_id = des->docked_ferry[dock];
+
+    if (ferry_id == -1) return;
+    ferry = &des->ferries[ferry_id];
+    if (!ferry->gate_open || ferry->gate_close) return;
+
+    for (int vip = 1; vip >= 0; vip--) {
+        DesList* line = vip ? &des->ramp_vip[dock] : &des->ramp_regular[dock];
+        int slots = vip ? config->ramp_capacity_vip : config->ramp_capacity_regular;
+
+        while (line->head != -1 &&
+               (vip ? ferry->on_ramp_vip : ferry->on_ramp - ferry->on_ramp_vip) < slots &&
+               config->ferry_capacity - ferry->state.passenger_count - ferry->on_ramp > 0) {
+            int passenger = list_pop(line, des->passenger_next);
+            des_log(des, ROLE_PASSENGER, passenger, "Requesting ramp access (VIP: %d)", vip);
+            des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Granting ramp to passenger %d (VIP: %d)", passenger, vip);
+            des_log(des, ROLE_PASSENGER, passenger, "Boarding ferry");
+            des->passengers[passenger].ticket.state = PASSENGER_BOARDING;
+            ferry->on_ramp++;
+            if (vip) ferry->on_ramp_vip++;
+            des_schedule(des, config->passenger_boarding_time, DES_EVENT_BOARDING_DONE, passenger, ferry_id);
+        }
+    }
+}
+
+static void ferry_exit(Des* des, int ferry_id) {
+    des->ferries[ferry_id].running = 0;
+    des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry exiting");
+}
+
+/**
+ * Charges the baggage rejections a waiting passenger would have collected by
+ * polling the docked ferries, none of which took its bag, since it started
+ * waiting or since the docks were last all empty.
+ */
+static void baggage_charge_rejections(Des* des, int passenger) {
+    SimTime since = des->passengers[passenger].wait_start > des->docks_busy_since ?
+                    des->passengers[passenger].wait_start : des->docks_busy_since;
+
+    if (des->now <= since) return;
+    des->stats->passengers_rejected_baggage +=
+        (int)((des->now - since + DES_BAGGAGE_POLL_INTERVAL - 1) / DES_BAGGAGE_POLL_INTERVAL);
+}
+
+/**
+ * Charges the rejections of everybody still waiting at baggage check when
+ * the last docked ferry leaves.
+ */
+static void baggage_count_rejections(Des* des) {
+    int buckets = des->config->passenger_bag_max - des->config->passenger_bag_min + 1;
+
+    for (int bucket = 0; bucket < buckets; bucket++) {
+        for (int passenger = des->baggage_waiting[bucket].head; passenger != -1; passenger = des->passenger_next[passenger]) {
+            baggage_charge_rejections(des, passenger);
+        }
+    }
+}
+
+/**
+ * Docks the next ferries in line while a dock is free.
+ * Once the port is closed, every ferry reaching a dock exits instead.
+ */
+static void dock_next(Des* des) {
+    const DesConfig* config = des->config;
+
+    while (des->docked_count < config->dock_count && des->dock_queue.head != -1) {
+        int ferry_id = list_pop(&des->dock_queue, des->ferry_next);
+        DesFerry* ferry = &des->ferries[ferry_id];
+        int limit = ferry->state.baggage_limit;
+        int gate_delay;
+        int dock;
+
+        if (!des->port_open) {
+            des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry manager - port is closed");
+            ferry_exit(des, ferry_id);
+            continue;
+        }
+
+        for (dock = 0; des->docked_ferry[dock] != -1; dock++) {}
+        if (des->docked_count++ == 0) des->docks_busy_since = des->now;
+        des->docked_ferry[dock] = ferry_id;
+        ferry->dock = dock;
+        ferry->state.status = FERRY_BOARDING;
+        ferry->state.passenger_count = 0;
+        ferry->state.baggage_weight_total = 0;
+        ferry->gate_open = 0;
+        ferry->gate_close = 0;
+        ferry->dock_time = des->now;
+        if (config->dock_count > 1) des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry docked at dock %d", dock);
+        des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry is preparing for boarding (baggage_limit: %d, capacity: %d)",
+                limit, config->ferry_capacity);
+
+        // The ferry wakes the passengers of every weight bucket up to the one holding its limit
+        for (int weight = config->passenger_bag_min; weight <= config->passenger_bag_max; weight++) {
+            DesList* waiting = &des->baggage_waiting[weight - config->passenger_bag_min];
+            if (weight > limit) {
+                if (baggage_bucket(&des->baggage, weight) > baggage_bucket(&des->baggage, limit)) continue;
+                for (int passenger = waiting->head; passenger != -1; passenger = des->passenger_next[passenger]) {
+                    des_log(des, ROLE_PASSENGER, passenger, "BAGGAGE_REJECTED - bag: %d exceeds ferry_limit: %d",
+                            weight, limit);
+                }
+                continue;
+            }
+            while (waiting->head != -1) {
+                int passenger = list_pop(waiting, des->passenger_next);
+                baggage_charge_rejections(des, passenger);
+                baggage_accept(des, passenger, dock, limit);
+            }
+        }
+
+        gate_delay = config->ferry_gate_delay_max > 0 ? des_rand(des) % config->ferry_gate_delay_max : 0;
+        des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry gate will open in %d ms", gate_delay);
+        des_schedule(des, gate_delay, DES_EVENT_GATE_OPEN, ferry_id, 0);
+    }
+}
+
+static void ferry_depart(Des* des, int ferry_id) {
+    DesFerry* ferry = &des->ferries[ferry_id];
+
+    des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Gate closing");
+    des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry departing (final_passenger_count: %d, baggage_total: %d)",
+            ferry->state.passenger_count, ferry->state.baggage_weight_total);
+    des->docked_ferry[ferry->dock] = -1;
+    if (--des->docked_count == 0) baggage_count_rejections(des);
+    ferry->state.status = FERRY_DEPARTED;
+    ferry->gate_open = 0;
+
+    if (!ferry->state.passenger_count && !des->port_open) {
+        des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry departure - empty");
+        ferry_exit(des, ferry_id);
+    } else {
+        des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry traveling");
+        ferry->state.status = FERRY_TRAVELING;
+        des_schedule(des, 2 * des->config->ferry_travel_time * DES_USEC_PER_SEC, DES_EVENT_FERRY_RETURN, ferry_id, 0);
+    }
+    dock_next(des);
+}
+
+/**
+ * Closes the port. Passengers still waiting at baggage check, for a security
+ * permit or for a ramp slot leave immediately, like their processes do on SIGUSR2;
+ * passengers already at security or on the ramp finish first.
+ */
+static void port_close(Des* des, const char* reason) {
+    int buckets = des->config->passenger_bag_max - des->config->passenger_bag_min + 1;
+    int passenger;
+
+    if (!des->port_open) return;
+    des->port_open = 0;
+    des_log(des, ROLE_PORT_MANAGER, -1, "%s", reason);
+
+    // Stranded passengers are the only ones still at baggage check on a normal close
+    des->stranded = 0;
+    for (int bucket = 0; bucket < buckets; bucket++) {
+        while ((passenger = list_pop(&des->baggage_waiting[bucket], des->passenger_next)) != -1) {
+            passenger_exit_closed(des, passenger);
+        }
+    }
+    while ((passenger = list_pop(&des->security_wait, des->passenger_next)) != -1) {
+        passenger_exit_closed(des, passenger);
+    }
+    for (int dock = 0; dock < des->config->dock_count; dock++) {
+        while ((passenger = list_pop(&des->ramp_vip[dock], des->passenger_next)) != -1) {
+            passenger_exit_closed(des, passenger);
+        }
+        while ((passenger = list_pop(&des->ramp_regular[dock], des->passenger_next)) != -1) {
+            passenger_exit_closed(des, passenger);
+        }
+    }
+    dock_next(des);
+}
+
+/**
+ * Reads the next recorded passenger from the trace into the passenger table.
+ * Bag weights outside PASSENGER_BAG_WEIGHT_MIN..MAX are clamped to that range.
+ *
+ * @param des Simulation
+ * @param passenger Passenger the record belongs to
+ * @return 1 if a record was read, 0 at the end of the trace, -1 if it is malformed
+ */
+static int trace_load_passenger(Des* des, int passenger) {
+    const DesConfig* config = des->config;
+    DesPassenger* p = &des->passengers[passenger];
+    TraceEntry entry;
+    int status = trace_next(&des->trace, &entry);
+
+    if (status != 1) {
+        if (status == -1) fprintf(stderr, "DES engine: Malformed trace record %ld, replay stopped\n", des->trace.line);
+        return status;
+    }
+    p->ticket.gender = entry.gender;
+    p->ticket.vip = entry.vip;
+    p->ticket.bag_weight = entry.bag_weight;
+    if (p->ticket.bag_weight < config->passenger_bag_min) p->ticket.bag_weight = config->passenger_bag_min;
+    if (p->ticket.bag_weight > config->passenger_bag_max) p->ticket.bag_weight = config->passenger_bag_max;
+    p->dangerous = entry.dangerous;
+    des->trace_next_arrival = entry.arrival * 1000;
+    return 1;
+}
+
+static void handle_passenger_arrival(Des* des, int passenger) {
+    const DesConfig* config = des->config;
+    DesPassenger* p = &des->passengers[passenger];
+
+    if (!des->port_open) {
+        passenger_exit_closed(des, passenger);
+        return;
+    }
+
+    // Like the passenger generator, release the next passenger after the arrival gap,
+    // or at its recorded time when replaying a trace
+    des->stats->passengers_spawned++;
+    if (des->tracing) {
+        SimTime arrival = des->trace_next_arrival;
+        if (passenger + 1 < des->passenger_count && trace_load_passenger(des, passenger + 1) == 1) {
+            des_schedule(des, des->trace_next_arrival - arrival, DES_EVENT_PASSENGER_ARRIVAL, passenger + 1, 0);
+        } else {
+            // The trace ended early: nobody else is coming
+            des->passenger_count = passenger + 1;
+        }
+    } else if (passenger + 1 < des->passenger_count) {
+        SimTime gap = arrivals_next_gap(&config->arrivals, config->arrivals.interval > 0 ? des_uniform(des) : 0);
+        des_schedule(des, gap, DES_EVENT_PASSENGER_ARRIVAL, passenger + 1, 0);
+    }
+
+    p->arrival = des->now;
+    p->ticket.state = PASSENGER_CHECKIN;
+    if (!des->tracing) {
+        p->ticket.gender = (des_rand(des) % 2) + 1;
+        p->ticket.vip = (des_rand(des) % 100) < config->vip_chance;
+        p->ticket.bag_weight = config->passenger_bag_min +
+                               (des_rand(des) % (config->passenger_bag_max - config->passenger_bag_min + 1));
+    }
+    p->ticket.state = PASSENGER_BAG_CHECK;
+    des_log(des, ROLE_PASSENGER, passenger, "At baggage check");
+    baggage_check(des, passenger);
+
+    if (p->ticket.bag_weight > des->max_baggage_limit) {
+        des->stranded++;
+        port_check_done(des);
+    }
+}
+
+static void handle_security_done(Des* des, int passenger, int station) {
+    DesPassenger* p = &des->passengers[passenger];
+    int next;
+
+    des->stations[station].usage--;
+    if (p->dangerous) {
+        des_log(des, ROLE_SECURITY_MANAGER, -1, "Passenger %d did not pass the security (station: %d, gender: %s)",
+                passenger, station, GENDER_NAME(p->ticket.gender));
+        des->stats->passengers_screened_rejected++;
+    } else {
+        des_log(des, ROLE_SECURITY_MANAGER, -1, "Passenger %d passed the security (station: %d, gender: %s)",
+                passenger, station, GENDER_NAME(p->ticket.gender));
+        des->stats->passengers_screened_passed++;
+    }
+
+    // The passenger hands its permit to the next one in line
+    des->security_permits++;
+    if ((next = list_pop(&des->security_wait, des->passenger_next)) != -1) {
+        security_request(des, next);
+    } else {
+        security_dispatch(des);
+    }
+
+    if (!des->port_open) {
+        passenger_exit_closed(des, passenger);
+        return;
+    }
+    if (p->dangerous) {
+        des_log(des, ROLE_PASSENGER, passenger, "Passenger did not pass security.");
+        passenger_finish(des);
+        return;
+    }
+    des_log(des, ROLE_PASSENGER, passenger, "Passed security, waiting to board (gender: %s)",
+            GENDER_NAME(p->ticket.gender));
+    des_log(des, ROLE_PASSENGER, passenger, "Waiting for ramp slot availability");
+    list_push(p->ticket.vip ? &des->ramp_vip[p->dock] : &des->ramp_regular[p->dock], des->passenger_next, passenger);
+    ramp_admit(des, p->dock);
+}
+
+static void handle_gate_open(Des* des, int ferry_id) {
+    des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry is open for boarding");
+    des->ferries[ferry_id].gate_open = 1;
+    des_schedule(des, des->config->ferry_departure_interval * DES_USEC_PER_SEC,
+                 DES_EVENT_DEPARTURE_DEADLINE, ferry_id, 0);
+    ramp_admit(des, des->ferries[ferry_id].dock);
+}
+
+static void handle_departure_deadline(Des* des, int ferry_id) {
+    DesFerry* ferry = &des->ferries[ferry_id];
+
+    ferry->gate_close = 1;
+    if (!ferry->on_ramp) ferry_depart(des, ferry_id);
+}
+
+static void handle_boarding_done(Des* des, int passenger, int ferry_id) {
+    DesFerry* ferry = &des->ferries[ferry_id];
+    DesPassenger* p = &des->passengers[passenger];
+
+    ferry->on_ramp--;
+    if (p->ticket.vip) ferry->on_ramp_vip--;
+    ferry->state.passenger_count++;
+    ferry->state.baggage_weight_total += p->ticket.bag_weight;
+    des->stats->passengers_boarded++;
+    des->board_times[des->board_count++] = des->now - p->arrival;
+    des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Passenger %d left ramp (current_capacity: %d/%d)",
+            passenger, ferry->state.passenger_count, des->config->ferry_capacity);
+    p->ticket.state = PASSENGER_BOARDED;
+    des_log(des, ROLE_PASSENGER, passenger, "Boarded successfully");
+    passenger_finish(des);
+
+    if (ferry->gate_close && !ferry->on_ramp) {
+        ferry_depart(des, ferry_id);
+    } else {
+        ramp_admit(des, ferry->dock);
+    }
+}
+
+static void handle_ferry_return(Des* des, int ferry_id) {
+    DesFerry* ferry = &des->ferries[ferry_id];
+
+    if (ferry->state.passenger_count > 0) des->stats->total_ferry_trips++;
+    ferry->state.status = FERRY_WAITING_IN_QUEUE;
+    ferry->state.passenger_count = 0;
+    ferry->state.baggage_weight_total = 0;
+    des_log(des, ROLE_FERRY_MANAGER, ferry_id, "Ferry returned to queue");
+
+    if (!des->port_open) {
+        ferry_exit(des, ferry_id);
+        return;
+    }
+    list_push(&des->dock_queue, des->ferry_next, ferry_id);
+    dock_next(des);
+}
+
+/**
+ * Allocates the passenger, ferry and event tables for the sizes already set
+ * in des (passenger_count, heap_capacity).
+ *
+ * @return 0 on success, -1 on error
+ */
+static int des_allocate(Des* des) {
+    const DesConfig* config = des->config;
+    int buckets = config->passenger_bag_max - config->passenger_bag_min + 1;
+
+    des->heap = malloc(sizeof(DesEvent) * des->heap_capacity);
+    des->passengers = calloc(des->passenger_count + 1, sizeof(DesPassenger));
+    des->passenger_next = malloc(sizeof(int) * (des->passenger_count + 1));
+    des->board_times = malloc(sizeof(SimTime) * (des->passenger_count + 1));
+    des->ferries = calloc(config->ferry_count, sizeof(DesFerry));
+    des->ferry_next = malloc(sizeof(int) * config->ferry_count);
+    des->baggage_waiting = malloc(sizeof(DesList) * buckets);
+    baggage_waiters_init(&des->baggage, config->passenger_bag_min, config->passenger_bag_max);
+    if (!des->heap || !des->passengers || !des->passenger_next || !des->board_times || !des->ferries ||
+        !des->ferry_next || !des->baggage_waiting) {
+        perror("DES engine: Failed to allocate state");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Writes the whole simulation state: pending events, passengers and their
+ * progress, ferries, security stations and queues, ramp lines, docks,
+ * statistics and the random stream.
+ *
+ * @param des Simulation to save
+ * @param path Checkpoint file
+ * @return 0 on success, -1 on error
+ */
+static int des_checkpoint_save(const Des* des, const char* path) {
+    const DesConfig* config = des->config;
+    size_t buckets = config->passenger_bag_max - config->passenger_bag_min + 1;
+    size_t passengers = des->passenger_count + 1;
+    DesCheckpointHeader header;
+    FILE* file;
+    int written;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DES_CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = DES_CHECKPOINT_VERSION;
+    header.des_size = sizeof(Des);
+    memcpy(header.model, config, DES_CONFIG_MODEL_SIZE);
+    header.tracing = des->tracing;
+    header.seed = config->seed;
+    header.stats = *des->stats;
+
+    if (!(file = fopen(path, "wb"))) return -1;
+    written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(des, sizeof(Des), 1, file) == 1 &&
+              fwrite(des->heap, sizeof(DesEvent), des->heap_size, file) == (size_t)des->heap_size &&
+              fwrite(des->passengers, sizeof(DesPassenger), passengers, file) == passengers &&
+              fwrite(des->passenger_next, sizeof(int), passengers, file) == passengers &&
+              fwrite(des->board_times, sizeof(SimTime), des->board_count, file) == (size_t)des->board_count &&
+              fwrite(des->ferries, sizeof(DesFerry), config->ferry_count, file) == (size_t)config->ferry_count &&
+              fwrite(des->ferry_next, sizeof(int), config->ferry_count, file) == (size_t)config->ferry_count &&
+              fwrite(des->baggage_waiting, sizeof(DesList), buckets, file) == buckets;
+    if (fclose(file) != 0) written = 0;
+    return written ? 0 : -1;
+}
+
+/**
+ * Restores a simulation saved by des_checkpoint_save. The configuration must
+ * describe the same model. With the seed of the checkpointed run the random
+ * stream continues where it stopped, so the run ends exactly like the original
+ * one; any other seed draws a new future from the same state.
+ *
+ * @param des Simulation to fill; config, log_file and stats must be set
+ * @param path Checkpoint file
+ * @return 0 on success, -1 on error
+ */
+static int des_checkpoint_load(Des* des, const char* path) {
+    const DesConfig* config = des->config;
+    FILE* log_file = des->log_file;
+    SimulationStats* stats = des->stats;
+    size_t buckets = config->passenger_bag_max - config->passenger_bag_min + 1;
+    size_t passengers;
+    DesCheckpointHeader header;
+    Des saved;
+    FILE* file;
+    int read;
+
+    if (!(file = fopen(path, "rb"))) {
+        fprintf(stderr, "DES engine: Cannot open checkpoint %s\n", path);
+        return -1;
+    }
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, DES_CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DES_CHECKPOINT_VERSION || header.des_size != sizeof(Des) || fread(&saved, sizeof(Des), 1, file) != 1) {
+        fprintf(stderr, "DES engine: %s is not a checkpoint of this build\n", path);
+        fclose(file);
+        return -1;
+    }
+
+    // The saved pointers belong to the process that wrote the checkpoint
+    *des = saved;
+    des->config = config;
+    des->log_file = log_file;
+    des->stats = stats;
+    des->heap = NULL;
+    des->passengers = NULL;
+    des->passenger_next = NULL;
+    des->board_times = NULL;
+    des->ferries = NULL;
+    des->ferry_next = NULL;
+    des->baggage_waiting = NULL;
+    memset(&des->trace, 0, sizeof(des->trace));
+
+    if (memcmp(header.model, config, DES_CONFIG_MODEL_SIZE) != 0 || header.tracing != (config->trace != NULL)) {
+        fprintf(stderr, "DES engine: Checkpoint %s was taken with a different configuration\n", path);
+        des->tracing = 0;
+        fclose(file);
+        return -1;
+    }
+    if (des_allocate(des) != 0) {
+        des->tracing = 0;
+        fclose(file);
+        return -1;
+    }
+
+    passengers = des->passenger_count + 1;
+    read = fread(des->heap, sizeof(DesEvent), des->heap_size, file) == (size_t)des->heap_size &&
+           fread(des->passengers, sizeof(DesPassenger), passengers, file) == passengers &&
+           fread(des->passenger_next, sizeof(int), passengers, file) == passengers &&
+           fread(des->board_times, sizeof(SimTime), des->board_count, file) == (size_t)des->board_count &&
+           fread(des->ferries, sizeof(DesFerry), config->ferry_count, file) == (size_t)config->ferry_count &&
+           fread(des->ferry_next, sizeof(int), config->ferry_count, file) == (size_t)config->ferry_count &&
+           fread(des->baggage_waiting, sizeof(DesList), buckets, file) == buckets;
+    fclose(file);
+    if (!read) {
+        fprintf(stderr, "DES engine: Checkpoint %s is truncated\n", path);
+        des->tracing = 0;
+        return -1;
+    }
+
+    // The trace is mapped again and read on from the saved position
+    if (des->tracing) {
+        if (trace_open(config->trace, &des->trace) != 0 || des->trace.size != saved.trace.size) {
+            fprintf(stderr, "DES engine: Trace %s does not match the checkpoint\n", config->trace);
+            trace_close(&des->trace);
+            des->tracing = 0;
+            return -1;
+        }
+        des->trace.offset = saved.trace.offset;
+        des->trace.line = saved.trace.line;
+        des->trace.read = saved.trace.read;
+        des->trace.first_arrival = saved.trace.first_arrival;
+        des->trace.last_arrival = saved.trace.last_arrival;
+    }
+
+    *stats = header.stats;
+    if (config->seed != header.seed) des->rng = config->seed;
+    des->events = 0;
+    des->checkpointed = 0;
+    return 0;
+}
+
+/**
+ * Opens an empty port: every ferry queues for a dock and the first
+ * passenger is scheduled to arrive.
+ *
+ * @return 0 on success, -1 on error
+ */
+static int des_start(Des* des) {
+    const DesConfig* config = des->config;
+    int buckets = config->passenger_bag_max - config->passenger_bag_min + 1;
+
+    des->passenger_count = config->passenger_count;
+    if (config->trace) {
+        if (trace_open(config->trace, &des->trace) != 0) {
+            fprintf(stderr, "DES engine: Failed to open trace %s\n", config->trace);
+            return -1;
+        }
+        des->tracing = 1;
+        if (trace_count(&des->trace) < des->passenger_count) des->passenger_count = (int)trace_count(&des->trace);
+    }
+
+    des->heap_capacity = des->passenger_count + config->ferry_count + 1;
+    if (des_allocate(des) != 0) return -1;
+    for (int bucket = 0; bucket < buckets; bucket++) list_init(&des->baggage_waiting[bucket]);
+
+    des_log(des, ROLE_PORT_MANAGER, -1, "Port manager starting up");
+
+    // Ferries queue for the dock in id order, as their processes start before the passengers
+    des->max_baggage_limit = 0;
+    for (int i = 0; i < config->ferry_count; i++) {
+        des->ferries[i].state.ferry_id = i;
+        des->ferries[i].state.baggage_limit = config->ferry_baggage_limit_min +
+            i * ((config->ferry_baggage_limit_max - config->ferry_baggage_limit_min) / config->ferry_count);
+        des->ferries[i].state.status = FERRY_WAITING_IN_QUEUE;
+        des->ferries[i].running = 1;
+        if (des->ferries[i].state.baggage_limit > des->max_baggage_limit) {
+            des->max_baggage_limit = des->ferries[i].state.baggage_limit;
+        }
+        des_log(des, ROLE_FERRY_MANAGER, i, "Ferry manager started");
+        list_push(&des->dock_queue, des->ferry_next, i);
+    }
+    dock_next(des);
+
+    if (des->tracing && des->passenger_count > 0 && trace_load_passenger(des, 0) != 1) {
+        des->passenger_count = 0;
+    }
+    if (des->passenger_count > 0) {
+        des_schedule(des, 0, DES_EVENT_PASSENGER_ARRIVAL, 0, 0);
+    }
+    des_log(des, ROLE_PORT_MANAGER, -1, "Spawned all ferries and the passenger generator");
+
+    if (config->port_close_after > 0) {
+        des_schedule(des, config->port_close_after * DES_USEC_PER_SEC, DES_EVENT_PORT_CLOSE, -1, 0);
+    }
+    if (des->passenger_count == 0) {
+        port_close(des, "All passengers exited. Marking port as closed.");
+    }
+    return 0;
+}
+
+/**
+ * Reads the simulation parameters from the environment.
+ * SEED, PORT_CLOSE_AFTER, TRACE, CHECKPOINT, CHECKPOINT_AT and WARM_START are optional.
+ *
+ * @param config Configuration to fill
+ */
+void des_config_load(DesConfig* config) {
+    const char* seed = getenv("SEED");
+
+    config->passenger_count = CONFIG_GET_INT("PASSENGER_COUNT");
+    config->ferry_count = CONFIG_GET_INT("FERRY_COUNT");
+    config->ferry_capacity = CONFIG_GET_INT("FERRY_CAPACITY");
+    config->ramp_capacity_regular = CONFIG_GET_INT("RAMP_CAPACITY_REG");
+    config->ramp_capacity_vip = CONFIG_GET_INT("RAMP_CAPACITY_VIP");
+    config->ferry_departure_interval = CONFIG_GET_INT("FERRY_DEPARTURE_INTERVAL");
+    config->ferry_travel_time = CONFIG_GET_INT("FERRY_TRAVEL_TIME");
+    config->security_time_min = CONFIG_GET_INT("PASSENGER_SECURITY_TIME_MIN");
+    config->security_time_max = CONFIG_GET_INT("PASSENGER_SECURITY_TIME_MAX");
+    config->passenger_boarding_time = CONFIG_GET_INT("PASSENGER_BOARDING_TIME");
+    config->ferry_gate_delay_max = CONFIG_GET_INT("FERRY_GATE_MAX_DELAY");
+    config->ferry_baggage_limit_min = CONFIG_GET_INT("FERRY_BAGGAGE_LIMIT_MIN");
+    config->ferry_baggage_limit_max = CONFIG_GET_INT("FERRY_BAGGAGE_LIMIT_MAX");
+    config->passenger_bag_min = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MIN");
+    config->passenger_bag_max = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MAX");
+    config->dangerous_item_chance = CONFIG_GET_INT("DANGEROUS_ITEM_CHANCE");
+    config->vip_chance = CONFIG_GET_INT("VIP_CHANCE");
+    config->dock_count = CONFIG_GET_INT_OR("DOCK_COUNT", DOCK_COUNT_DEFAULT);
+    config->port_close_after = CONFIG_GET_INT_OR("PORT_CLOSE_AFTER", 0);
+    arrivals_load(&config->arrivals);
+    config->trace = getenv("TRACE");
+    config->seed = seed ? strtoull(seed, NULL, 10) : (unsigned long long)(time(NULL) ^ getpid());
+    config->checkpoint = getenv("CHECKPOINT");
+    config->checkpoint_at = CONFIG_GET_INT_OR("CHECKPOINT_AT", 0);
+    config->warm_start = getenv("WARM_START");
+}
+
+/**
+ * Runs one simulation in virtual time.
+ *
+ * Models the pipeline of the process engine (baggage check, gender-segregated
+ * security stations with frustration, VIP-first ramp lanes at DOCK_COUNT docks, ferry departure interval
+ * and travel) as timestamped events on a priority queue. Time jumps from one
+ * event to the next, so nothing ever sleeps. With a trace configured, passengers
+ * arrive at their recorded times with their recorded attributes.
+ *
+ * @param config Simulation parameters
+ * @param log_file Event log in the simulation.log format, or NULL for no log
+ * @param stats Filled with the final statistics
+ * @param report Filled with engine counters, may be NULL
+ * @return 0 on success, 1 on error
+ */
+int des_run(const DesConfig* config, FILE* log_file, SimulationStats* stats, DesReport* report) {
+    Des des;
+    SimTime start_time;
+    int board_start;
+    int status = 0;
+
+    if (config->passenger_bag_max < config->passenger_bag_min ||
+        config->security_time_max < config->security_time_min || config->ferry_count < 1 ||
+        config->dock_count < 1 || config->dock_count > DOCK_MAX) {
+        fprintf(stderr, "DES engine: Invalid configuration\n");
+        return 1;
+    }
+
+    memset(&des, 0, sizeof(des));
+    memset(stats, 0, sizeof(*stats));
+    des.config = config;
+    des.log_file = log_file;
+    des.stats = stats;
+    des.rng = config->seed;
+    for (int dock = 0; dock < DOCK_MAX; dock++) {
+        des.docked_ferry[dock] = -1;
+        list_init(&des.ramp_vip[dock]);
+        list_init(&des.ramp_regular[dock]);
+    }
+    des.port_open = 1;
+    des.security_internal = -1;
+    des.security_permits = SECURITY_STATIONS * SECURITY_STATION_CAPACITY;
+    list_init(&des.security_wait);
+    list_init(&des.security_requests);
+    list_init(&des.dock_queue);
+
+    if (config->warm_start) {
+        if (des_checkpoint_load(&des, config->warm_start) != 0) {
+            status = 1;
+            goto cleanup;
+        }
+        des_log(&des, ROLE_PORT_MANAGER, -1, "Warm start from checkpoint %s", config->warm_start);
+    } else if (des_start(&des) != 0) {
+        status = 1;
+        goto cleanup;
+    }
+    start_time = des.now;
+    board_start = des.board_count;
+
+    while (des.heap_size > 0) {
+        DesEvent event;
+
+        if (config->checkpoint && !des.checkpointed && des.heap[0].time >= config->checkpoint_at * DES_USEC_PER_SEC) {
+            if (des_checkpoint_save(&des, config->checkpoint) != 0) {
+                perror("DES engine: Failed to write checkpoint");
+                status = 1;
+                goto cleanup;
+            }
+            des.checkpointed = 1;
+            des_log(&des, ROLE_PORT_MANAGER, -1, "Checkpoint saved to %s", config->checkpoint);
+        }
+        event = des_next_event(&des);
+        // Nobody arrives at a closed port, and the day does not get longer waiting for them
+        if ((event.type == DES_EVENT_PORT_CLOSE || event.type == DES_EVENT_PASSENGER_ARRIVAL) && !des.port_open) continue;
+        des.now = event.time;
+        des.events++;
+
+        switch (event.type) {
+            case DES_EVENT_PASSENGER_ARRIVAL:
+                handle_passenger_arrival(&des, event.subject);
+                break;
+            case DES_EVENT_SECURITY_DONE:
+                handle_security_done(&des, event.subject, event.detail);
+                break;
+            case DES_EVENT_GATE_OPEN:
+                handle_gate_open(&des, event.subject);
+                break;
+            case DES_EVENT_DEPARTURE_DEADLINE:
+                handle_departure_deadline(&des, event.subject);
+                break;
+            case DES_EVENT_BOARDING_DONE:
+                handle_boarding_done(&des, event.subject, event.detail);
+                break;
+            case DES_EVENT_FERRY_RETURN:
+                handle_ferry_return(&des, event.subject);
+                break;
+            case DES_EVENT_PORT_CLOSE:
+                port_close(&des, "Simulated port day is over. Marking port as closed.");
+                break;
+        }
+    }
+
+    des_log(&des, ROLE_PORT_MANAGER, -1, "Port manager exiting");
+
+    if (config->checkpoint && !des.checkpointed) {
+        fprintf(stderr, "DES engine: The port closed before CHECKPOINT_AT, no checkpoint written\n");
+        status = 1;
+    }
+
+    // Time to board covers the passengers boarded by this run, so a warm start measures the steady state only
+    if (report) {
+        SimTime* board_times = des.board_times + board_start;
+        int board_count = des.board_count - board_start;
+        double total = 0;
+
+        report->start_time = start_time;
+        report->simulated_time = des.now;
+        report->events = des.events;
+        report->board_time_mean = 0;
+        report->board_time_p95 = 0;
+        if (board_count > 0) {
+            for (int i = 0; i < board_count; i++) total += board_times[i];
+            qsort(board_times, board_count, sizeof(SimTime), compare_sim_time);
+            report->board_time_mean = total / board_count / DES_USEC_PER_SEC;
+            report->board_time_p95 = (double)board_times[(board_count * 95 + 99) / 100 - 1] / DES_USEC_PER_SEC;
+        }
+    }
+
+cleanup:
+    if (des.tracing) trace_close(&des.trace);
+    free(des.heap);
+    free(des.passengers);
+    free(des.passenger_next);
+    free(des.board_times);
+    free(des.ferries);
+    free(des.ferry_next);
+    free(des.baggage_waiting);
+    return status;
+}
+
+/**
+ * Discrete-Event Engine Entry Point.
+ *
+ * Runs the simulation in virtual time, writes the event log and prints
+ * the same statistics block as the logger of the other engines.
+ *
+ * @return 0 on success, 1 on error
+ */
+int des_engine_run(void) {
+    DesConfig config;
+    DesReport report;
+    SimulationStats stats;
+    FILE* log_file;
+    struct timespec start;
+    struct timespec end;
+    int status;
+
+    des_config_load(&config);
+
+    log_file = fopen(LOG_FILE, "w");
+    if (!log_file) {
+        perror("DES engine: Failed to open log file");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    status = des_run(&config, log_file, &stats, &report);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (status == 0) {
+        log_statistics(stdout, &stats);
+        log_statistics(log_file, &stats);
+        if (report.start_time > 0) {
+            printf("Warm start at simulated time %.3f s from %s\n", (double)report.start_time / DES_USEC_PER_SEC, config.warm_start);
+        }
+        if (config.checkpoint) {
+            printf("Checkpoint at simulated time %d s written to %s\n", config.checkpoint_at, config.checkpoint);
+        }
+        printf("Time to board: mean %.3f s, p95 %.3f s\n", report.board_time_mean, report.board_time_p95);
+        printf("Simulated time: %.3f s, events: %llu, wall time: %.3f s, seed: %llu\n",
+               (double)report.simulated_time / DES_USEC_PER_SEC, report.events,
+               (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, config.seed);
+    }
+
+    fclose(log_file);
+    return status;
+}
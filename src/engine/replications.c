@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include "common/config.h"
+#include "common/ipc.h"
+#include "engine/des.h"
+#include "engine/replications.h"
+
+/**
+ * Job table shared with the worker processes. Workers claim the next
+ * job with an atomic increment, so long and short runs balance out.
+ */
+typedef struct ReplicationPool {
+    int next_job;
+    ReplicationResult results[];
+} ReplicationPool;
+
+typedef struct ReplicationMetric {
+    const char* name;
+    double (*sample)(const ReplicationResult* result);
+} ReplicationMetric;
+
+static double metric_boarded(const ReplicationResult* r) { return r->stats.passengers_boarded; }
+static double metric_trips(const ReplicationResult* r) { return r->stats.total_ferry_trips; }
+static double metric_rejected_security(const ReplicationResult* r) { return r->stats.passengers_screened_rejected; }
+static double metric_rejected_baggage(const ReplicationResult* r) { return r->stats.passengers_rejected_baggage; }
+static double metric_board_time_mean(const ReplicationResult* r) { return r->report.board_time_mean; }
+static double metric_board_time_p95(const ReplicationResult* r) { return r->report.board_time_p95; }
+static double metric_simulated_time(const ReplicationResult* r) { return (double)r->report.simulated_time / DES_USEC_PER_SEC; }
+
+static const ReplicationMetric METRICS[] = {
+    { "Passengers boarded",           metric_boarded },
+    { "Total ferry trips",            metric_trips },
+    { "Passengers rejected security", metric_rejected_security },
+    { "Rejected attempts (bag)",      metric_rejected_baggage },
+    { "Time to board, mean (s)",      metric_board_time_mean },
+    { "Time to board, p95 (s)",       metric_board_time_p95 },
+    { "Port day length (s)",          metric_simulated_time }
+};
+
+/**
+ * Two-sided 95% critical value of Student's t distribution.
+ *
+ * @param df Degrees of freedom
+ * @return Critical value, normal approximation above 120
+ */
+static double student_t_975(int df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1) return 0;
+    if (df <= 30) return table[df - 1];
+    if (df <= 40) return 2.021;
+    if (df <= 60) return 2.000;
+    if (df <= 120) return 1.980;
+    return 1.960;
+}
+
+static void replications_worker(ReplicationPool* pool, const DesConfig* configs, int count) {
+    int job;
+
+    while ((job = __atomic_fetch_add(&pool->next_job, 1, __ATOMIC_RELAXED)) < count) {
+        ReplicationResult result;
+        result.status = des_run(&configs[job], NULL, &result.stats, &result.report) == 0 ? 0 : -1;
+        pool->results[job] = result;
+    }
+}
+
+/**
+ * Number of workers when WORKERS is not set: one per online CPU.
+ *
+ * @return Worker count, at least 1
+ */
+int replications_default_workers(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+/**
+ * Runs independent discrete-event simulations in forked worker processes.
+ * Results are collected in a private shared memory segment, so a crashed
+ * worker only loses the job it was running.
+ *
+ * @param configs One configuration per job, including its seed
+ * @param count Number of jobs
+ * @param workers Number of worker processes
+ * @param results Filled with one result per job, in job order
+ * @return 0 if every job completed, 1 otherwise
+ */
+int replications_execute(const DesConfig* configs, int count, int workers, ReplicationResult* results) {
+    ReplicationPool* pool;
+    int shm_id;
+    int started = 0;
+    int status = 0;
+
+    if (count <= 0) return 0;
+    if (workers > count) workers = count;
+    if (workers < 1) workers = 1;
+
+    shm_id = shm_create(IPC_PRIVATE, sizeof(ReplicationPool) + sizeof(ReplicationResult) * count);
+    if (shm_id == -1) {
+        perror("Replications: Failed to create shared memory");
+        return 1;
+    }
+    pool = (ReplicationPool*)shm_attach(shm_id);
+    // Segment goes away with the last detach, even if a worker crashes
+    shm_close(shm_id);
+    if (pool == (void*)-1) {
+        perror("Replications: Failed to attach shared memory");
+        return 1;
+    }
+
+    pool->next_job = 0;
+    for (int i = 0; i < count; i++) pool->results[i].status = -1;
+
+    // Unflushed output would be duplicated into every worker
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int w = 0; w < workers; w++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Replications: Failed to fork worker");
+            break;
+        }
+        if (pid == 0) {
+            replications_worker(pool, configs, count);
+            shm_detach(pool);
+            _exit(0);
+        }
+        started++;
+    }
+
+    // Without workers the jobs still run, just serially
+    if (started == 0) {
+        replications_worker(pool, configs, count);
+    }
+
+    while (started > 0) {
+        if (wait(NULL) == -1) break;
+        started--;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i] = pool->results[i];
+        if (results[i].status != 0) status = 1;
+    }
+    shm_detach(pool);
+    return status;
+}
+
+/**
+ * Computes mean, sample variance and the 95% confidence interval of the mean.
+ *
+ * @param samples Sample values
+ * @param count Number of samples
+ * @param summary Filled with the summary
+ */
+void replications_summarize(const double* samples, int count, MetricSummary* summary) {
+    double mean = 0;
+    double m2 = 0;
+
+    // Welford's algorithm, stable for large sample values
+    for (int i = 0; i < count; i++) {
+        double delta = samples[i] - mean;
+        mean += delta / (i + 1);
+        m2 += delta * (samples[i] - mean);
+    }
+    summary->mean = mean;
+    summary->variance = count > 1 ? m2 / (count - 1) : 0;
+    summary->ci_half_width = count > 1 ? student_t_975(count - 1) * sqrt(summary->variance / count) : 0;
+}
+
+/**
+ * Replication Runner Entry Point.
+ *
+ * Runs REPLICATIONS discrete-event simulations of the configured port across
+ * WORKERS processes (default: one per CPU). Replication i uses seed SEED + i,
+ * so any single run can be reproduced with ENGINE=des SEED=<seed>.
+ * Prints mean, variance and 95% confidence interval of every metric.
+ *
+ * @return 0 on success, 1 on error
+ */
+int replications_engine_run(void) {
+    DesConfig config;
+    DesConfig* configs;
+    ReplicationResult* results;
+    double* samples;
+    struct timespec start;
+    struct timespec end;
+    double wall_time;
+    int count;
+    int workers;
+    int completed = 0;
+
+    des_config_load(&config);
+    count = CONFIG_GET_INT("REPLICATIONS");
+    workers = CONFIG_GET_INT_OR("WORKERS", replications_default_workers());
+    if (count <= 0) {
+        printf("REPLICATIONS must be a positive number\n");
+        return 1;
+    }
+    if (workers <= 0) workers = replications_default_workers();
+    if (workers > count) workers = count;
+
+    configs = malloc(sizeof(DesConfig) * count);
+    results = malloc(sizeof(ReplicationResult) * count);
+    samples = malloc(sizeof(double) * count);
+    if (!configs || !results || !samples) {
+        perror("Replications: Failed to allocate results");
+        free(configs);
+        free(results);
+        free(samples);
+        return 1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        configs[i] = config;
+        configs[i].seed = config.seed + i;
+    }
+
+    printf("Running %d replications on %d workers (seeds %llu..%llu)\n",
+           count, workers, config.seed, config.seed + count - 1);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (replications_execute(configs, count, workers, results) != 0) {
+        fprintf(stderr, "Replications: Some runs did not complete\n");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    wall_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    // Failed runs are left out of every metric
+    for (int i = 0; i < count; i++) {
+        if (results[i].status == 0) results[completed++] = results[i];
+    }
+
+    printf("\n=== Replication Statistics ===\n");
+    printf("Replications completed:       %d/%d\n", completed, count);
+    printf("%-30s %14s %14s %14s %14s\n", "Metric", "Mean", "Variance", "CI95 low", "CI95 high");
+    for (size_t m = 0; m < sizeof(METRICS) / sizeof(METRICS[0]); m++) {
+        MetricSummary summary;
+        for (int i = 0; i < completed; i++) samples[i] = METRICS[m].sample(&results[i]);
+        replications_summarize(samples, completed, &summary);
+        printf("%-30s %14.3f %14.3f %14.3f %14.3f\n", METRICS[m].name, summary.mean, summary.variance,
+               summary.mean - summary.ci_half_width, summary.mean + summary.ci_half_width);
+    }
+    printf("==============================\n");
+    printf("Wall time: %.3f s (%.1f replications/s)\n", wall_time, wall_time > 0 ? count / wall_time : 0);
+
+    free(configs);
+    free(results);
+    free(samples);
+    return completed == count ? 0 : 1;
+}
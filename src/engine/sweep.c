@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/config.h"
+#include "engine/des.h"
+#include "engine/replications.h"
+#include "engine/sweep.h"
+
+typedef enum SweepObjective {
+    SWEEP_OBJECTIVE_THROUGHPUT,     // Maximize boarded passengers per hour
+    SWEEP_OBJECTIVE_P95             // Minimize p95 time to board
+} SweepObjective;
+
+typedef struct SweepParameter {
+    const char* name;
+    size_t offset;
+} SweepParameter;
+
+// Parameters that can be swept, by their environment variable name
+static const SweepParameter SWEEP_PARAMETERS[] = {
+    { "FERRY_COUNT",                 offsetof(DesConfig, ferry_count) },
+    { "FERRY_CAPACITY",              offsetof(DesConfig, ferry_capacity) },
+    { "DOCK_COUNT",                  offsetof(DesConfig, dock_count) },
+    { "RAMP_CAPACITY_REG",           offsetof(DesConfig, ramp_capacity_regular) },
+    { "RAMP_CAPACITY_VIP",           offsetof(DesConfig, ramp_capacity_vip) },
+    { "FERRY_DEPARTURE_INTERVAL",    offsetof(DesConfig, ferry_departure_interval) },
+    { "FERRY_TRAVEL_TIME",           offsetof(DesConfig, ferry_travel_time) },
+    { "PASSENGER_SECURITY_TIME_MIN", offsetof(DesConfig, security_time_min) },
+    { "PASSENGER_SECURITY_TIME_MAX", offsetof(DesConfig, security_time_max) },
+    { "PASSENGER_BOARDING_TIME",     offsetof(DesConfig, passenger_boarding_time) },
+    { "FERRY_GATE_MAX_DELAY",        offsetof(DesConfig, ferry_gate_delay_max) },
+    { "FERRY_BAGGAGE_LIMIT_MIN",     offsetof(DesConfig, ferry_baggage_limit_min) },
+    { "FERRY_BAGGAGE_LIMIT_MAX",     offsetof(DesConfig, ferry_baggage_limit_max) },
+    { "PASSENGER_COUNT",             offsetof(DesConfig, passenger_count) },
+    { "ARRIVAL_INTERVAL",            offsetof(DesConfig, arrivals.interval) }
+};
+
+typedef struct SweepAxis {
+    const SweepParameter* parameter;
+    int values[SWEEP_MAX_VALUES];
+    int count;
+} SweepAxis;
+
+typedef struct SweepPoint {
+    int values[SWEEP_MAX_PARAMETERS];
+    int feasible;
+    MetricSummary throughput;       // Boarded passengers per hour of port day
+    MetricSummary board_time_p95;   // s
+} SweepPoint;
+
+static int* config_field(DesConfig* config, const SweepParameter* parameter) {
+    return (int*)((char*)config + parameter->offset);
+}
+
+/**
+ * Parses one axis of the grid: NAME=min:max[:step], NAME=a,b,c or NAME=value.
+ *
+ * @param spec Axis specification, modified in place
+ * @param axis Filled with the parameter and its values
+ * @return 0 on success, -1 on error
+ */
+static int sweep_parse_axis(char* spec, SweepAxis* axis) {
+    char* values = strchr(spec, '=');
+
+    if (!values) {
+        printf("Invalid SWEEP entry: %s (expected NAME=min:max[:step] or NAME=a,b,c)\n", spec);
+        return -1;
+    }
+    *values++ = '\0';
+
+    axis->parameter = NULL;
+    for (size_t i = 0; i < sizeof(SWEEP_PARAMETERS) / sizeof(SWEEP_PARAMETERS[0]); i++) {
+        if (strcmp(spec, SWEEP_PARAMETERS[i].name) == 0) axis->parameter = &SWEEP_PARAMETERS[i];
+    }
+    if (!axis->parameter) {
+        printf("Unknown SWEEP parameter: %s\n", spec);
+        return -1;
+    }
+
+    axis->count = 0;
+    if (strchr(values, ':')) {
+        int min = 0;
+        int max = 0;
+        int step = 1;
+        if (sscanf(values, "%d:%d:%d", &min, &max, &step) < 2 || step <= 0 || max < min) {
+            printf("Invalid SWEEP range for %s: %s\n", spec, values);
+            return -1;
+        }
+        for (int value = min; value <= max && axis->count < SWEEP_MAX_VALUES; value += step) {
+            axis->values[axis->count++] = value;
+        }
+    } else {
+        for (char* value = strtok(values, ","); value && axis->count < SWEEP_MAX_VALUES; value = strtok(NULL, ",")) {
+            axis->values[axis->count++] = atoi(value);
+        }
+    }
+    if (axis->count == 0) {
+        printf("No values for SWEEP parameter %s\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Parses the SWEEP grid: axes separated by spaces or semicolons.
+ *
+ * @param sweep Grid specification
+ * @param axes Filled with the axes
+ * @return Number of axes, -1 on error
+ */
+static int sweep_parse(const char* sweep, SweepAxis* axes) {
+    char* copy = strdup(sweep);
+    char* saveptr = NULL;
+    int count = 0;
+
+    if (!copy) return -1;
+    for (char* spec = strtok_r(copy, " ;", &saveptr); spec; spec = strtok_r(NULL, " ;", &saveptr)) {
+        if (count == SWEEP_MAX_PARAMETERS) {
+            printf("At most %d SWEEP parameters are supported\n", SWEEP_MAX_PARAMETERS);
+            count = -1;
+            break;
+        }
+        if (sweep_parse_axis(spec, &axes[count]) != 0) {
+            count = -1;
+            break;
+        }
+        count++;
+    }
+    free(copy);
+    return count;
+}
+
+/**
+ * Decodes a grid index into one value per axis (mixed radix, last axis fastest).
+ */
+static void sweep_point_values(const SweepAxis* axes, int axis_count, int index, int* values) {
+    for (int a = axis_count - 1; a >= 0; a--) {
+        values[a] = axes[a].values[index % axes[a].count];
+        index /= axes[a].count;
+    }
+}
+
+static int sweep_better(SweepObjective objective, const SweepPoint* candidate, const SweepPoint* best) {
+    if (!best) return 1;
+    if (objective == SWEEP_OBJECTIVE_P95) return candidate->board_time_p95.mean < best->board_time_p95.mean;
+    return candidate->throughput.mean > best->throughput.mean;
+}
+
+/**
+ * Sweep Entry Point.
+ *
+ * Runs the discrete-event simulation at every point of the SWEEP grid,
+ * REPLICATIONS times per point (seeds SEED..SEED+REPLICATIONS-1, the same at every
+ * point so configurations are compared on the same passenger streams), on the
+ * replication worker pool. Points with more than FLEET_BUDGET ferries are skipped.
+ * Reports every point and the one that maximizes boarded passengers per hour
+ * (OBJECTIVE=throughput, default) or minimizes p95 time to board (OBJECTIVE=p95).
+ *
+ * @return 0 on success, 1 on error
+ */
+int sweep_engine_run(void) {
+    SweepAxis axes[SWEEP_MAX_PARAMETERS];
+    SweepObjective objective = SWEEP_OBJECTIVE_THROUGHPUT;
+    const char* objective_name = getenv("OBJECTIVE");
+    DesConfig base;
+    DesConfig* configs = NULL;
+    ReplicationResult* results = NULL;
+    SweepPoint* points = NULL;
+    SweepPoint* best = NULL;
+    double* throughput = NULL;
+    double* board_time_p95 = NULL;
+    struct timespec start;
+    struct timespec end;
+    int axis_count;
+    int point_count = 1;
+    int feasible_count = 0;
+    int replications;
+    int workers;
+    int fleet_budget;
+    int jobs = 0;
+    int status = 1;
+
+    des_config_load(&base);
+    axis_count = sweep_parse(getenv("SWEEP"), axes);
+    if (axis_count <= 0) {
+        if (axis_count == 0) printf("SWEEP has no parameters\n");
+        return 1;
+    }
+    if (objective_name && strcmp(objective_name, "p95") == 0) {
+        objective = SWEEP_OBJECTIVE_P95;
+    } else if (objective_name && strcmp(objective_name, "throughput") != 0) {
+        printf("Unknown OBJECTIVE: %s (expected throughput or p95)\n", objective_name);
+        return 1;
+    }
+    replications = CONFIG_GET_INT_OR("REPLICATIONS", SWEEP_DEFAULT_REPLICATIONS);
+    workers = CONFIG_GET_INT_OR("WORKERS", replications_default_workers());
+    fleet_budget = CONFIG_GET_INT_OR("FLEET_BUDGET", 0);
+    if (replications <= 0) replications = 1;
+    if (workers <= 0) workers = replications_default_workers();
+
+    for (int a = 0; a < axis_count; a++) point_count *= axes[a].count;
+
+    points = calloc(point_count, sizeof(SweepPoint));
+    configs = malloc(sizeof(DesConfig) * point_count * replications);
+    results = malloc(sizeof(ReplicationResult) * point_count * replications);
+    throughput = malloc(sizeof(double) * replications);
+    board_time_p95 = malloc(sizeof(double) * replications);
+    if (!points || !configs || !results || !throughput || !board_time_p95) {
+        perror("Sweep: Failed to allocate grid");
+        goto cleanup;
+    }
+
+    // One job per feasible point and replication
+    for (int p = 0; p < point_count; p++) {
+        DesConfig config = base;
+        sweep_point_values(axes, axis_count, p, points[p].values);
+        for (int a = 0; a < axis_count; a++) *config_field(&config, axes[a].parameter) = points[p].values[a];
+        if (fleet_budget > 0 && config.ferry_count > fleet_budget) continue;
+        points[p].feasible = 1;
+        feasible_count++;
+        for (int r = 0; r < replications; r++) {
+            configs[jobs] = config;
+            configs[jobs].seed = base.seed + r;
+            jobs++;
+        }
+    }
+
+    printf("Sweeping %d configurations (%d within fleet budget) x %d replications on %d workers\n",
+           point_count, feasible_count, replications, workers);
+    printf("Objective: %s\n", objective == SWEEP_OBJECTIVE_P95 ? "minimize p95 time to board" : "maximize boarded passengers per hour");
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (replications_execute(configs, jobs, workers, results) != 0) {
+        fprintf(stderr, "Sweep: Some runs did not complete\n");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("\n=== Sweep Results ===\n");
+    for (int a = 0; a < axis_count; a++) printf("%-*s ", (int)strlen(axes[a].parameter->name), axes[a].parameter->name);
+    printf("%14s %10s %14s %10s\n", "Boarded/hour", "CI95 +-", "p95 board (s)", "CI95 +-");
+
+    jobs = 0;
+    for (int p = 0; p < point_count; p++) {
+        int completed = 0;
+
+        if (!points[p].feasible) continue;
+        for (int r = 0; r < replications; r++, jobs++) {
+            ReplicationResult* result = &results[jobs];
+            double hours = (double)result->report.simulated_time / DES_USEC_PER_SEC / 3600;
+            if (result->status != 0) continue;
+            throughput[completed] = hours > 0 ? result->stats.passengers_boarded / hours : 0;
+            board_time_p95[completed] = result->report.board_time_p95;
+            completed++;
+        }
+        replications_summarize(throughput, completed, &points[p].throughput);
+        replications_summarize(board_time_p95, completed, &points[p].board_time_p95);
+
+        for (int a = 0; a < axis_count; a++) printf("%*d ", (int)strlen(axes[a].parameter->name), points[p].values[a]);
+        printf("%14.1f %10.1f %14.3f %10.3f\n", points[p].throughput.mean, points[p].throughput.ci_half_width,
+               points[p].board_time_p95.mean, points[p].board_time_p95.ci_half_width);
+
+        // A configuration where nobody boards has no time to board to minimize
+        if (completed == 0 || points[p].throughput.mean <= 0) continue;
+        if (sweep_better(objective, &points[p], best)) best = &points[p];
+    }
+    printf("=====================\n");
+
+    if (best) {
+        printf("Best:");
+        for (int a = 0; a < axis_count; a++) printf(" %s=%d", axes[a].parameter->name, best->values[a]);
+        printf(" (%.1f boarded/hour, p95 time to board %.3f s)\n", best->throughput.mean, best->board_time_p95.mean);
+        status = 0;
+    } else {
+        printf("No configuration within the fleet budget boarded any passengers\n");
+    }
+    printf("Wall time: %.3f s\n", (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
+cleanup:
+    free(points);
+    free(configs);
+    free(results);
+    free(throughput);
+    free(board_time_p95);
+    return status;
+}
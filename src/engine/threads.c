@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "common/config.h"
+#include "common/state.h"
+#include "common/state_lock.h"
+#include "common/baggage.h"
+#include "common/ramp.h"
+#include "common/security_ring.h"
+#include "common/mailbox.h"
+#include "common/stats.h"
+#include "common/ipc.h"
+#include "common/logging.h"
+#include "common/arrivals.h"
+#include "common/trace.h"
+#include "common/timescale.h"
+#include "processes/main.h"
+#include "processes/passenger.h"
+#include "processes/ferry_manager.h"
+#include "processes/security_manager.h"
+#include "engine/threads.h"
+
+#define ROLE ROLE_PORT_MANAGER
+
+/**
+ * State of the threaded engine. Exactly one engine runs per process,
+ * so it lives in a single static instance shared with the worker threads.
+ */
+typedef struct ThreadsEngine {
+    IpcHandles ipc;
+    int log_queue;
+    int shm_id;
+    SharedState* shared_state;
+    volatile sig_atomic_t running;
+
+    pthread_mutex_t lock;
+    pthread_cond_t passenger_done;
+    int live_passengers;
+    int finished_passengers;
+} ThreadsEngine;
+
+static ThreadsEngine engine = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .passenger_done = PTHREAD_COND_INITIALIZER
+};
+
+typedef struct PassengerArgs {
+    int id;
+    int traced;
+    PassengerProfile profile;   // Replayed attributes when traced
+} PassengerArgs;
+
+typedef struct LoggerArgs {
+    int queue_id;
+    int shm_id;
+} LoggerArgs;
+
+static void* logger_thread(void* arg) {
+    LoggerArgs* args = arg;
+    logger_loop(args->queue_id, &args->shm_id, 1);
+    return NULL;
+}
+
+static void* security_thread(void* arg) {
+    (void)arg;
+    run_security_manager(&engine.ipc);
+    return NULL;
+}
+
+static void* ferry_thread(void* arg) {
+    ferry_manager_run(&engine.ipc, 1, (int)(intptr_t)arg);
+    return NULL;
+}
+
+/**
+ * Passenger thread body. Detached; reports completion so the spawner can
+ * keep the number of live passengers bounded.
+ */
+static void* passenger_thread(void* arg) {
+    PassengerArgs* args = arg;
+
+    passenger_run(&engine.ipc, args->id, args->traced ? &args->profile : NULL);
+    free(args);
+
+    pthread_mutex_lock(&engine.lock);
+    engine.live_passengers--;
+    engine.finished_passengers++;
+    pthread_cond_signal(&engine.passenger_done);
+    pthread_mutex_unlock(&engine.lock);
+    return NULL;
+}
+
+/**
+ * Closes the port from the signal thread.
+ * Equivalent of the port manager closing a terminal, plus the closing flag
+ * for passengers and EINTR for every blocked System V wait.
+ */
+static void close_port(void) {
+    passenger_notify_port_closed();
+    state_mutex_lock(&engine.shared_state->locks[SEM_STATE_MUTEX_VARIANT_PORT].mutex);
+    engine.shared_state->port_open = 0;
+    state_mutex_unlock(&engine.shared_state->locks[SEM_STATE_MUTEX_VARIANT_PORT].mutex);
+    baggage_wake_all(engine.shared_state);
+    ramp_wake_all(engine.shared_state);
+    ipc_interrupt_waiters();
+}
+
+/**
+ * Signal thread. All engine threads block SIGINT/SIGUSR1/SIGUSR2, so signals sent
+ * to the simulation are consumed here and translated to the same effects
+ * the process engine gets from its per-process handlers:
+ * - SIGINT: close the port and request departure of the boarding ferry
+ * - SIGUSR1: request departure of the boarding ferry
+ * - SIGUSR2: close the port
+ */
+static void* signal_thread(void* arg) {
+    sigset_t* signals = arg;
+    int signum;
+
+    while (1) {
+        if (sigwait(signals, &signum) != 0) continue;
+        if (!engine.running) break;
+        if (signum == SIGINT) {
+            log_message(engine.log_queue, ROLE, -1, "Received SIGINT, closing port");
+            ferry_manager_notify_depart();
+            close_port();
+        } else if (signum == SIGUSR1) {
+            // Every ferry thread boarding at a dock of the terminal sleeps on its doorbell
+            ferry_manager_notify_depart();
+            ramp_wake_ferries(engine.shared_state);
+        } else if (signum == SIGUSR2) {
+            log_message(engine.log_queue, ROLE, -1, "Received SIGUSR2, closing port");
+            close_port();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Threaded Engine Entry Point.
+ *
+ * Runs the whole simulation inside the calling process: the logger, the security
+ * manager, one thread per ferry and one thread per passenger execute the same
+ * role logic as the separate processes, on top of the process-local IPC backend.
+ * Takes the place of the port manager process:
+ * 1. Starts logger, security manager and ferry manager threads
+ * 2. Spawns passenger threads, keeping at most MAX_LIVE_PASSENGERS alive,
+ *    or replays them from TRACE at their recorded times
+ * 3. Closes the port once every passenger has finished
+ * 4. Waits for ferries, then shuts down security manager and logger
+ *
+ * IPC objects must already be created with IPC_BACKEND_LOCAL selected.
+ *
+ * @param ipc_key Path used to generate IPC keys
+ * @param log_queue_id Logger queue identifier
+ * @param shm_id Shared state identifier
+ * @return 0 on success, 1 on error, including a manager thread that failed to start
+ */
+int threads_engine_run(const char* ipc_key, int log_queue_id, int shm_id) {
+    sigset_t signals;
+    struct sigaction sa;
+    pthread_attr_t passenger_attr;
+    pthread_t logger;
+    pthread_t signal_handler;
+    pthread_t security;
+    pthread_t passenger;
+    LoggerArgs logger_args;
+    ArrivalConfig arrivals;
+    Trace trace;
+    TraceEntry entry;
+    struct timespec start;
+    struct timespec now;
+    const char* trace_path = getenv("TRACE");
+    int ferry_count;
+    int passenger_count;
+    int max_live;
+    int spawned = 0;
+    int ferries_started = 0;
+    int security_started;
+    int status = 0;
+    int unanswered;
+
+    ferry_count = CONFIG_GET_INT("FERRY_COUNT");
+    passenger_count = CONFIG_GET_INT("PASSENGER_COUNT");
+    max_live = CONFIG_GET_INT_OR("MAX_LIVE_PASSENGERS", THREADS_DEFAULT_MAX_LIVE_PASSENGERS);
+    if (max_live <= 0) max_live = passenger_count;
+    arrivals_load(&arrivals);
+
+    pthread_t ferries[ferry_count];
+
+    if (trace_path && trace_open(trace_path, &trace) != 0) {
+        perror("Threads engine: Failed to open trace");
+        return 1;
+    }
+
+    engine.log_queue = log_queue_id;
+    engine.shm_id = shm_id;
+    // Every role thread works on the same handles, opened once
+    if (ipc_handles_open(ipc_key, 0, &engine.ipc) != 0) {
+        perror("Threads engine: Failed to open shared state");
+        return 1;
+    }
+    engine.shared_state = (SharedState*)engine.ipc.shm;
+
+    // Route simulation signals to the signal thread only; every thread created
+    // below inherits this mask. Dispositions must not be SIG_IGN for sigwait.
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    sa.sa_handler = SIG_DFL;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+    sigaction(SIGUSR2, &sa, NULL);
+
+    logger_args.queue_id = log_queue_id;
+    logger_args.shm_id = shm_id;
+    if (pthread_create(&logger, NULL, logger_thread, &logger_args) != 0) {
+        perror("Threads engine: Failed to start logger");
+        return 1;
+    }
+
+    engine.running = 1;
+    if (pthread_create(&signal_handler, NULL, signal_thread, &signals) != 0) {
+        perror("Threads engine: Failed to start signal thread");
+        engine.running = 0;
+    }
+
+    log_message(log_queue_id, ROLE, -1, "Port manager starting up");
+
+    // Without every manager nobody could be screened or carried: close the port, join only the threads that started
+    if (!(security_started = pthread_create(&security, NULL, security_thread, NULL) == 0)) {
+        perror("Failed to spawn security manager");
+        status = 1;
+    }
+    for (int i = 0; i < ferry_count && status == 0; i++) {
+        if (pthread_create(&ferries[i], NULL, ferry_thread, (void*)(intptr_t)i) != 0) {
+            perror("Failed to spawn ferry manager");
+            status = 1;
+            break;
+        }
+        ferries_started++;
+    }
+    if (status != 0) {
+        log_message(log_queue_id, ROLE, -1, "[ERROR] Started %d of %d ferry managers, security manager %s, closing the port",
+                    ferries_started, ferry_count, security_started ? "running" : "not started");
+        close_port();
+    }
+
+    // Spawn passengers as detached threads with small stacks, never more than max_live at once,
+    // following the arrival process until the port closes
+    pthread_attr_init(&passenger_attr);
+    pthread_attr_setdetachstate(&passenger_attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&passenger_attr, THREADS_PASSENGER_STACK_SIZE);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (spawned < passenger_count && engine.shared_state->port_open) {
+        PassengerArgs* args = malloc(sizeof(PassengerArgs));
+
+        if (!args) {
+            perror("Failed to spawn passenger");
+            break;
+        }
+        args->id = spawned;
+        args->traced = 0;
+        if (trace_path) {
+            int status = trace_next(&trace, &entry);
+            long long wait;
+            if (status != 1) {
+                if (status == -1) log_message(log_queue_id, ROLE, -1, "[ERROR] Malformed trace record %ld, replay stopped", trace.line);
+                free(args);
+                break;
+            }
+            args->traced = 1;
+            args->profile.gender = entry.gender;
+            args->profile.vip = entry.vip;
+            args->profile.bag_weight = entry.bag_weight;
+            args->profile.dangerous = entry.dangerous;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            wait = time_scale_wall_usec(entry.arrival * 1000) - ((long long)(now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000);
+            if (wait > 0) arrivals_sleep(wait);
+        }
+
+        pthread_mutex_lock(&engine.lock);
+        while (engine.live_passengers >= max_live) {
+            pthread_cond_wait(&engine.passenger_done, &engine.lock);
+        }
+        engine.live_passengers++;
+        pthread_mutex_unlock(&engine.lock);
+
+        while (pthread_create(&passenger, &passenger_attr, passenger_thread, args) != 0) {
+            perror("Failed to spawn passenger");
+            pthread_mutex_lock(&engine.lock);
+            // Out of threads: wait for one to finish and retry, or give up if none are running
+            if (--engine.live_passengers == 0) {
+                pthread_mutex_unlock(&engine.lock);
+                free(args);
+                args = NULL;
+                break;
+            }
+            pthread_cond_wait(&engine.passenger_done, &engine.lock);
+            engine.live_passengers++;
+            pthread_mutex_unlock(&engine.lock);
+        }
+        if (!args) break;
+        spawned++;
+        if (!trace_path && arrivals.interval > 0 && spawned < passenger_count) {
+            time_scale_sleep(arrivals_next_gap(&arrivals, rand() / (RAND_MAX + 1.0)));
+        }
+    }
+    pthread_attr_destroy(&passenger_attr);
+    if (trace_path) {
+        log_message(log_queue_id, ROLE, -1, "Replayed %d passengers from %s", spawned, trace_path);
+        trace_close(&trace);
+    }
+
+    // Update spawned passengers count
+    STATS_ADD(&engine.shared_state->stats, 0, passengers_spawned, spawned);
+
+    if (status == 0) log_message(log_queue_id, ROLE, -1, "Spawned all ferries and passengers");
+
+    // Wait for all passengers to complete, then close port
+    pthread_mutex_lock(&engine.lock);
+    while (engine.finished_passengers < spawned) {
+        pthread_cond_wait(&engine.passenger_done, &engine.lock);
+    }
+    pthread_mutex_unlock(&engine.lock);
+
+    if (status == 0) log_message(log_queue_id, ROLE, -1, "All passengers exited. Marking port as closed.");
+
+    state_mutex_lock(&engine.shared_state->locks[SEM_STATE_MUTEX_VARIANT_PORT].mutex);
+    engine.shared_state->port_open = 0;
+    state_mutex_unlock(&engine.shared_state->locks[SEM_STATE_MUTEX_VARIANT_PORT].mutex);
+    ramp_wake_ferries(engine.shared_state);
+
+    // Wait for all ferries to complete their final trips and exit
+    for (int i = 0; i < ferries_started; i++) {
+        pthread_join(ferries[i], NULL);
+    }
+
+    log_message(log_queue_id, ROLE, -1, "Port manager exiting");
+
+    // Security manager exits once its ring is closed
+    security_ring_close(&engine.shared_state->security);
+    if (security_started) pthread_join(security, NULL);
+    if ((unanswered = mailbox_pending(&engine.shared_state->mailboxes)) > 0) {
+        log_message(log_queue_id, ROLE, -1, "[ERROR] %d reply mailboxes left unanswered", unanswered);
+    }
+
+    if (engine.running) {
+        engine.running = 0;
+        pthread_kill(signal_handler, SIGUSR1);
+        pthread_join(signal_handler, NULL);
+    }
+
+    // Logger drains the queue, prints statistics and exits once the queue is removed
+    queue_close(log_queue_id);
+    pthread_join(logger, NULL);
+    ipc_handles_close(&engine.ipc);
+
+    return status;
+}
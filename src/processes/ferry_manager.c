@@ -4,89 +4,106 @@
 #include <signal.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
 
 #include "common/config.h"
 #include "common/state.h"
+#include "common/state_lock.h"
+#include "common/baggage.h"
+#include "common/ramp.h"
+#include "common/mailbox.h"
+#include "common/stats.h"
 #include "common/ipc.h"
 #include "common/logging.h"
 #include "common/messages.h"
 #include "common/macros.h"
+#include "common/timescale.h"
 #include "processes/ferry_manager.h"
 
 #define ROLE ROLE_FERRY_MANAGER
 
-volatile int should_depart = 0;
-volatile int is_active = 0;
+static volatile sig_atomic_t depart_requests = 0;
 
 /**
- * Signal handler for ferry manager.
- * SIGUSR1: Triggers early departure when the ferry is active and boarding.
+ * Requests early departure of the ferries that are currently boarding.
+ * Async-signal-safe: called from the SIGUSR1 handler of the ferry manager process,
+ * and from the signal thread of the threaded engine. Requests made before a ferry
+ * opens its gate are ignored by that ferry. The port manager asks a single ferry
+ * through FerryState.depart_requests instead, the same way.
+ * 
+ * A ferry asleep at its dock only sees the request once its doorbell rings:
+ * the caller rings every dock of every terminal the ferries serve (ramp_wake_ferries).
+ */
+void ferry_manager_notify_depart(void) {
+    depart_requests++;
+}
+
+/**
+ * Picks the terminal a ferry docks at next.
+ *
+ * @param terminals IPC objects of every terminal
+ * @param terminal_count Number of terminals
+ * @param from Preferred terminal
+ * @return First terminal from the preferred one on that is still open, -1 if all are closed
  */
-static void handler(int signal) {
-    if (is_active && signal == SIGUSR1) should_depart = 1;
+static int ferry_next_terminal(const IpcHandles* terminals, int terminal_count, int from) {
+    for (int i = 0; i < terminal_count; i++) {
+        int terminal = (from + i) % terminal_count;
+        if (((SharedState*)terminals[terminal].shm)->port_open) return terminal;
+    }
+    return -1;
 }
 
 /**
- * Ferry Manager Process Entry Point.
+ * Ferry manager logic.
  * 
  * Manages a single ferry throughout its lifecycle:
- * 1. Waits for turn to dock
- * 2. Opens boarding gate and processes passengers from the ramp queue
- * 3. Handles early departure signals or waits for departure interval
+ * 1. Waits for a free dock
+ * 2. Opens boarding gate and processes passengers from its ramp lane
+ * 3. Handles early departure requests (SIGUSR1, or depart-now on the port
+ *    manager's control channel) or waits for departure interval
  * 4. Departs with passengers, travels, and returns
  * 5. Repeats until the port closes
  * 
- * @param argc Argument count (expects at least 3)
- * @param argv Arguments: [0]=program name, [1]=IPC key path, [2]=ferry ID
+ * With several terminals the fleet is shared: ferry N starts at terminal
+ * N % terminal_count and every trip takes it on to the next open terminal.
+ * The ferry exits once every terminal is closed.
+ * 
+ * A terminal has DOCK_COUNT docks, so that many ferries board at once.
+ * Each dock has its own ramp lane in shared memory: regular and VIP ramp
+ * slots, request rings and an exit ring (ramp.h). Every passenger let onto
+ * the ramp holds a lease on its slot. The ferry takes the slot back from a
+ * passenger who exits on the ramp, so a crashed passenger never keeps the
+ * gate from closing. A passenger still on the ramp RAMP_LEASE_TIME later
+ * keeps its slot, and the ferry waits for it.
+ * 
+ * Gate delay, departure interval and travel are simulated durations,
+ * compressed or stretched by TIME_SCALE.
+ * 
+ * Runs either as the body of a ferry manager process or as a ferry thread
+ * of the threaded engine.
+ * 
+ * @param terminals IPC objects of every terminal
+ * @param terminal_count Number of terminals
+ * @param ferry_id Ferry identifier
+ * @return 0 on success, 1 on error
  */
-int main(int argc, char** argv) {
-    int ferry_id;
-    int log_queue = -1;
-    int queue_ramp;
-    int shm_id;
-    int sem_state_mutex;
+int ferry_manager_run(const IpcHandles* terminals, int terminal_count, int ferry_id) {
+    int log_queue;
     int sem_current_ferry;
-    int sem_ramp_slots;
     int had_passengers = 0;
+    int dock = 0;
+    int terminal = ferry_id % terminal_count;
 
     SharedState* shared_state;
 
-    key_t shm_key;
-    key_t sem_state_mutex_key;
-    key_t key_ramp;
-    key_t sem_current_ferry_key;
-    key_t sem_ramp_slots_key;
-    key_t log_queue_key;
-
     int ferry_capacity;
     int ferry_gate_delay_max;
     int ramp_capacity_regular;
     int ramp_capacity_vip;
     int ferry_departure_interval;
     int ferry_travel_time;
-
-    struct sigaction sa;
-    srand(time(NULL) ^ getpid());
-
-    sa.sa_handler = handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART;
-    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
-        perror("[FERRY] Failed to setup signal handler SIGUSR1");
-        return 1;
-    }
-    if (sigaction(SIGUSR2, &sa, NULL) == -1) {
-        perror("[FERRY] Failed to setup signal handler SIGUSR2");
-        return 1;
-    }
-    if (sigaction(SIGINT, &sa, NULL) == -1) {
-        perror("[FERRY] Failed to setup signal handler SIGINT");
-        return 1;
-    }
-
-    if (argc < 3) return 1;
-    
-    ferry_id = atoi(argv[2]);
+    long long ramp_lease_time;
 
     ferry_capacity = CONFIG_GET_INT("FERRY_CAPACITY");
     ferry_gate_delay_max = CONFIG_GET_INT("FERRY_GATE_MAX_DELAY");
@@ -94,109 +111,121 @@ int main(int argc, char** argv) {
     ramp_capacity_vip = CONFIG_GET_INT("RAMP_CAPACITY_VIP");
     ferry_departure_interval = CONFIG_GET_INT("FERRY_DEPARTURE_INTERVAL");
     ferry_travel_time = CONFIG_GET_INT("FERRY_TRAVEL_TIME");
+    ramp_lease_time = CONFIG_GET_INT_OR("RAMP_LEASE_TIME", CONFIG_GET_INT("PASSENGER_BOARDING_TIME") + RAMP_LEASE_GRACE_USEC);
 
-    // Initialize IPC resources: queues, shared memory, and semaphores
-    log_queue_key = ftok(argv[1], IPC_KEY_LOG_ID);
-    shm_key = ftok(argv[1], IPC_KEY_SHM_ID);
-    sem_state_mutex_key = ftok(argv[1], IPC_KEY_SEM_STATE_ID);
-    key_ramp = ftok(argv[1], IPC_KEY_QUEUE_RAMP_ID);
-    sem_current_ferry_key = ftok(argv[1], IPC_KEY_SEM_CURRENT_FERRY);
-    sem_ramp_slots_key = ftok(argv[1], IPC_KEY_SEM_RAMP_SLOTS_ID);
-    
-    if (log_queue_key != -1) {
-        log_queue = queue_open(log_queue_key);
-    }
-    
-    shm_id = shm_open(shm_key);
-    if (shm_id == -1) {
-        return 1;
-    }
-    
-    shared_state = (SharedState*)shm_attach(shm_id);
-    if (shared_state == (void*)-1) {
-        return 1;
-    }
-    
-    queue_ramp = queue_open(key_ramp);
-    sem_state_mutex = sem_open(sem_state_mutex_key, SEM_STATE_MUTEX_VARIANT_COUNT);
-    sem_current_ferry = sem_open(sem_current_ferry_key, 1);
-    sem_ramp_slots = sem_open(sem_ramp_slots_key, 2);
-    
-    if (sem_state_mutex == -1 || sem_current_ferry == -1 || queue_ramp == -1 || sem_ramp_slots == -1) {
-        shm_detach(shared_state);
-        return 1;
-    }
+    // IPC objects are opened once per process by the caller
+    log_queue = terminals[0].log_queue;
     
     log_message(log_queue, ROLE, ferry_id, "Ferry manager started");
 
     // Ferry main loop: wait for turn, board passengers, depart, travel, and return
     while (1) {
-        if (!shared_state->port_open) break;
+        terminal = ferry_next_terminal(terminals, terminal_count, terminal);
+        if (terminal == -1) break;
+        sem_current_ferry = terminals[terminal].sem_current_ferry;
+        shared_state = (SharedState*)terminals[terminal].shm;
+        if (terminal_count > 1) log_message(log_queue, ROLE, ferry_id, "Ferry heading to terminal %d", terminal);
+
         log_message(log_queue, ROLE, ferry_id, "Ferry manager waiting for semaphore");
-        // Wait for turn to become the active ferry at the dock
+        // Wait for a free dock
         START_SEMAPHORE(sem_current_ferry, 0)
-        is_active = 1;
 
         if (!shared_state->port_open) {
             log_message(log_queue, ROLE, ferry_id, "Ferry manager - port is closed");
             sem_signal_single(sem_current_ferry,0);
-            break;
+            continue;
         }
 
-        START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
+        START_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
         log_message(log_queue, ROLE, ferry_id, "Ferry manager updating current ferry state");
-        shared_state->current_ferry_id = ferry_id;
-        END_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
+        // Holding a permit of the dock semaphore guarantees a free dock
+        for (dock = 0; shared_state->docked_ferry[dock] != -1; dock++) {}
+        // Passengers read the docks without the lock, through the seqlock
+        docks_publish(shared_state, dock, ferry_id);
+        END_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
+        if (shared_state->dock_count > 1) log_message(log_queue, ROLE, ferry_id, "Ferry docked at dock %d", dock);
+
+        // Wake the passengers at baggage check whose bags this ferry may take
+        int baggage_limit = shared_state->ferries[ferry_id].baggage_limit;
+        int demand_fitting;
+        int demand_heavier;
+        baggage_demand(shared_state, baggage_limit, &demand_fitting, &demand_heavier);
+        baggage_wake(shared_state, baggage_limit);
+        log_message(log_queue, ROLE, ferry_id, "Baggage check demand: %d waiting may fit the limit %d, %d heavier",
+                    demand_fitting, baggage_limit, demand_heavier);
 
         // Initialize ferry state for boarding
-        START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+        START_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
         shared_state->ferries[ferry_id].status = FERRY_BOARDING;
         shared_state->ferries[ferry_id].baggage_weight_total = 0;
         shared_state->ferries[ferry_id].passenger_count = 0;
         log_message(log_queue, ROLE, ferry_id, "Ferry is preparing for boarding (baggage_limit: %d, capacity: %d)",
                     shared_state->ferries[ferry_id].baggage_limit, ferry_capacity);
-        END_SEMAPHORE(sem_state_mutex,SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+        END_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
 
         // Simulate gate opening delay, then open ramp slots for passenger boarding
         int boarding_delay = rand() % ferry_gate_delay_max;
         log_message(log_queue, ROLE, ferry_id, "Ferry gate will open in %d ms", boarding_delay);
-        while (usleep(boarding_delay) == -1) {}
+        time_scale_sleep(boarding_delay);
         log_message(log_queue, ROLE, ferry_id, "Ferry is open for boarding");
-        sem_signal_noundo(sem_ramp_slots, 0, ramp_capacity_regular);
-        sem_signal_noundo(sem_ramp_slots, 1, ramp_capacity_vip);
+        RampLane* lane = &shared_state->ramps[dock];
+        // Passengers let on by this boarding name it in their exits
+        int boarding = ++lane->boardings;
+        ramp_slot_post(&lane->slots[0], ramp_capacity_regular);
+        ramp_slot_post(&lane->slots[1], ramp_capacity_vip);
 
-        // Process boarding: handle ramp queue until departure time or early signal
-        time_t boarding_start = time(NULL);
-        should_depart = 0;
+        // Process boarding: handle the ramp lane until departure time or early signal
+        long long boarding_start = time_scale_now();
+        long long boarding_end = boarding_start + ferry_departure_interval * 1000000LL;
+        sig_atomic_t depart_seen = depart_requests;
+        uint32_t depart_ordered = __atomic_load_n(&shared_state->ferries[ferry_id].depart_requests, __ATOMIC_RELAXED);
         int usage = 0;
         int ramp_cleanup = 0;
         int ramp_empty = 0;
+        long long next_probe = 0;
+        RampLeases leases;
+        ramp_leases_init(&leases);
 
-        // Process ramp messages: grant access to passengers or handle passenger boarding exits
+        // Process ramp messages: grant access to passengers or handle passenger boarding exits.
+        // With nothing on the lane, sleep on its doorbell until a passenger sends a request or exit,
+        // a departure is ordered, the port closes, or the departure or a lease deadline passes
         while (1) {
             int gate_close;
-            RampMessage ramp_msg;
-            gate_close = should_depart ||
-               (time(NULL) - boarding_start) >= ferry_departure_interval;
+            int kind;
+            RampEntry ramp_msg;
+            // Read before looking at the lane and the departure orders: whatever comes later rings again
+            uint32_t rings = ramp_lane_wait_begin(lane);
+            // A closed port departs at once, even if it closed while the gate was opening
+            gate_close = depart_requests != depart_seen || !shared_state->port_open ||
+               __atomic_load_n(&shared_state->ferries[ferry_id].depart_requests, __ATOMIC_RELAXED) != depart_ordered ||
+               time_scale_now() >= boarding_end;
 
-            // Process ramp queue: -RAMP_PRIORITY_REGULAR means receive exit(1), VIP(2), or regular(3) - VIP has priority
-            if (msgrcv(queue_ramp, &ramp_msg, MSG_SIZE(ramp_msg), -RAMP_PRIORITY_REGULAR, IPC_NOWAIT) != -1) {
+            // Process the ramp lane of this dock: exit, VIP, or regular - VIP has priority
+            if ((kind = ramp_receive(lane, &ramp_msg)) != -1) {
                 ramp_empty = 0;
-                if (ramp_msg.mtype == RAMP_MESSAGE_EXIT) {
+                if (kind == RAMP_MESSAGE_EXIT && ramp_msg.boarding != boarding) {
+                    // Every ferry waits for the passengers it let on before leaving the dock
+                    log_message(log_queue, ROLE, ferry_id, "[ERROR] Passenger %d left the ramp of boarding %d, not counted aboard",
+                                ramp_msg.passenger_id, ramp_msg.boarding);
+                } else if (kind == RAMP_MESSAGE_EXIT) {
                     // Passenger completed boarding and is leaving the ramp area
-                    if (!gate_close && !ramp_cleanup && ((ferry_capacity - shared_state->ferries[ferry_id].passenger_count) > usage)) sem_signal_single_noundo(sem_ramp_slots, ramp_msg.is_vip); // Release semaphore slot
-                    usage--;
+                    if (ramp_lease_end(&leases, ramp_msg.passenger_id) == -1) {
+                        // Its slot was taken back already: only count it aboard
+                        log_message(log_queue, ROLE, ferry_id, "Passenger %d left ramp after its lease was reclaimed",
+                                    ramp_msg.passenger_id);
+                    } else {
+                        if (!gate_close && !ramp_cleanup && ((ferry_capacity - shared_state->ferries[ferry_id].passenger_count) > usage)) ramp_slot_post(&lane->slots[ramp_msg.vip], 1); // Release ramp slot
+                        usage--;
+                    }
                     int current_count;
-                    START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+                    START_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
                     shared_state->ferries[ferry_id].passenger_count++;
                     shared_state->ferries[ferry_id].baggage_weight_total += ramp_msg.weight;
                     current_count = shared_state->ferries[ferry_id].passenger_count;
-                    END_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+                    END_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
                     
                     // Update boarded statistics
-                    START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
-                    shared_state->stats.passengers_boarded++;
-                    END_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
+                    STATS_INC(&shared_state->stats, ferry_id, passengers_boarded);
                     
                     log_message(log_queue, ROLE, ferry_id, "Passenger %d left ramp (current_capacity: %d/%d)",
                                 ramp_msg.passenger_id, current_count, ferry_capacity);
@@ -204,95 +233,131 @@ int main(int argc, char** argv) {
                     int available_space = ferry_capacity - shared_state->ferries[ferry_id].passenger_count - usage;
 
                     if (available_space > 0 && !gate_close) {
-                        // Grant ramp access to waiting passenger
-                        log_message(log_queue, ROLE, ferry_id, "Granting ramp to passenger %d (VIP: %d)",
-                                    ramp_msg.passenger_id, ramp_msg.mtype == RAMP_PRIORITY_VIP);
-                        ramp_msg.approved = 1;
-                        usage++;
-                    } else {
+                        // Lease the slot before letting the passenger on: no passenger walks the ramp unleased
+                        if (ramp_lease_grant(&leases, &ramp_msg, time_scale_now() + ramp_lease_time) == -1) {
+                            // Every lease held: turn the passenger away and open its slot again
+                            log_message(log_queue, ROLE, ferry_id, "Rejecting passenger %d - no ramp lease free (on_ramp: %d)",
+                                        ramp_msg.passenger_id, usage);
+                            mailbox_post(&shared_state->mailboxes, ramp_msg.mailbox, 0);
+                            ramp_slot_post(&lane->slots[ramp_msg.vip], 1);
+                        } else if (!mailbox_post(&shared_state->mailboxes, ramp_msg.mailbox, boarding)) {
+                            // Withdrawn with the port closed: nobody walks onto the ramp
+                            ramp_lease_end(&leases, ramp_msg.passenger_id);
+                            log_message(log_queue, ROLE, ferry_id, "Passenger %d withdrew its ramp request", ramp_msg.passenger_id);
+                        } else {
+                            log_message(log_queue, ROLE, ferry_id, "Granting ramp to passenger %d (VIP: %d)",
+                                        ramp_msg.passenger_id, kind == RAMP_PRIORITY_VIP);
+                            usage++;
+                        }
+                    } else if (mailbox_post(&shared_state->mailboxes, ramp_msg.mailbox, 0)) {
                         log_message(log_queue, ROLE, ferry_id, "Rejecting passenger %d - ferry full or gate closing (capacity: %d/%d, on_ramp: %d)",
                             ramp_msg.passenger_id, shared_state->ferries[ferry_id].passenger_count, 
                             ferry_capacity, usage);
-                        ramp_msg.approved = 0;
+                    } else {
+                        log_message(log_queue, ROLE, ferry_id, "Passenger %d withdrew its ramp request", ramp_msg.passenger_id);
                     }
-                    // Response to specific passenger
-                    ramp_msg.mtype = ramp_msg.pid;
-                    msgsnd(queue_ramp, &ramp_msg, MSG_SIZE(ramp_msg), 0);
                 }
             } else if (errno == ENOMSG) {
                 ramp_empty = 1;
             }
 
+            // Take back the slots of passengers who exited on the ramp. Only with the lane empty:
+            // every exit they sent has been counted by now. A passenger outliving its lease may
+            // still walk onto the ferry, so it keeps its slot and the ferry keeps waiting for it
+            if (ramp_empty && leases.held > 0) {
+                RampLease lease;
+                long long now = time_scale_now();
+                int probe = gate_close && now >= next_probe;
+
+                while (ramp_lease_reclaim(&leases, &lease) != 0) {
+                    if (lease.reclaim == RAMP_LEASE_EXPIRED) {
+                        log_message(log_queue, ROLE, ferry_id, "Passenger %d outlived its ramp lease, keeping its slot (on_ramp: %d)",
+                                    lease.passenger_id, usage);
+                        continue;
+                    }
+                    usage--;
+                    if (!gate_close && !ramp_cleanup && (ferry_capacity - shared_state->ferries[ferry_id].passenger_count) > usage) {
+                        ramp_slot_post(&lane->slots[lease.vip], 1);
+                    }
+                    log_message(log_queue, ROLE, ferry_id, "Reclaimed ramp slot of passenger %d (passenger exited, on_ramp: %d)",
+                                lease.passenger_id, usage);
+                }
+                // A closing gate waits for the ramp to empty: look for exited passengers now and then
+                if (probe) next_probe = now + RAMP_LEASE_PROBE_USEC;
+                ramp_leases_check(&leases, now, probe);
+            }
+
             // Wait until all passengers on ramp have boarded before departing
             if (gate_close && !usage && ramp_empty) {
-                struct sembuf op = {0, -1, IPC_NOWAIT};
-                while (semop(sem_ramp_slots, &op, 1) != -1 || errno == EINTR) {}
-                op.sem_num = 1;
-                while (semop(sem_ramp_slots, &op, 1) != -1 || errno == EINTR) {}
+                while (ramp_slot_trywait(&lane->slots[0]) != -1) {}
+                while (ramp_slot_trywait(&lane->slots[1]) != -1) {}
 
-                int semval_n = sem_get_val(sem_ramp_slots, 0);
-                int semval_v = sem_get_val(sem_ramp_slots, 1);
+                int semval_n = ramp_slot_value(&lane->slots[0]);
+                int semval_v = ramp_slot_value(&lane->slots[1]);
                 log_message(log_queue, ROLE, ferry_id, "Sem usage on gate close: %d and %d", semval_n, semval_v);
                 if ((semval_n + semval_v) == 0) break;
+                // A slot was opened meanwhile: take it back before sleeping
                 ramp_cleanup = 1;
+                continue;
+            }
+
+            if (ramp_empty) {
+                long long deadline = ramp_leases_next_deadline(&leases);
+                if (!gate_close && boarding_end < deadline) deadline = boarding_end;
+                if (gate_close && leases.held > 0 && next_probe < deadline) deadline = next_probe;
+                ramp_lane_wait(lane, rings, deadline);
             }
-            usleep(1000); // 1ms sleep to avoid busy waiting
         }
         log_message(log_queue, ROLE, ferry_id, "Gate closing");
-        START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
+        START_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
         log_message(log_queue, ROLE, ferry_id, "Ferry departing (final_passenger_count: %d, baggage_total: %d)",
                     shared_state->ferries[ferry_id].passenger_count,
                     shared_state->ferries[ferry_id].baggage_weight_total);
-        shared_state->current_ferry_id = -1;
-        END_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
+        docks_publish(shared_state, dock, -1);
+        END_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
 
-        START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+        START_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
         shared_state->ferries[ferry_id].status = FERRY_DEPARTED;
-        END_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+        END_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
 
         END_SEMAPHORE(sem_current_ferry, 0);
-        is_active = 0;
 
         if (!shared_state->ferries[ferry_id].passenger_count && !shared_state->port_open) {
             log_message(log_queue, ROLE, ferry_id, "Ferry departure - empty");
-            break;
+            continue;
         }
 
         // Ferry travel cycle: depart, travel to destination, and return
         // Travel
         log_message(log_queue, ROLE, ferry_id, "Ferry traveling");
-        time_t travel_start = time(NULL);
-        while ((time(NULL) - travel_start) < ferry_travel_time) {
-            sleep(1);
-            log_message(log_queue, ROLE, ferry_id, "Traveling: time left: %02d s", ferry_travel_time - (time(NULL) - travel_start));
+        for (int left = ferry_travel_time - 1; left >= 0; left--) {
+            time_scale_sleep(1000000);
+            log_message(log_queue, ROLE, ferry_id, "Traveling: time left: %02d s", left);
         }
         log_message(log_queue, ROLE, ferry_id, "Ferry returning");
-        travel_start = time(NULL);
-        while ((time(NULL) - travel_start) < ferry_travel_time) {
-            sleep(1);
-            log_message(log_queue, ROLE, ferry_id, "Returning: time left: %02d s", ferry_travel_time - (time(NULL) - travel_start));
+        for (int left = ferry_travel_time - 1; left >= 0; left--) {
+            time_scale_sleep(1000000);
+            log_message(log_queue, ROLE, ferry_id, "Returning: time left: %02d s", left);
         }
         
         // Update ferry state to indicate it's back in queue and ready for next trip
-        START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+        START_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
         
         shared_state->ferries[ferry_id].status = FERRY_WAITING_IN_QUEUE;
         had_passengers = shared_state->ferries[ferry_id].passenger_count;
         shared_state->ferries[ferry_id].passenger_count = 0;
         shared_state->ferries[ferry_id].baggage_weight_total = 0;
         
-        END_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
+        END_STATE_LOCK(shared_state, SEM_STATE_MUTEX_VARIANT_FERRIES_STATE);
         
         // Update trip statistics if ferry had passengers
         if (had_passengers > 0) {
-            START_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
-            shared_state->stats.total_ferry_trips++;
-            END_SEMAPHORE(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
+            STATS_INC(&shared_state->stats, ferry_id, total_ferry_trips);
         }
         
         log_message(log_queue, ROLE, ferry_id, "Ferry returned to queue");
+        terminal = (terminal + 1) % terminal_count;
     }
     log_message(log_queue, ROLE, ferry_id, "Ferry exiting");
-    shm_detach(shared_state);
     return 0;
 }
\ No newline at end of file
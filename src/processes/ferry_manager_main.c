@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#include "common/ipc.h"
+#include "common/ramp.h"
+#include "common/terminals.h"
+#include "processes/ferry_manager.h"
+
+// Terminals the ferry serves, whose docks a departure request wakes
+static const IpcHandles* handler_terminals = NULL;
+static int handler_terminal_count = 0;
+
+/**
+ * Signal handler for ferry manager.
+ * SIGUSR1: Triggers early departure when the ferry is active and boarding,
+ * waking it at whichever dock of whichever terminal it sleeps.
+ */
+static void handler(int signal) {
+    if (signal != SIGUSR1) return;
+    ferry_manager_notify_depart();
+    for (int terminal = 0; terminal < handler_terminal_count; terminal++) {
+        ramp_wake_ferries((SharedState*)handler_terminals[terminal].shm);
+    }
+}
+
+/**
+ * Ferry Manager Process.
+ * 
+ * Seeds the process, installs the ferry manager signal handlers and runs the ferry logic.
+ * Called in a child forked by the port manager, or after exec as a separate program.
+ * 
+ * @param terminals IPC objects of every terminal (TERMINAL_COUNT)
+ * @param ferry_id Ferry identifier
+ * @return 0 on success, 1 on error
+ */
+int ferry_manager_process(const IpcHandles* terminals, int ferry_id) {
+    struct sigaction sa;
+    srand(time(NULL) ^ getpid());
+
+    // Set before the handler is installed, and never changed afterwards
+    handler_terminals = terminals;
+    handler_terminal_count = terminals_count();
+    sa.sa_handler = handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
+        perror("[FERRY] Failed to setup signal handler SIGUSR1");
+        return 1;
+    }
+    if (sigaction(SIGUSR2, &sa, NULL) == -1) {
+        perror("[FERRY] Failed to setup signal handler SIGUSR2");
+        return 1;
+    }
+    if (sigaction(SIGINT, &sa, NULL) == -1) {
+        perror("[FERRY] Failed to setup signal handler SIGINT");
+        return 1;
+    }
+
+    return ferry_manager_run(terminals, terminals_count(), ferry_id);
+}
+
+/**
+ * Ferry Manager Program Entry Point.
+ * 
+ * Entry point of the multi-call binary when invoked as ferry-manager.
+ * Opens the IPC objects of every terminal, as the ferry serves them all.
+ * 
+ * @param argc Argument count (expects at least 3)
+ * @param argv Arguments: [0]=program name, [1]=IPC key path, [2]=ferry ID
+ */
+int ferry_manager_main(int argc, char** argv) {
+    IpcHandles terminals[TERMINAL_MAX];
+    int terminal_count = terminals_count();
+    int status;
+
+    if (argc < 3) return 1;
+    for (int i = 0; i < terminal_count; i++) {
+        if (ipc_handles_open(argv[1], i, &terminals[i]) != 0) {
+            perror("[FERRY] Failed to open IPC objects");
+            while (i-- > 0) ipc_handles_close(&terminals[i]);
+            return 1;
+        }
+    }
+
+    status = ferry_manager_process(terminals, atoi(argv[2]));
+    for (int i = 0; i < terminal_count; i++) ipc_handles_close(&terminals[i]);
+    return status;
+}
@@ -10,43 +10,166 @@
 #include "processes/main.h"
 #include "common/config.h"
 #include "common/state.h"
+#include "common/state_lock.h"
+#include "common/stats.h"
+#include "common/baggage.h"
+#include "common/ramp.h"
+#include "common/security_ring.h"
+#include "common/mailbox.h"
 #include "common/logging.h"
 #include "common/ipc.h"
+#include "common/proctitle.h"
+#include "common/arrivals.h"
+#include "common/trace.h"
+#include "common/terminals.h"
+#include "common/timescale.h"
+#include "processes/port_manager.h"
+#include "processes/passenger_generator.h"
+#include "processes/spawn.h"
+#include "processes/ferry_manager.h"
+#include "processes/passenger.h"
+#include "engine/threads.h"
+#include "engine/des.h"
+#include "engine/replications.h"
+#include "engine/sweep.h"
+#include "engine/bench.h"
 #include <stdlib.h>
 
 #include "common/macros.h"
 
+/**
+ * Removes the IPC objects of a terminal, if they exist.
+ *
+ * @param ipc_key Path used to generate IPC keys
+ * @param terminal Terminal index
+ */
+static void terminal_remove(const char* ipc_key, int terminal) {
+    int shm_id = shm_open(ipc_terminal_key(ipc_key, IPC_KEY_SHM_ID, terminal));
+    SharedState* shared_state;
+
+    // Security managers still waiting on the terminal exit once its ring is closed
+    if (shm_id != -1 && (shared_state = (SharedState*)shm_attach(shm_id)) != (void*)-1) {
+        if (shared_state_check(shared_state) == 0) security_ring_close(&shared_state->security);
+        shm_detach(shared_state);
+    }
+    shm_close_if_exists(ipc_terminal_key(ipc_key, IPC_KEY_SHM_ID, terminal));
+    sem_close_if_exists(ipc_terminal_key(ipc_key, IPC_KEY_SEM_SECURITY_ID, terminal));
+    sem_close_if_exists(ipc_terminal_key(ipc_key, IPC_KEY_SEM_RAMP_ID, terminal));
+    sem_close_if_exists(ipc_terminal_key(ipc_key, IPC_KEY_SEM_CURRENT_FERRY, terminal));
+}
+
+/**
+ * Creates the IPC objects of a terminal: its shared state (open port, ferries at its
+ * docks, statistics, ramp lanes, security ring and the state of the whole fleet) and
+ * its semaphores. Leftovers of a previous run are removed first.
+ *
+ * @param ipc_key Path used to generate IPC keys
+ * @param terminal Terminal index
+ * @param ferry_count Ferries in the fleet
+ * @param shm_id Filled with the shared state identifier
+ * @return 0 on success, -1 on error (objects created so far are removed)
+ */
+static int terminal_create(const char* ipc_key, int terminal, int ferry_count, int* shm_id) {
+    int ferry_baggage_limit_min = CONFIG_GET_INT("FERRY_BAGGAGE_LIMIT_MIN");
+    int ferry_baggage_limit_max = CONFIG_GET_INT("FERRY_BAGGAGE_LIMIT_MAX");
+    int passenger_bag_min = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MIN");
+    int passenger_bag_max = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MAX");
+    unsigned short security_init = SECURITY_STATIONS * SECURITY_STATION_CAPACITY;
+    unsigned short ramp_init = 0;
+    unsigned short current_ferry_init = CONFIG_GET_INT_OR("DOCK_COUNT", DOCK_COUNT_DEFAULT); // One permit per dock
+    SharedState* shared_state;
+
+    terminal_remove(ipc_key, terminal);
+
+    if ((*shm_id = shm_create(ipc_terminal_key(ipc_key, IPC_KEY_SHM_ID, terminal),
+                              shared_state_size(ferry_count))) == -1) {
+        perror("Failed to create shared memory");
+        goto error;
+    }
+    shared_state = (SharedState*)shm_attach(*shm_id);
+    if (shared_state == (void*)-1) {
+        perror("Failed to attach shared memory");
+        goto error;
+    }
+
+    // Initialize shared state
+    shared_state_header_init(shared_state, ferry_count);
+    if ((errno = state_locks_init(shared_state)) != 0) {
+        perror("Failed to initialize state locks");
+        shm_detach(shared_state);
+        goto error;
+    }
+    shared_state->port_open = 1;
+    shared_state->admissions = ADMISSIONS_OPEN;
+    shared_state->dock_count = current_ferry_init;
+    shared_state->docks_sequence = 0;
+    for (int dock = 0; dock < DOCK_MAX; dock++) shared_state->docked_ferry[dock] = -1;
+    stats_reset(&shared_state->stats);
+    baggage_waiters_init(&shared_state->baggage, passenger_bag_min, passenger_bag_max);
+    ramp_lanes_init(shared_state);
+    security_ring_init(&shared_state->security);
+    mailboxes_init(&shared_state->mailboxes);
+
+    // Every terminal knows the whole fleet, any ferry may dock at it
+    for (int i = 0; i < ferry_count; i++) {
+        shared_state->ferries[i].ferry_id = i;
+        shared_state->ferries[i].baggage_limit = ferry_baggage_limit_min + i * ((ferry_baggage_limit_max - ferry_baggage_limit_min) / ferry_count);
+        shared_state->ferries[i].passenger_count = 0;
+        shared_state->ferries[i].baggage_weight_total = 0;
+        shared_state->ferries[i].status = FERRY_WAITING_IN_QUEUE;
+        shared_state->ferries[i].depart_requests = 0;
+    }
+    shm_detach(shared_state);
+
+    if (sem_create(ipc_terminal_key(ipc_key, IPC_KEY_SEM_SECURITY_ID, terminal), 1, &security_init) == -1) {
+        perror("Failed to create security queue semaphore");
+        goto error;
+    }
+    if (sem_create(ipc_terminal_key(ipc_key, IPC_KEY_SEM_RAMP_ID, terminal), 1, &ramp_init) == -1) {
+        perror("Failed to create ramp semaphore");
+        goto error;
+    }
+    if (sem_create(ipc_terminal_key(ipc_key, IPC_KEY_SEM_CURRENT_FERRY, terminal), 1, &current_ferry_init) == -1) {
+        perror("Failed to create current ferry semaphore");
+        goto error;
+    }
+    return 0;
+
+error:
+    terminal_remove(ipc_key, terminal);
+    return -1;
+}
+
 int main(int argc, char **argv) {
+    char* program;
     char* bin_dir;
+    const char* spawn_mode;
+    IpcHandles terminals[TERMINAL_MAX];
+    int shm_ids[TERMINAL_MAX];
+    int terminal_count;
+    int dock_count;
     pid_t manager_pid;
     pid_t logger_pid;
-    
     key_t queue_log_key;
-    key_t queue_security_key;
-    key_t queue_ramp_key;
-    key_t shm_key;
-    key_t sem_state_mutex_key;
-    key_t sem_security_key;
-    key_t sem_ramp_key;
-    key_t sem_ramp_slots_key;
-    key_t sem_current_ferry_key;
-    
     int log_queue_id;
-    int security_queue_id;
-    int ramp_queue_id;
-    int shm_id;
-    int sem_state_mutex;
-    int sem_security;
-    int sem_ramp;
-    int sem_ramp_slots;
-    int sem_current_ferry;
-    SharedState* shared_state;
     struct sigaction sa;
+    const char* engine;
+    int threaded;
+    int status = 0;
 
     char port_manager_path[255] = "";
     char ferry_manager_path[255] = "";
     char passenger_path[255] = "";
-    char log_queue_arg[16];
+
+    // Forked roles retitle themselves, which needs the argument area to themselves
+    proctitle_init(argc, argv);
+
+    // Multi-call binary: the roles are links to it, dispatched by the name it was invoked as
+    program = basename(strdup(argv[0]));
+    if (strcmp(program, "port-manager") == 0) return port_manager_main(argc, argv);
+    if (strcmp(program, "ferry-manager") == 0) return ferry_manager_main(argc, argv);
+    if (strcmp(program, "passenger") == 0) return passenger_main(argc, argv);
+    if (strcmp(program, "passenger-generator") == 0) return passenger_generator_main(argc, argv);
 
     bin_dir = dirname(strdup(argv[0]));
     memcpy(port_manager_path, bin_dir, strlen(bin_dir));
@@ -75,6 +198,9 @@ int main(int argc, char **argv) {
 
     srand(time(NULL) ^ getpid());
 
+    // Microbenchmarks need no simulation config
+    if (getenv(BENCH_ENV)) return bench_run(getenv(BENCH_ENV));
+
     if (!getenv("PASSENGER_COUNT") || !getenv("FERRY_COUNT") || !getenv("FERRY_CAPACITY") ||
         !getenv("RAMP_CAPACITY_REG") || !getenv("RAMP_CAPACITY_VIP") || !getenv("FERRY_DEPARTURE_INTERVAL") ||
         !getenv("FERRY_TRAVEL_TIME") || !getenv("PASSENGER_SECURITY_TIME_MIN") || !getenv("PASSENGER_SECURITY_TIME_MAX") ||
@@ -85,147 +211,121 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    int ferry_count = CONFIG_GET_INT("FERRY_COUNT");
-    int ferry_baggage_limit_min = CONFIG_GET_INT("FERRY_BAGGAGE_LIMIT_MIN");
-    int ferry_baggage_limit_max = CONFIG_GET_INT("FERRY_BAGGAGE_LIMIT_MAX");
-
-    // Initialize IPC keys
-    queue_log_key = ftok(argv[0], IPC_KEY_LOG_ID);
-    queue_security_key = ftok(argv[0], IPC_KEY_QUEUE_SECURITY_ID);
-    queue_ramp_key = ftok(argv[0], IPC_KEY_QUEUE_RAMP_ID);
-    shm_key = ftok(argv[0], IPC_KEY_SHM_ID);
-    sem_state_mutex_key = ftok(argv[0], IPC_KEY_SEM_STATE_ID);
-    sem_security_key = ftok(argv[0], IPC_KEY_SEM_SECURITY_ID);
-    sem_ramp_key = ftok(argv[0], IPC_KEY_SEM_RAMP_ID);
-    sem_ramp_slots_key = ftok(argv[0], IPC_KEY_SEM_RAMP_SLOTS_ID);
-    sem_current_ferry_key = ftok(argv[0], IPC_KEY_SEM_CURRENT_FERRY);
-    
-    if (queue_log_key == -1 || shm_key == -1 || queue_security_key == -1 || queue_ramp_key == -1 ||
-        sem_state_mutex_key == -1 || sem_security_key == -1 || sem_ramp_key == -1 || 
-        sem_ramp_slots_key == -1 || sem_current_ferry_key == -1) {
-        perror("Failed to initialize IPC keys");
+    if (!arrivals_valid(getenv("ARRIVALS"))) {
+        printf("Unknown ARRIVALS: %s (expected poisson or fixed)\n", getenv("ARRIVALS"));
         return 1;
     }
-    
-    // Clean up existing IPC resources
-    queue_close_if_exists(queue_log_key);
-    queue_close_if_exists(queue_security_key);
-    queue_close_if_exists(queue_ramp_key);
 
-    shm_close_if_exists(shm_key);
+    if (getenv("TRACE")) {
+        Trace trace;
+        if (trace_open(getenv("TRACE"), &trace) != 0) {
+            printf("Cannot read TRACE: %s\n", getenv("TRACE"));
+            return 1;
+        }
+        trace_close(&trace);
+    }
 
-    sem_close_if_exists(sem_state_mutex_key);
-    sem_close_if_exists(sem_security_key);
-    sem_close_if_exists(sem_ramp_key);
-    sem_close_if_exists(sem_ramp_slots_key);
-    sem_close_if_exists(sem_current_ferry_key);
-    printf("Initializing queues\n");
-    // Create queues
-    if ((log_queue_id = queue_create(queue_log_key)) == -1) {
-        perror("Failed to create logger queue");
+    // Select the execution engine: one process per role (default), one thread per role,
+    // or discrete-event simulation in virtual time (needs no IPC objects at all)
+    engine = getenv("ENGINE");
+    terminal_count = terminals_count();
+    if (terminal_count < 1 || terminal_count > TERMINAL_MAX) {
+        printf("TERMINAL_COUNT must be between 1 and %d\n", TERMINAL_MAX);
         return 1;
     }
-    if ((security_queue_id = queue_create(queue_security_key)) == -1) {
-        perror("Failed to create security queue");
+    if (terminal_count > 1 && engine && strcmp(engine, "process") != 0) {
+        printf("TERMINAL_COUNT > 1 needs ENGINE=process\n");
         return 1;
     }
-    if ((ramp_queue_id = queue_create(queue_ramp_key)) == -1) {
-        perror("Failed to create ramp queue");
+    dock_count = CONFIG_GET_INT_OR("DOCK_COUNT", DOCK_COUNT_DEFAULT);
+    if (dock_count < 1 || dock_count > DOCK_MAX) {
+        printf("DOCK_COUNT must be between 1 and %d\n", DOCK_MAX);
         return 1;
     }
-    
-    printf("Initializing shm\n");
-    unsigned int ferry_array_size = ferry_count * sizeof(FerryState);
-    // Create shared memory
-    if ((shm_id = shm_create(shm_key, sizeof(SharedState) + ferry_array_size)) == -1) {
-        perror("Failed to create shared memory");
+    // Regular and VIP passengers leave a ramp lane through one ring of RAMP_LANE_SLOTS entries
+    if (CONFIG_GET_INT("RAMP_CAPACITY_REG") < 0 || CONFIG_GET_INT("RAMP_CAPACITY_VIP") < 0 ||
+        CONFIG_GET_INT("RAMP_CAPACITY_REG") + CONFIG_GET_INT("RAMP_CAPACITY_VIP") > RAMP_LANE_SLOTS) {
+        printf("RAMP_CAPACITY_REG + RAMP_CAPACITY_VIP must be between 0 and %d\n", RAMP_LANE_SLOTS);
         return 1;
     }
-    
-    shared_state = (SharedState*)shm_attach(shm_id);
-    if (shared_state == (void*)-1) {
-        perror("Failed to attach shared memory");
-        shm_close(shm_id);
+    if (getenv("RAMP_LEASE_TIME") && CONFIG_GET_INT("RAMP_LEASE_TIME") <= 0) {
+        printf("RAMP_LEASE_TIME must be positive\n");
         return 1;
     }
-
-    // Initialize shared state
-    shared_state->port_open = 1;
-    shared_state->current_ferry_id = -1;
-  
-    // Initialize statistics
-    shared_state->stats.passengers_spawned = 0;
-    shared_state->stats.passengers_boarded = 0;
-    shared_state->stats.passengers_rejected_baggage = 0;
-    shared_state->stats.total_ferry_trips = 0;
-    shared_state->stats.passengers_screened_passed = 0;
-    shared_state->stats.passengers_screened_rejected = 0;
-
-    for (int i = 0; i < ferry_count; i++) {
-        shared_state->ferries[i].ferry_id = i;
-        shared_state->ferries[i].baggage_limit = ferry_baggage_limit_min + i * ((ferry_baggage_limit_max - ferry_baggage_limit_min) / ferry_count);
-        shared_state->ferries[i].passenger_count = 0;
-        shared_state->ferries[i].baggage_weight_total = 0;
-        shared_state->ferries[i].status = FERRY_WAITING_IN_QUEUE;
+    if (!time_scale_valid(getenv(TIME_SCALE_ENV))) {
+        printf("TIME_SCALE must be a positive number\n");
+        return 1;
     }
-    
-    printf("Initializing semaphores\n");
-    // Create semaphores
-    unsigned short state_mutex_init[SEM_STATE_MUTEX_VARIANT_COUNT] = {1, 1, 1, 1};
-    if ((sem_state_mutex = sem_create(sem_state_mutex_key, SEM_STATE_MUTEX_VARIANT_COUNT, state_mutex_init)) == -1) {
-        perror("Failed to create state mutex semaphore");
-        shm_detach(shared_state);
-        shm_close(shm_id);
+    // Checkpoints hold the state of the discrete-event engine; live processes cannot be saved
+    if ((getenv("CHECKPOINT") || getenv("WARM_START")) && !(engine && strcmp(engine, "des") == 0)) {
+        printf("CHECKPOINT and WARM_START need ENGINE=des\n");
         return 1;
     }
-    
-    unsigned short security_init = SECURITY_STATIONS * SECURITY_STATION_CAPACITY;
-    if ((sem_security = sem_create(sem_security_key, 1, &security_init)) == -1) {
-        perror("Failed to create security queue semaphore");
-        sem_close(sem_state_mutex);
-        shm_detach(shared_state);
-        shm_close(shm_id);
+    if (getenv("CHECKPOINT") && (getenv("SWEEP") || getenv("REPLICATIONS"))) {
+        printf("CHECKPOINT saves a single run, not REPLICATIONS or SWEEP\n");
         return 1;
     }
-    
-    unsigned short ramp_init = 0;
-    if ((sem_ramp = sem_create(sem_ramp_key, 1, &ramp_init)) == -1) {
-        perror("Failed to create ramp semaphore");
-        sem_close(sem_state_mutex);
-        sem_close(sem_security);
-        shm_detach(shared_state);
-        shm_close(shm_id);
+    if (engine && strcmp(engine, "des") == 0) {
+        if (getenv("SWEEP")) return sweep_engine_run();
+        return getenv("REPLICATIONS") ? replications_engine_run() : des_engine_run();
+    }
+    threaded = engine && strcmp(engine, "threads") == 0;
+    if (engine && !threaded && strcmp(engine, "process") != 0) {
+        printf("Unknown ENGINE: %s (expected process, threads or des)\n", engine);
         return 1;
     }
-
-    unsigned short ramp_slots_init[] = {0, 0};
-    if ((sem_ramp_slots = sem_create(sem_ramp_slots_key, 2, ramp_slots_init)) == -1) {
-        perror("Failed to create ramp slots semaphore");
-        sem_close(sem_state_mutex);
-        sem_close(sem_security);
-        sem_close(sem_ramp);
-        shm_detach(shared_state);
-        shm_close(shm_id);
+    if (!ipc_transport_valid(getenv(IPC_TRANSPORT_ENV))) {
+        printf("Unknown TRANSPORT: %s (expected sysv, posix or ring)\n", getenv(IPC_TRANSPORT_ENV));
+        return 1;
+    }
+    if (threaded) {
+        // Threads share one address space: queues are always process-local
+        if (getenv(IPC_TRANSPORT_ENV)) {
+            printf("TRANSPORT needs ENGINE=process\n");
+            return 1;
+        }
+        ipc_set_backend(IPC_BACKEND_LOCAL);
+    }
+    spawn_mode = getenv("SPAWN");
+    if (spawn_mode && strcmp(spawn_mode, SPAWN_MODE_FORK) != 0 && strcmp(spawn_mode, SPAWN_MODE_EXEC) != 0) {
+        printf("Unknown SPAWN: %s (expected fork or exec)\n", spawn_mode);
         return 1;
     }
 
-    unsigned short current_ferry_init = 1;
-    if ((sem_current_ferry = sem_create(sem_current_ferry_key, 1, &current_ferry_init)) == -1) {
-        perror("Failed to create current ferry semaphore");
-        sem_close(sem_state_mutex);
-        sem_close(sem_security);
-        sem_close(sem_ramp);
-        sem_close(sem_ramp_slots);
-        shm_detach(shared_state);
-        shm_close(shm_id);
+    int ferry_count = CONFIG_GET_INT("FERRY_COUNT");
+
+    // Initialize IPC keys
+    queue_log_key = ftok(argv[0], IPC_KEY_LOG_ID);
+    if (queue_log_key == -1) {
+        perror("Failed to initialize IPC keys");
         return 1;
     }
     
-    shm_detach(shared_state);
+    // Clean up existing IPC resources
+    queue_close_if_exists(queue_log_key);
+    printf("Initializing queues (%s transport)\n", getenv(IPC_TRANSPORT_ENV) ? getenv(IPC_TRANSPORT_ENV) : "sysv");
+    // Create queues
+    if ((log_queue_id = queue_create(queue_log_key)) == -1) {
+        perror("Failed to create logger queue");
+        return 1;
+    }
     
-    // Convert log_queue_id to string for logger process
-    snprintf(log_queue_arg, sizeof(log_queue_arg), "%d", log_queue_id);
+    printf("Initializing terminals\n");
+    // Every terminal has its own queues, shared memory and semaphores
+    for (int t = 0; t < terminal_count; t++) {
+        if (terminal_create(argv[0], t, ferry_count, &shm_ids[t]) != 0) {
+            while (t-- > 0) terminal_remove(argv[0], t);
+            queue_close(log_queue_id);
+            return 1;
+        }
+    }
     
+    if (threaded) {
+        printf("Starting threaded engine\n");
+        status = threads_engine_run(argv[0], log_queue_id, shm_ids[0]);
+        goto cleanup;
+    }
+
     printf("Staring logger\n");
     // Initialize logger
     logger_pid = fork();
@@ -234,67 +334,59 @@ int main(int argc, char **argv) {
         queue_close(log_queue_id);
         return 1;
     } else if (logger_pid == 0) {
-        return logger_loop(log_queue_id, shm_id);
+        proctitle_set("logger");
+        return logger_loop(log_queue_id, shm_ids, terminal_count);
     }
 
     // Initialize port manager process
     printf("Staring port manager\n");
+    fflush(stdout);
     manager_pid = fork();
     if (manager_pid == -1) {
         perror("Manager start failed");
     } else if (manager_pid == 0) {
-        if (execl(port_manager_path, port_manager_path, argv[0], NULL) == -1) {
-            perror("Failed to start port manager");
+        if (spawn_mode && strcmp(spawn_mode, SPAWN_MODE_EXEC) == 0) {
+            if (execl(port_manager_path, port_manager_path, argv[0], NULL) == -1) {
+                perror("Failed to start port manager");
+            }
+            return 0;
         }
-        return 0;
+        // Forked without exec: the port manager and its children share this image
+        proctitle_set("port-manager");
+        for (int t = 0; t < terminal_count; t++) {
+            if (ipc_handles_open(argv[0], t, &terminals[t]) != 0) {
+                perror("Failed to open IPC objects for port manager");
+                _exit(1);
+            }
+        }
+        _exit(port_manager_run(terminals, terminal_count, argv[0]));
     }
     waitpid(manager_pid, NULL, 0);
     
-    queue_close_if_exists(queue_log_key);
+    // Every role has exited: the logger writes what is still queued, then the queue goes
+    log_end(log_queue_id);
     waitpid(logger_pid, NULL, 0);
+    queue_close_if_exists(queue_log_key);
     
+cleanup:
     // Clean up IPC resources
-    sem_close(sem_ramp);
-    sem_close(sem_ramp_slots);
-    sem_close(sem_security);
-    sem_close(sem_state_mutex);
-    sem_close(sem_current_ferry);
-    shm_close(shm_id);
-    queue_close_if_exists(queue_security_key);
-    queue_close_if_exists(queue_ramp_key);
+    for (int t = 0; t < terminal_count; t++) terminal_remove(argv[0], t);
 
-    return 0;
+    return status;
 }
 
 
-int logger_loop(int queue_id, int shm_id) {
+int logger_loop(int queue_id, const int* shm_ids, int terminal_count) {
     FILE* log_file;
     LogMessage msg;
     char time_buf[255] = "";
     int status = 0;
+    int flags = 0;
     struct tm *time;
-    struct sigaction sa;
     int termcolor = 31;
 
-    sa.sa_handler = SIG_IGN;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART;
-
-    if (sigaction(SIGINT, &sa, NULL) == -1) {
-        perror("Failed to setup signal handler");
-        return 1;
-    }
-
-    if (sigaction(SIGUSR2, &sa, NULL) == -1) {
-        perror("Failed to setup signal handler");
-        return 1;
-    }
-    
-    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
-        perror("Failed to setup signal handler");
-        return 1;
-    }
-
+    // Signal dispositions are inherited from main (ignored) in the process engine,
+    // and the threaded engine blocks them in every thread but its signal thread.
     log_file = fopen("./simulation.log", "w");
     if (!log_file) {
         return 1;
@@ -303,11 +395,19 @@ int logger_loop(int queue_id, int shm_id) {
     printf("Logger start\n");
 
     while (1) {
-        if (msgrcv(queue_id, &msg, MSG_SIZE(msg), 0, 0) == -1) {
+        if (queue_receive(queue_id, &msg, MSG_SIZE(msg), 0, flags) == -1) {
             if (errno == EINTR) continue;
+            // Past the end marker, an empty queue is the end of the log
+            if (errno == ENOMSG && (flags & IPC_NOWAIT)) break;
             status = 1;
             break;
         }
+        // Every role has exited, but a transport may deliver the marker ahead of
+        // their last lines: write whatever is still queued, without waiting for more
+        if (msg.identifier == LOG_END_IDENTIFIER) {
+            flags = IPC_NOWAIT;
+            continue;
+        }
         time = localtime(&msg.timestamp);
         strftime(time_buf, sizeof(time_buf), "(%H:%M:%S)", time);
         termcolor = 31 + ((msg.mtype-1) % 7);
@@ -322,27 +422,23 @@ int logger_loop(int queue_id, int shm_id) {
         }
     }
 
-    // Print final statistics
-    SharedState* shared_state = (SharedState*)shm_attach(shm_id);
-    if (shared_state != (void*)-1) {
-        printf("\n=== Simulation Statistics ===\n");
-        printf("Passengers spawned:                   %d\n", shared_state->stats.passengers_spawned);
-        printf("Passengers passed security:           %d\n", shared_state->stats.passengers_screened_passed);
-        printf("Passengers rejected security:         %d\n", shared_state->stats.passengers_screened_rejected);
-        printf("Passengers boarded:                   %d\n", shared_state->stats.passengers_boarded);
-        printf("Passengers rejected attempts (bag):   %d\n", shared_state->stats.passengers_rejected_baggage);
-        printf("Total ferry trips:                    %d\n", shared_state->stats.total_ferry_trips);
-        printf("=============================\n\n");
-        fprintf(log_file, "\n=== Simulation Statistics ===\n");
-        fprintf(log_file, "Passengers spawned:                   %d\n", shared_state->stats.passengers_spawned);
-        fprintf(log_file, "Passengers passed security:           %d\n", shared_state->stats.passengers_screened_passed);
-        fprintf(log_file, "Passengers rejected security:         %d\n", shared_state->stats.passengers_screened_rejected);
-        fprintf(log_file, "Passengers boarded:                   %d\n", shared_state->stats.passengers_boarded);
-        fprintf(log_file, "Passengers rejected attempts (bag):   %d\n", shared_state->stats.passengers_rejected_baggage);
-        fprintf(log_file, "Total ferry trips:                    %d\n", shared_state->stats.total_ferry_trips);
-        fprintf(log_file, "=============================\n\n");
+    // Print final statistics: one line per terminal, then the whole port
+    SimulationStats total;
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < terminal_count; t++) {
+        SharedState* shared_state = (SharedState*)shm_attach(shm_ids[t]);
+        SimulationStats stats;
+        if (shared_state == (void*)-1) continue;
+        stats_snapshot(&shared_state->stats, &stats);
+        if (terminal_count > 1) {
+            log_terminal_statistics(stdout, t, &stats);
+            log_terminal_statistics(log_file, t, &stats);
+        }
+        stats_add(&total, &stats);
         shm_detach(shared_state);
     }
+    log_statistics(stdout, &total);
+    log_statistics(log_file, &total);
 
     fflush(log_file);
     fclose(log_file);
@@ -7,165 +7,153 @@
 
 #include "common/config.h"
 #include "common/state.h"
+#include "common/state_lock.h"
+#include "common/baggage.h"
+#include "common/ramp.h"
+#include "common/security_ring.h"
+#include "common/mailbox.h"
+#include "common/stats.h"
 #include "common/ipc.h"
 #include "common/logging.h"
 #include "common/macros.h"
 #include "common/messages.h"
+#include "common/timescale.h"
 #include "processes/passenger.h"
 
 #define ROLE ROLE_PASSENGER
 
+// The port closes for a passenger through the shared flag, or by SIGUSR2 to its process
+#define PORT_CLOSED (port_closed || !shm->port_open)
 // Helper macro to exit early if port closes during passenger process
-#define PORT_CLOSED_RETURN if(port_closed) { log_message(log_queue, ROLE, passenger_id, "Port is closing, exiting the port."); return 0; }
+#define PORT_CLOSED_RETURN if(PORT_CLOSED) { log_message(log_queue, ROLE, passenger_id, "Port is closing, exiting the port."); return 0; }
 
-volatile int port_closed = 0;
+static volatile sig_atomic_t port_closed = 0;
 
 /**
- * Signal handler for passenger process.
- * SIGUSR2: Indicates the port is closing, passenger should exit gracefully.
+ * Marks the port as closing for this passenger.
+ * Async-signal-safe: called from the SIGUSR2 handler of the passenger process,
+ * and from the signal thread of the threaded engine. The port manager does not
+ * signal passengers: they see SharedState.port_open cleared when they wake.
  */
-static void handler(int signum) {
-    if (signum == SIGUSR2) port_closed = 1;
+void passenger_notify_port_closed(void) {
+    port_closed = 1;
 }
 
 /**
- * Passenger Process Entry Point.
+ * Draws passenger attributes from the configured distributions.
+ * 
+ * @param profile Filled with gender, VIP status, baggage weight and dangerous item
+ */
+void passenger_profile_random(PassengerProfile* profile) {
+    int passenger_bag_min = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MIN");
+    int passenger_bag_max = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MAX");
+
+    profile->gender = (rand() % 2) + 1;
+    profile->vip = ((rand() % 100) < CONFIG_GET_INT("VIP_CHANCE")) ? 1 : 0;
+    profile->bag_weight = passenger_bag_min + (rand() % (passenger_bag_max - passenger_bag_min + 1));
+    profile->dangerous = ((rand() % 100) < CONFIG_GET_INT("DANGEROUS_ITEM_CHANCE")) ? 1 : 0;
+}
+
+/**
+ * Passenger logic.
  * 
  * Simulates a passenger's journey through the ferry terminal:
  * 1. Check-in and generate passenger attributes (gender, VIP status, baggage weight)
- * 2. Baggage weight check against current ferry's limit
+ * 2. Baggage weight check against the limits of the docked ferries
  * 3. Security screening (gender-based station allocation)
- * 4. Board the ferry via the ramp queue (VIP priority)
+ * 4. Board the ferry via the ramp lane of the dock that accepted the bag (VIP priority)
  * 
- * The process exits when successfully boarded or if the port closes.
+ * Returns when successfully boarded or if the port closes. Passengers asleep
+ * at baggage check or for a ramp slot are woken by the closure; one queueing
+ * for a security station leaves once a screening ends. Runs either as the
+ * body of a passenger process or as a passenger thread of the threaded engine.
  * 
- * @param argc Argument count (expects at least 3)
- * @param argv Arguments: [0]=program name, [1]=IPC key path, [2]=passenger ID
+ * @param ipc Simulation IPC objects
+ * @param passenger_id Passenger identifier
+ * @param profile Passenger attributes, NULL to draw them at random
+ * @return 0 on success, 1 on error
  */
-int main(int argc, char** argv) {
-    int passenger_id;
-    int log_queue = -1;
-    int queue_security;
-    int queue_ramp;
-    int sem_state_mutex;
+int passenger_run(const IpcHandles* ipc, int passenger_id, const PassengerProfile* profile) {
+    int log_queue;
     int sem_security;
-    int sem_ramp_slots;
-    int shm_id;
+    long self_id;
+    int dock = -1;
+    int mailbox;
+    int passed;
+    int granted;
     PassengerTicket ticket;
-    SecurityMessage security_message;
-    RampMessage ramp_message;
+    SecurityRequest security_request;
+    RampEntry request;
+    RampLane* lane;
     SharedState *shm;
+    PassengerProfile drawn;
 
-    key_t log_queue_key;
-    key_t key_security;
-    key_t key_ramp;
-    key_t sem_state_mutex_key;
-    key_t sem_security_key;
-    key_t sem_ramp_slots_key;
-    key_t shm_key;
-
-    int passenger_bag_min;
-    int passenger_bag_max;
     int passenger_boarding_time;
-    int vip_chance;
-    int dangerous_item_chance;
-
-    struct sigaction sa;
-
-    if (argc < 3) return 1;
-
-    srand(time(NULL) ^ getpid());
 
-    sa.sa_handler = handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART;
-    if (sigaction(SIGUSR2, &sa, NULL) == -1) {
-        perror("Failed to setup signal handler");
-        return 1;
-    }
-    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
-        perror("Failed to setup signal handler");
-        return 1;
-    }
-    if (sigaction(SIGINT, &sa, NULL) == -1) {
-        perror("Failed to setup signal handler");
-        return 1;
-    }
-
-    passenger_bag_min = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MIN");
-    passenger_bag_max = CONFIG_GET_INT("PASSENGER_BAG_WEIGHT_MAX");
     passenger_boarding_time = CONFIG_GET_INT("PASSENGER_BOARDING_TIME");
-    dangerous_item_chance = CONFIG_GET_INT("DANGEROUS_ITEM_CHANCE");
-    vip_chance = CONFIG_GET_INT("VIP_CHANCE");
-
-    passenger_id = atoi(argv[2]);
-
-    // Initialize IPC resources: queues, semaphores, and shared memory
-    log_queue_key = ftok(argv[1], IPC_KEY_LOG_ID);
-    key_security = ftok(argv[1], IPC_KEY_QUEUE_SECURITY_ID);
-    key_ramp = ftok(argv[1], IPC_KEY_QUEUE_RAMP_ID);
-    sem_security_key = ftok(argv[1], IPC_KEY_SEM_SECURITY_ID);
-    sem_state_mutex_key = ftok(argv[1], IPC_KEY_SEM_STATE_ID);
-    sem_ramp_slots_key = ftok(argv[1], IPC_KEY_SEM_RAMP_SLOTS_ID);
-    shm_key = ftok(argv[1], IPC_KEY_SHM_ID);
-
-    if (log_queue_key != -1) {
-        log_queue = queue_open(log_queue_key);
-    }
 
-    queue_security = queue_open(key_security);
-    queue_ramp = queue_open(key_ramp);
-    sem_state_mutex = sem_open(sem_state_mutex_key, SEM_STATE_MUTEX_VARIANT_COUNT);
-    sem_security = sem_open(sem_security_key, 1);
-    sem_ramp_slots = sem_open(sem_ramp_slots_key, 2);
+    self_id = ipc_self_id();
 
-    shm_id = shm_open(shm_key);
-    shm = shm_attach(shm_id);
+    // IPC objects are opened once per process by the caller
+    log_queue = ipc->log_queue;
+    sem_security = ipc->sem_security;
+    shm = (SharedState*)ipc->shm;
 
-    if (sem_state_mutex == -1 || sem_security == -1 || log_queue == -1 || queue_ramp == -1 || sem_ramp_slots == -1) {
-        perror("Failed to init passenger");
-        return 1;
+    // Passenger attributes: gender, VIP status, and baggage weight
+    if (!profile) {
+        passenger_profile_random(&drawn);
+        profile = &drawn;
     }
-
-    // Generate passenger attributes: gender, VIP status, and baggage weight
     ticket.state = PASSENGER_CHECKIN;
-    ticket.gender = (rand() % 2) + 1;
-    ticket.vip = ((rand() % 100) < vip_chance) ? 1 : 0;
-    ticket.bag_weight = passenger_bag_min +
-                        (rand() % (passenger_bag_max - passenger_bag_min + 1));
+    ticket.gender = profile->gender;
+    ticket.vip = profile->vip;
+    ticket.bag_weight = profile->bag_weight;
 
     // log_message(log_queue, ROLE, passenger_id, "Passenger created (gender: %s, VIP: %d, bag_weight: %d)",
     //             ticket.gender == GENDER_MAN ? "MALE" : "FEMALE", ticket.vip, ticket.bag_weight);
     ticket.state = PASSENGER_BAG_CHECK;
     log_message(log_queue, ROLE, passenger_id, "At baggage check");
 
-    // Wait until a ferry arrives that accepts this passenger's baggage weight
+    // Wait until a ferry docks that accepts this passenger's baggage weight.
+    // Docks are scanned from a different one per passenger to spread them over the lanes.
     while(1) {
-        while (sem_wait_single_nointr(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY) == -1) {
-            if (errno == EINTR) { PORT_CLOSED_RETURN; continue; }
-            shm_detach(shm);
-            return 1;
+        uint32_t generation = baggage_wait_begin(shm, ticket.bag_weight);
+        int docked_limit = -1;
+        int docked[DOCK_MAX];
+        int dock_count = docks_snapshot(shm, docked);
+
+        for (int i = 0; i < dock_count; i++) {
+            int candidate = (passenger_id + i) % dock_count;
+            int ferry = docked[candidate];
+            if (ferry == -1) continue;
+            if (shm->ferries[ferry].baggage_limit >= ticket.bag_weight) {
+                dock = candidate;
+                docked_limit = shm->ferries[ferry].baggage_limit;
+                break;
+            }
+            if (shm->ferries[ferry].baggage_limit > docked_limit) docked_limit = shm->ferries[ferry].baggage_limit;
         }
-        if (shm->current_ferry_id != -1) {
-            if (shm->ferries[shm->current_ferry_id].baggage_limit >= ticket.bag_weight) {
+        if (dock != -1) {
+            if (dock_count > 1) {
+                log_message(log_queue, ROLE, passenger_id, "Baggage meets the limit (bag: %d, ferry_limit: %d, dock: %d)",
+                            ticket.bag_weight, docked_limit, dock);
+            } else {
                 log_message(log_queue, ROLE, passenger_id, "Baggage meets the limit (bag: %d, ferry_limit: %d)",
-                            ticket.bag_weight, shm->ferries[shm->current_ferry_id].baggage_limit);
-                sem_signal_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
-                break;
+                            ticket.bag_weight, docked_limit);
             }
+            break;
+        }
+        if (docked_limit != -1) {
             log_message(log_queue, ROLE, passenger_id, "BAGGAGE_REJECTED - bag: %d exceeds ferry_limit: %d",
-                        ticket.bag_weight, shm->ferries[shm->current_ferry_id].baggage_limit);
+                        ticket.bag_weight, docked_limit);
             
             // Update rejection statistics
-            sem_wait_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
-            shm->stats.passengers_rejected_baggage++;
-            sem_signal_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
+            STATS_INC(&shm->stats, passenger_id, passengers_rejected_baggage);
         }
-        sem_signal_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_CURRENT_FERRY);
         PORT_CLOSED_RETURN;
-        usleep(10000);
+        // Sleep in the bucket of the bag weight until a ferry that may take it docks
+        baggage_wait(shm, ticket.bag_weight, generation);
     }
-    shm_detach(shm);
 
     ticket.state = PASSENGER_WAITING;
     log_message(log_queue, ROLE, passenger_id, "Passed baggage check");
@@ -174,32 +162,38 @@ int main(int argc, char** argv) {
     log_message(log_queue, ROLE, passenger_id, "Waiting for security");
     PORT_CLOSED_RETURN;
     while (sem_wait_single_nointr(sem_security, 0) == -1) if (errno == EINTR) { PORT_CLOSED_RETURN }
+    // Closed while queueing for a station: hand the permit on to the next passenger leaving
+    if (PORT_CLOSED) {
+        sem_signal_single(sem_security, 0);
+        PORT_CLOSED_RETURN;
+    }
 
-    // Send security request with passenger gender (for station allocation)
-    security_message.mtype = SECURITY_MESSAGE_MANAGER_ID;
-    security_message.gender = ticket.gender;
-    security_message.pid = getpid();
-    security_message.passenger_id = passenger_id;
-    security_message.frustration = 0;
-    security_message.dangerous_weapon = ((rand() % 100) < dangerous_item_chance) ? 1 : 0;
-    while(msgsnd(queue_security, &security_message, MSG_SIZE(security_message), 0) == -1) {
-        if (errno != EINTR) {
-            log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to put messege to security queue");
-            goto cleanup;
-        }
+    // Queue security request with passenger gender (for station allocation) on the security ring;
+    // the security manager answers in the passenger's mailbox
+    if ((mailbox = mailbox_claim(&shm->mailboxes, passenger_id)) == -1) {
+        log_message(log_queue, ROLE, passenger_id, "[ERROR] No free reply mailbox");
+        sem_signal_single(sem_security, 0);
+        goto cleanup;
+    }
+    security_request.pid = self_id;
+    security_request.passenger_id = passenger_id;
+    security_request.gender = ticket.gender;
+    security_request.dangerous = profile->dangerous;
+    security_request.mailbox = mailbox;
+    if (security_ring_push(&shm->security, &security_request) == -1) {
+        log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to request security screening");
+        mailbox_release(&shm->mailboxes, mailbox);
+        sem_signal_single(sem_security, 0);
+        goto cleanup;
     }
     log_message(log_queue, ROLE, passenger_id, "Requested security station allocation (gender: %s)",
                 ticket.gender == GENDER_MAN ? "MALE" : "FEMALE");
-    // Wait for security manager to complete screening
-    while(msgrcv(queue_security, &security_message, MSG_SIZE(security_message), getpid(), 0) == -1) {
-        if (errno != EINTR) {
-            log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to get messege from security queue");
-            goto cleanup;
-        }
-    }
+    // Wait for security manager to complete screening: it answers every request taken
+    // off the ring, even while the port closes, and runs until every passenger exits
+    passed = mailbox_wait(&shm->mailboxes, mailbox, -1);
     sem_signal_single(sem_security, 0);
     PORT_CLOSED_RETURN;
-    if (security_message.dangerous_weapon) {
+    if (!passed) {
         log_message(log_queue, ROLE, passenger_id, "Passenger did not pass security.");
         return 0;
     }
@@ -208,60 +202,60 @@ int main(int argc, char** argv) {
     log_message(log_queue, ROLE, passenger_id, "Passed security, waiting to board (gender: %s)",
                 ticket.gender == GENDER_MAN ? "MALE" : "FEMALE");
 
-    // Request ramp slot: wait for available capacity (separate slots for VIP and regular)
+    // Request ramp slot on the lane of the chosen dock: wait for available capacity (separate slots for VIP and regular)
     log_message(log_queue, ROLE, passenger_id, "Waiting for ramp slot availability");
+    lane = &shm->ramps[dock];
 
 ramp_entry:
-    while(sem_wait_single_nointr_noundo(sem_ramp_slots, ticket.vip) == -1) {
-        if (errno == EINTR) { PORT_CLOSED_RETURN; continue; }
-        return 1;
+    while (ramp_slot_wait(&lane->slots[ticket.vip]) == -1) {
+        PORT_CLOSED_RETURN;
     }
 
-    // Send ramp access request to ferry manager (VIP requests have priority)
-    ramp_message.mtype = ticket.vip ? RAMP_PRIORITY_VIP : RAMP_PRIORITY_REGULAR;
-    ramp_message.pid = getpid();
-    ramp_message.passenger_id = passenger_id;
-    ramp_message.weight = ticket.bag_weight;
-    ramp_message.is_vip = ticket.vip;
-    ramp_message.approved = 0;
+    // Queue a ramp access request on the lane of the dock (VIP requests have priority);
+    // the ferry manager answers in the passenger's mailbox
+    if ((mailbox = mailbox_claim(&shm->mailboxes, passenger_id)) == -1) {
+        log_message(log_queue, ROLE, passenger_id, "[ERROR] No free reply mailbox");
+        ramp_slot_post(&lane->slots[ticket.vip], 1);
+        goto cleanup;
+    }
+    request.pid = self_id;
+    request.passenger_id = passenger_id;
+    request.weight = ticket.bag_weight;
+    request.vip = ticket.vip;
+    request.mailbox = mailbox;
+    request.boarding = 0;
 
     log_message(log_queue, ROLE, passenger_id, "Requesting ramp access (VIP: %d)", ticket.vip);
-    while(msgsnd(queue_ramp, &ramp_message, MSG_SIZE(ramp_message), 0) == -1) {
-        if (errno != EINTR) {
-            log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to request ramp access");
-            sem_signal_single_noundo(sem_ramp_slots, ticket.vip);
-            perror("Passenger ramp send error");
-            goto cleanup;
-        }
+    if (ramp_send(lane, &lane->requests[ticket.vip], &request) == -1) {
+        log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to request ramp access");
+        mailbox_release(&shm->mailboxes, mailbox);
+        ramp_slot_post(&lane->slots[ticket.vip], 1);
+        goto cleanup;
     }
 
-    // Wait for permission from ramp manager
-    while(msgrcv(queue_ramp, &ramp_message, MSG_SIZE(ramp_message), getpid(), 0) == -1) {
-        if (errno != EINTR) {
-            log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to receive ramp permission");
-            perror("Passenger ramp rcv error");
-            sem_signal_single_noundo(sem_ramp_slots, ticket.vip);
-            goto cleanup;
+    // Wait for permission from ramp manager. A request left after its ferry departed is answered
+    // by the next ferry at the dock; once the port closes none may come, so it is withdrawn
+    while ((granted = mailbox_wait(&shm->mailboxes, mailbox, RAMP_WAIT_TIMEOUT_MS)) == -1) {
+        if (shm->port_open) continue;
+        if ((granted = mailbox_withdraw(&shm->mailboxes, mailbox)) == -1) {
+            log_message(log_queue, ROLE, passenger_id, "Withdrew ramp request, no ferry answered before the port closed");
+            PORT_CLOSED_RETURN;
         }
+        break;
     }
-
-    if (!ramp_message.approved) goto ramp_entry;
+    if (!granted) goto ramp_entry;
 
     log_message(log_queue, ROLE, passenger_id, "Boarding ferry");
 
     // Simulate time taken to walk onto the ferry
-    usleep(passenger_boarding_time);
-
-    // Notify ferry manager that passenger has completed boarding and left ramp
-    ramp_message.mtype = RAMP_MESSAGE_EXIT;
-    ramp_message.pid = getpid();
-    ramp_message.passenger_id = passenger_id;
-    while(msgsnd(queue_ramp, &ramp_message, MSG_SIZE(ramp_message), 0) == -1) {
-        if (errno != EINTR) {
-            log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to signal ramp exit");
-            perror("Passenger ramp exit error");
-            goto cleanup;
-        }
+    time_scale_sleep(passenger_boarding_time);
+
+    // Notify ferry manager that passenger has completed boarding and left ramp,
+    // naming the boarding that let it on
+    request.boarding = granted;
+    if (ramp_send(lane, &lane->exits, &request) == -1) {
+        log_message(log_queue, ROLE, passenger_id, "[ERROR] Failed to signal ramp exit");
+        goto cleanup;
     }
 
     ticket.state = PASSENGER_BOARDED;
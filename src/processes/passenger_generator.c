@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <libgen.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include "common/config.h"
+#include "common/state.h"
+#include "common/stats.h"
+#include "common/ipc.h"
+#include "common/logging.h"
+#include "common/arrivals.h"
+#include "common/trace.h"
+#include "common/terminals.h"
+#include "common/timescale.h"
+#include "processes/passenger.h"
+#include "processes/passenger_generator.h"
+#include "processes/spawn.h"
+
+#define ROLE ROLE_PASSENGER_GENERATOR
+
+typedef struct RecentPassenger {
+    pid_t pid;
+    long long spawned_at;      // us
+} RecentPassenger;
+
+static volatile sig_atomic_t port_closed = 0;
+
+// Replayed profile of the passenger being spawned, inherited by the forked child
+static PassengerProfile next_profile;
+static int next_profile_set = 0;
+
+/**
+ * Signal handler for the passenger generator.
+ * SIGUSR2: The port is closing, no more passengers are released.
+ */
+static void handle_signal(int signal) {
+    if (signal == SIGUSR2) port_closed = 1;
+}
+
+static long long monotonic_usec(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * Reaps exited passengers.
+ * 
+ * @param block Wait until at least one passenger exits
+ * @param live Number of live passengers, decremented for every passenger reaped
+ */
+static void reap_passengers(int block, int* live) {
+    pid_t pid;
+
+    while (*live > 0) {
+        pid = waitpid(-1, NULL, block ? 0 : WNOHANG);
+        if (pid > 0) {
+            (*live)--;
+            block = 0;
+            continue;
+        }
+        // No children left to wait for, whatever the count says
+        if (pid == -1 && errno == ECHILD) *live = 0;
+        break;
+    }
+}
+
+/**
+ * Logs passenger memory from recently spawned passengers that had time to settle.
+ * 
+ * @return 1 if the report was logged, 0 if no passenger could be sampled yet
+ */
+static int report_memory(int log_queue, const RecentPassenger* recent, long long now, const char* spawn_mode) {
+    pid_t pids[SPAWN_MEMORY_SAMPLES];
+    int count = 0;
+
+    for (int i = 0; i < SPAWN_MEMORY_SAMPLES; i++) {
+        if (recent[i].pid > 0 && now - recent[i].spawned_at >= PASSENGER_GENERATOR_SETTLE_TIME) {
+            pids[count++] = recent[i].pid;
+        }
+    }
+    return spawn_report_memory(log_queue, ROLE, pids, count, spawn_mode) > 0;
+}
+
+static int generator_passenger_process(const IpcHandles* ipc, int passenger_id) {
+    return passenger_process(ipc, passenger_id, next_profile_set ? &next_profile : NULL);
+}
+
+/**
+ * Passenger Generator Process.
+ * 
+ * Releases PASSENGER_COUNT passengers into the port following the arrival
+ * process (ARRIVALS, ARRIVAL_INTERVAL) instead of all at once, keeping at most
+ * MAX_LIVE_PASSENGERS passenger processes alive (0 = unlimited). With TRACE set,
+ * passengers are replayed from the trace instead: each one is released at its
+ * recorded time with its recorded attributes, up to PASSENGER_COUNT of them.
+ * Stops releasing passengers when the port closes or drains, then waits for
+ * the released ones to exit. While the port manager pauses arrivals, nobody
+ * is released and the arrival clock stops.
+ * 
+ * With several terminals there is one generator per terminal. Each releases its
+ * share of PASSENGER_COUNT, with its own block of passenger ids, and replays
+ * every TERMINAL_COUNT-th record of the trace.
+ * 
+ * @param ipc IPC objects of the generator's terminal
+ * @param ipc_key IPC key path, also used to derive the path of exec'd passengers
+ * @return 0 on success, 1 on error
+ */
+int passenger_generator_run(const IpcHandles* ipc, const char* ipc_key) {
+    SharedState* shared_state = (SharedState*)ipc->shm;
+    int log_queue = ipc->log_queue;
+    RecentPassenger recent[SPAWN_MEMORY_SAMPLES];
+    ArrivalConfig arrivals;
+    Trace trace;
+    TraceEntry entry;
+    const char* trace_path = getenv("TRACE");
+    char profile_arg[64];
+    struct sigaction sa;
+    const char* spawn_mode;
+    int exec_mode;
+    char passenger_path[255];
+    int passenger_count;
+    int first_id;
+    int terminal_count = terminals_count();
+    int log_id = terminal_count > 1 ? ipc->terminal : -1;
+    long record = 0;
+    int max_live;
+    int spawned = 0;
+    int live = 0;
+    int peak_live = 0;
+    int memory_reported = 0;
+    long long start;
+    long long next_arrival;
+    long long now;
+    double spawn_time;
+
+    srand(time(NULL) ^ getpid());
+
+    // No SA_RESTART: closing the port interrupts the wait for a free passenger slot
+    sa.sa_handler = handle_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    if (sigaction(SIGUSR2, &sa, NULL) == -1) {
+        perror("Passenger generator: Failed to register SIGUSR2");
+    }
+    // SIGINT and SIGUSR1 are handled by the port manager and the ferries
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+
+    terminals_share(CONFIG_GET_INT("PASSENGER_COUNT"), terminal_count, ipc->terminal, &first_id, &passenger_count);
+    max_live = CONFIG_GET_INT_OR("MAX_LIVE_PASSENGERS", 0);
+    if (max_live < 0) max_live = 0;
+    arrivals_load(&arrivals);
+    spawn_mode = getenv("SPAWN") ? getenv("SPAWN") : SPAWN_MODE_FORK;
+    exec_mode = strcmp(spawn_mode, SPAWN_MODE_EXEC) == 0;
+    snprintf(passenger_path, sizeof(passenger_path), "%s/passenger", dirname(strdup(ipc_key)));
+    memset(recent, 0, sizeof(recent));
+    if (trace_path && trace_open(trace_path, &trace) != 0) {
+        log_message(log_queue, ROLE, log_id, "[ERROR] Failed to open trace %s", trace_path);
+        return 1;
+    }
+
+    if (trace_path) {
+        log_message(log_queue, ROLE, log_id, "Passenger generator starting up (replaying %s, at most %d live, 0 = unlimited)",
+                    trace_path, max_live);
+    } else {
+        log_message(log_queue, ROLE, log_id, "Passenger generator starting up (%s arrivals, mean gap %d ms, at most %d live, 0 = unlimited)",
+                    arrivals.process == ARRIVAL_PROCESS_FIXED ? ARRIVALS_FIXED : ARRIVALS_POISSON, arrivals.interval, max_live);
+    }
+
+    // Flushed now so forked passengers do not write it again
+    fflush(stdout);
+    fflush(stderr);
+
+    start = monotonic_usec();
+    next_arrival = start;
+    while (spawned < passenger_count && !port_closed && shared_state->port_open &&
+           shared_state->admissions != ADMISSIONS_DRAINING) {
+        // Paused by the port manager: the arrival clock stops until arrivals resume
+        if (shared_state->admissions == ADMISSIONS_PAUSED) {
+            long long paused_at = monotonic_usec();
+
+            log_message(log_queue, ROLE, log_id, "Arrivals paused after %d passengers", spawned);
+            while (shared_state->admissions == ADMISSIONS_PAUSED && shared_state->port_open && !port_closed) {
+                reap_passengers(0, &live);
+                usleep(PASSENGER_GENERATOR_POLL_INTERVAL);
+            }
+            now = monotonic_usec();
+            start += now - paused_at;
+            next_arrival += now - paused_at;
+            if (shared_state->admissions == ADMISSIONS_OPEN) log_message(log_queue, ROLE, log_id, "Arrivals resumed");
+            continue;
+        }
+        // The next recorded passenger arrives at its offset from the first one
+        if (trace_path && !next_profile_set) {
+            int status = trace_next(&trace, &entry);
+            if (status != 1) {
+                if (status == -1) log_message(log_queue, ROLE, log_id, "[ERROR] Malformed trace record %ld, replay stopped", trace.line);
+                break;
+            }
+            // Records are dealt to the terminals round-robin
+            if (record++ % terminal_count != ipc->terminal) continue;
+            next_profile.gender = entry.gender;
+            next_profile.vip = entry.vip;
+            next_profile.bag_weight = entry.bag_weight;
+            next_profile.dangerous = entry.dangerous;
+            next_profile_set = 1;
+            next_arrival = start + time_scale_wall_usec(entry.arrival * 1000);
+        }
+
+        now = monotonic_usec();
+        if (!memory_reported && now - start >= PASSENGER_GENERATOR_MEMORY_DELAY) {
+            memory_reported = report_memory(log_queue, recent, now, spawn_mode);
+        }
+
+        // Bounded concurrency: wait for a passenger to leave before releasing the next one
+        if (max_live > 0 && live >= max_live) {
+            reap_passengers(1, &live);
+            continue;
+        }
+        if (now < next_arrival) {
+            reap_passengers(0, &live);
+            arrivals_sleep(next_arrival - now < PASSENGER_GENERATOR_POLL_INTERVAL ? next_arrival - now : PASSENGER_GENERATOR_POLL_INTERVAL);
+            continue;
+        }
+
+        if (next_profile_set) {
+            snprintf(profile_arg, sizeof(profile_arg), PASSENGER_PROFILE_FORMAT, next_profile.gender,
+                     next_profile.vip, next_profile.bag_weight, next_profile.dangerous);
+        }
+        pid_t pid = spawn_role(exec_mode, passenger_path, ipc_key, ipc, generator_passenger_process, "passenger",
+                               first_id + spawned, next_profile_set ? profile_arg : NULL);
+        if (pid == -1) {
+            perror("Failed to spawn passenger");
+            // Out of processes: wait for a passenger to exit and retry, or give up if none are running
+            if (live == 0) break;
+            reap_passengers(1, &live);
+            continue;
+        }
+        recent[spawned % SPAWN_MEMORY_SAMPLES].pid = pid;
+        recent[spawned % SPAWN_MEMORY_SAMPLES].spawned_at = now;
+        spawned++;
+        if (++live > peak_live) peak_live = live;
+
+        STATS_INC(&shared_state->stats, 0, passengers_spawned);
+
+        next_profile_set = 0;
+        if (!trace_path) next_arrival += time_scale_wall_usec(arrivals_next_gap(&arrivals, rand() / (RAND_MAX + 1.0)));
+    }
+
+    spawn_time = (monotonic_usec() - start) / 1e6;
+    log_message(log_queue, ROLE, log_id, "Spawned %d passengers in %.3f s (%.0f passengers/s, peak %d live, SPAWN=%s)",
+                spawned, spawn_time, spawn_time > 0 ? spawned / spawn_time : 0, peak_live, spawn_mode);
+    if (trace_path) {
+        log_message(log_queue, ROLE, log_id, "Replayed %d passengers from %s", spawned, trace_path);
+        trace_close(&trace);
+    }
+    if (spawned < passenger_count && (port_closed || !shared_state->port_open)) {
+        log_message(log_queue, ROLE, log_id, "Port closed, %d passengers never arrived", passenger_count - spawned);
+    } else if (spawned < passenger_count && shared_state->admissions == ADMISSIONS_DRAINING) {
+        log_message(log_queue, ROLE, log_id, "Port draining, %d passengers never arrived", passenger_count - spawned);
+    }
+
+    // Wait for the released passengers to board or leave
+    while (live > 0) {
+        now = monotonic_usec();
+        if (!memory_reported && now - start >= PASSENGER_GENERATOR_MEMORY_DELAY) {
+            memory_reported = report_memory(log_queue, recent, now, spawn_mode);
+        }
+        reap_passengers(0, &live);
+        if (live > 0) usleep(PASSENGER_GENERATOR_POLL_INTERVAL);
+    }
+
+    log_message(log_queue, ROLE, log_id, "Passenger generator exiting");
+    return 0;
+}
+
+/**
+ * Passenger Generator Program Entry Point.
+ * 
+ * Entry point of the multi-call binary when invoked as passenger-generator (SPAWN=exec).
+ * The terminal is passed by the port manager through TERMINAL_ENV.
+ * 
+ * @param argc Argument count (expects at least 2)
+ * @param argv Arguments: [0]=program name, [1]=IPC key path
+ */
+int passenger_generator_main(int argc, char** argv) {
+    IpcHandles ipc;
+    int status;
+
+    if (argc < 2) return 1;
+    if (ipc_handles_open(argv[1], terminals_current(), &ipc) != 0) {
+        perror("Passenger generator: Failed to open IPC objects");
+        return 1;
+    }
+
+    status = passenger_generator_run(&ipc, argv[1]);
+    ipc_handles_close(&ipc);
+    return status;
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+
+#include "common/ipc.h"
+#include "common/terminals.h"
+#include "processes/passenger.h"
+
+/**
+ * Signal handler for passenger process.
+ * SIGUSR2: Indicates the port is closing, passenger should exit gracefully.
+ */
+static void handler(int signum) {
+    if (signum == SIGUSR2) passenger_notify_port_closed();
+}
+
+/**
+ * Passenger Process.
+ * 
+ * Seeds the process, installs the passenger signal handlers and runs the passenger logic.
+ * Called in a child forked by the port manager, or after exec as a separate program.
+ * 
+ * @param ipc Simulation IPC objects
+ * @param passenger_id Passenger identifier
+ * @param profile Passenger attributes, NULL to draw them at random
+ * @return 0 on success, 1 on error
+ */
+int passenger_process(const IpcHandles* ipc, int passenger_id, const PassengerProfile* profile) {
+    struct sigaction sa;
+
+    srand(time(NULL) ^ getpid());
+
+    sa.sa_handler = handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR2, &sa, NULL) == -1) {
+        perror("Failed to setup signal handler");
+        return 1;
+    }
+    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
+        perror("Failed to setup signal handler");
+        return 1;
+    }
+    if (sigaction(SIGINT, &sa, NULL) == -1) {
+        perror("Failed to setup signal handler");
+        return 1;
+    }
+
+    return passenger_run(ipc, passenger_id, profile);
+}
+
+/**
+ * Passenger Program Entry Point.
+ * 
+ * Entry point of the multi-call binary when invoked as passenger.
+ * The terminal is inherited from the passenger generator through TERMINAL_ENV.
+ * 
+ * @param argc Argument count (expects at least 3)
+ * @param argv Arguments: [0]=program name, [1]=IPC key path, [2]=passenger ID,
+ *             [3]=optional profile (PASSENGER_PROFILE_FORMAT) replayed from a trace
+ */
+int passenger_main(int argc, char** argv) {
+    IpcHandles ipc;
+    PassengerProfile profile;
+    int gender;
+    int has_profile;
+    int status;
+
+    if (argc < 3) return 1;
+    has_profile = argc > 3 && sscanf(argv[3], PASSENGER_PROFILE_FORMAT, &gender, &profile.vip,
+                                     &profile.bag_weight, &profile.dangerous) == 4;
+    if (has_profile) profile.gender = gender;
+    if (ipc_handles_open(argv[1], terminals_current(), &ipc) != 0) {
+        perror("Failed to init passenger");
+        return 1;
+    }
+
+    status = passenger_process(&ipc, atoi(argv[2]), has_profile ? &profile : NULL);
+    ipc_handles_close(&ipc);
+    return status;
+}
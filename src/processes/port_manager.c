@@ -6,69 +6,290 @@
 #include <errno.h>
 #include <time.h>
 #include <stdlib.h>
+#include <poll.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 
 #include "common/config.h"
 #include "common/state.h"
+#include "common/state_lock.h"
+#include "common/baggage.h"
+#include "common/ramp.h"
+#include "common/security_ring.h"
+#include "common/mailbox.h"
+#include "common/control.h"
 #include "common/ipc.h"
 #include "common/logging.h"
 #include "common/messages.h"
 #include "common/macros.h"
+#include "common/proctitle.h"
+#include "common/terminals.h"
 #include "processes/port_manager.h"
+#include "processes/ferry_manager.h"
+#include "processes/passenger_generator.h"
+#include "processes/spawn.h"
 
 #define ROLE ROLE_PORT_MANAGER
 
-int sem_state_mutex;
-SharedState* shared_state;
+static const IpcHandles* port_terminals;
+static int port_terminal_count;
+// When close-port reached each terminal, to log how long its passengers took to leave
+static struct timespec port_closed_at[TERMINAL_MAX];
+static int port_closed_by_command[TERMINAL_MAX];
+// Times the supervision loop woke up, for the final report
+static int port_wakeups;
 
-int ferry_count;
-int passenger_count;
-int passenger_security_time_min;
-int passenger_security_time_max;
+/**
+ * Closes a terminal without signalling anyone. Passengers asleep at baggage
+ * check or for a ramp slot are woken. Passengers queueing for a security
+ * station get PORT_CLOSE_SECURITY_PERMITS extra permits, each handed straight
+ * back by the passenger leaving with it, so the queue empties at once instead
+ * of one screening at a time. Every other passenger and the ferries boarding
+ * there see port_open cleared the next time they look.
+ * Async-signal-safe.
+ *
+ * @param terminal IPC objects of the terminal
+ */
+static void port_close_terminal(const IpcHandles* terminal) {
+    SharedState* state = (SharedState*)terminal->shm;
+
+    if (!__atomic_exchange_n(&state->port_open, 0, __ATOMIC_SEQ_CST)) return;
+    baggage_wake_all(state);
+    ramp_wake_all(state);
+    sem_signal_noundo(terminal->sem_security, 0, PORT_CLOSE_SECURITY_PERMITS);
+}
 
 /**
  * Signal handler for port manager.
- * SIGINT: Initiates graceful shutdown by notifying all processes and closing the port.
+ * SIGINT: Initiates graceful shutdown by closing every terminal.
  */
 static void handle_signal(int signal) {
     if (signal == SIGINT) {
-        kill(0, SIGUSR2);
-        kill(0, SIGUSR1);
-        if (shared_state) shared_state->port_open = 0;
+        for (int i = 0; i < port_terminal_count; i++) port_close_terminal(&port_terminals[i]);
+    }
+}
+
+/**
+ * Carries out a command from the control channel. Only the roles it concerns
+ * notice it: depart-now touches the record of the ferry, the other commands
+ * the flags of the terminal its passenger generator and passengers read.
+ *
+ * @param request Command
+ * @param terminals IPC objects of every terminal
+ * @param terminal_count Number of terminals
+ * @param ferry_count Ferries in the fleet
+ */
+static void port_control_apply(const ControlRequest* request, const IpcHandles* terminals, int terminal_count, int ferry_count) {
+    int log_queue = terminals[0].log_queue;
+    int limit = request->command == CONTROL_DEPART_NOW ? ferry_count : terminal_count;
+
+    if (request->target >= limit) {
+        log_message(log_queue, ROLE, -1, "Ignoring control command \"%s\": no %s %d", request->line,
+                    request->command == CONTROL_DEPART_NOW ? "ferry" : "terminal", request->target);
+        return;
+    }
+    log_message(log_queue, ROLE, -1, "Control command: %s", request->line);
+    for (int t = 0; t < terminal_count; t++) {
+        SharedState* shared_state = (SharedState*)terminals[t].shm;
+
+        if (request->command == CONTROL_DEPART_NOW) {
+            // Only a ferry boarding at this terminal reads its record here, woken at its dock
+            for (int i = 0; i < ferry_count; i++) {
+                if (request->target == -1 || request->target == i) {
+                    __atomic_fetch_add(&shared_state->ferries[i].depart_requests, 1, __ATOMIC_SEQ_CST);
+                }
+            }
+            ramp_wake_ferries(shared_state);
+            continue;
+        }
+        if (request->target != -1 && request->target != t) continue;
+        if (request->command == CONTROL_CLOSE_PORT) {
+            if (!shared_state->port_open) continue;
+            clock_gettime(CLOCK_MONOTONIC, &port_closed_at[t]);
+            port_closed_by_command[t] = 1;
+            port_close_terminal(&terminals[t]);
+        } else if (request->command == CONTROL_DRAIN) {
+            __atomic_store_n(&shared_state->admissions, ADMISSIONS_DRAINING, __ATOMIC_RELAXED);
+        } else if (request->command == CONTROL_PAUSE) {
+            if (shared_state->admissions == ADMISSIONS_OPEN) __atomic_store_n(&shared_state->admissions, ADMISSIONS_PAUSED, __ATOMIC_RELAXED);
+        } else if (shared_state->admissions == ADMISSIONS_PAUSED) {
+            __atomic_store_n(&shared_state->admissions, ADMISSIONS_OPEN, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Carries out every command waiting on the control channel.
+ *
+ * @param channel Control channel
+ * @param terminals IPC objects of every terminal
+ * @param terminal_count Number of terminals
+ * @param ferry_count Ferries in the fleet
+ */
+static void port_control_serve(ControlChannel* channel, const IpcHandles* terminals, int terminal_count, int ferry_count) {
+    ControlRequest request;
+    int status;
+
+    while ((status = control_receive(channel, &request)) != 0) {
+        if (status == -1) {
+            log_message(terminals[0].log_queue, ROLE, -1, "Ignoring control command \"%s\": unknown", request.line);
+            continue;
+        }
+        port_control_apply(&request, terminals, terminal_count, ferry_count);
+    }
+}
+
+/**
+ * Files a child the port manager has just forked.
+ *
+ * @param child Record of the child
+ * @param pid Process id of the child
+ * @param role Role the child runs
+ * @param index Ferry id, or terminal of a security manager or generator
+ */
+static void port_child_file(PortChild* child, pid_t pid, Role role, int index) {
+    child->pid = pid;
+    child->pidfd = -1;
+    child->role = role;
+    child->index = index;
+    child->reaped = 0;
+    child->status = 0;
+    child->ended = (struct timespec){ 0, 0 };
+    clock_gettime(CLOCK_MONOTONIC, &child->started);
+}
+
+/**
+ * Sleeps until a child exits or a command comes on the control channel,
+ * then serves every command waiting and reaps at most one child. Each child
+ * has the poll slot after the channel's matching its record, so an exit is
+ * traced back to its role without searching. Children without a pidfd are
+ * looked at every PORT_MANAGER_POLL_MS instead.
+ *
+ * @param children Children of the port manager
+ * @param child_count Number of children
+ * @param channel Control channel, closed ones are left out
+ * @param terminals IPC objects of every terminal
+ * @param terminal_count Number of terminals
+ * @param ferry_count Ferries in the fleet
+ * @return The child reaped, NULL if none exited
+ */
+static PortChild* port_supervise(PortChild* children, int child_count, ControlChannel* channel,
+                                 const IpcHandles* terminals, int terminal_count, int ferry_count) {
+    struct pollfd ready[child_count + 1];
+    int timeout_ms = -1;
+
+    ready[0].fd = channel->fd;
+    ready[0].events = POLLIN;
+    for (int i = 0; i < child_count; i++) {
+        ready[i + 1].fd = children[i].reaped ? -1 : children[i].pidfd;
+        ready[i + 1].events = POLLIN;
+        if (!children[i].reaped && children[i].pidfd == -1) timeout_ms = PORT_MANAGER_POLL_MS;
+    }
+    // Interrupted by SIGINT or SIGUSR2: the handler closed the port, the caller looks again
+    if (poll(ready, child_count + 1, timeout_ms) == -1) return NULL;
+    port_wakeups++;
+
+    if (ready[0].fd != -1 && ready[0].revents) port_control_serve(channel, terminals, terminal_count, ferry_count);
+    for (int i = 0; i < child_count; i++) {
+        PortChild* child = &children[i];
+
+        if (child->reaped || (child->pidfd != -1 && !ready[i + 1].revents)) continue;
+        if (waitpid(child->pid, &child->status, WNOHANG) != child->pid) continue;
+        clock_gettime(CLOCK_MONOTONIC, &child->ended);
+        child->reaped = 1;
+        if (child->pidfd != -1) close(child->pidfd);
+        child->pidfd = -1;
+        return child;
     }
+    return NULL;
 }
 
 /**
- * Port Manager Process Entry Point.
+ * Logs how every child of the port manager ended and how long it ran,
+ * followed by a summary of the supervision.
+ *
+ * @param log_queue Log queue
+ * @param children Children of the port manager
+ * @param child_count Number of children
+ * @param started When the port manager started
+ */
+static void port_children_report(int log_queue, const PortChild* children, int child_count, struct timespec started) {
+    struct timespec now;
+    int abnormal = 0;
+
+    for (int i = 0; i < child_count; i++) {
+        const PortChild* child = &children[i];
+        const char* title = child->role == ROLE_FERRY_MANAGER ? "ferry-manager" :
+                            child->role == ROLE_SECURITY_MANAGER ? "security-manager" : "passenger-generator";
+        double lifetime;
+
+        if (!child->reaped) {
+            log_message(log_queue, ROLE, -1, "Child %s %d (pid %d) still running", title, child->index, child->pid);
+            abnormal++;
+            continue;
+        }
+        // Only a reaped child has an end time
+        lifetime = TIMESPEC_DIFF(child->started, child->ended);
+        if (WIFSIGNALED(child->status)) {
+            log_message(log_queue, ROLE, -1, "Child %s %d (pid %d) killed by signal %d (%s) after %.3f s",
+                        title, child->index, child->pid, WTERMSIG(child->status), strsignal(WTERMSIG(child->status)), lifetime);
+            abnormal++;
+        } else {
+            log_message(log_queue, ROLE, -1, "Child %s %d (pid %d) exited with status %d after %.3f s",
+                        title, child->index, child->pid, WEXITSTATUS(child->status), lifetime);
+            if (WEXITSTATUS(child->status) != 0) abnormal++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    log_message(log_queue, ROLE, -1, "Supervised %d children for %.3f s: %d exited cleanly, %d abnormally, %d wakeups",
+                child_count, TIMESPEC_DIFF(started, now), child_count - abnormal, abnormal, port_wakeups);
+}
+
+/**
+ * Port Manager Process.
  * 
  * Main orchestrator for the ferry simulation:
- * 1. Initializes IPC resources (shared memory, semaphores, message queues)
- * 2. Spawns all ferry managers and passenger processes
- * 3. Spawns security manager for passenger screening
- * 4. Monitors process completion and manages graceful shutdown
+ * 1. Uses the IPC resources created by the main process
+ * 2. Spawns all ferry managers and one passenger generator per terminal
+ * 3. Spawns one security manager per terminal for passenger screening
+ * 4. Reaps children as their pidfds report them exited, and manages graceful shutdown
  * 
  * Responsible for:
  * - Process lifecycle management
- * - Coordinating port closure when all passengers have boarded
- * - Ensuring all child processes terminate properly
+ * - Coordinating closure of each terminal when all its passengers have boarded
+ * - Serving the control channel: depart-now, close-port, drain, pause, resume
+ * - Ensuring all child processes terminate properly, and reporting how each one ended
  * 
- * @param argc Argument count (expects at least 2)
- * @param argv Arguments: [0]=program path (used to derive child process paths), [1]=IPC key path
+ * Nobody is notified by signal: closing a terminal clears its port_open and
+ * wakes the passengers asleep on it, depart-now bumps the record of a ferry,
+ * and the passenger generator reads the admissions of its terminal.
+ * 
+ * Children are forked without exec unless SPAWN=exec. With several terminals,
+ * the security manager and passenger generator of each terminal (and so its
+ * passengers) are pinned to the terminal's CPUs, so terminals run in parallel.
+ * Ferries are shared by all terminals and not pinned.
+ * 
+ * @param terminals IPC objects of every terminal
+ * @param terminal_count Number of terminals
+ * @param ipc_key IPC key path, also used to derive the paths of exec'd roles
+ * @return 0 on success, 1 on error
  */
-int main(int argc, char** argv) {
-    key_t logger_key;
-    key_t shm_key;
-    key_t sem_state_mutex_key;
-    key_t sem_ramp_key;
-
-    int log_queue = -1;
-    int shm_id;
-    int sem_ramp;
+int port_manager_run(const IpcHandles* terminals, int terminal_count, const char* ipc_key) {
+    int log_queue;
     struct sigaction sa;
-
-    if (argc < 2) return 1;
+    const char* spawn_mode;
+    int exec_mode;
+    int ferry_count;
+    const char* control_path;
+    ControlChannel control;
+    struct timespec started;
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
     srand(time(NULL) ^ getpid());
 
+    port_terminals = terminals;
+    port_terminal_count = terminal_count;
+
     sa.sa_handler = handle_signal;
     sigemptyset(&sa.sa_mask);
     sa.sa_flags = SA_RESTART;
@@ -80,362 +301,206 @@ int main(int argc, char** argv) {
         perror("PORTMANAGER Failed to register SIGUSR2");
     }
 
-    // Initialize IPC resources: message queues, shared memory, and semaphores
-    logger_key = ftok(argv[1], IPC_KEY_LOG_ID);
-    shm_key = ftok(argv[1], IPC_KEY_SHM_ID);
-    sem_state_mutex_key = ftok(argv[1], IPC_KEY_SEM_STATE_ID);
-    sem_ramp_key = ftok(argv[1], IPC_KEY_SEM_RAMP_ID);
-
-    if (logger_key != -1) {
-        log_queue = queue_open(logger_key);
-    }
-
-    shm_id = shm_open(shm_key);
-    if (shm_id == -1) {
-        perror("Port manager: Failed to open shared memory");
-        return 1;
-    }
-
-    shared_state = (SharedState*)shm_attach(shm_id);
-    if (shared_state == (void*)-1) {
-        perror("Port manager: Failed to attach shared memory");
-        return 1;
-    }
-
-    sem_state_mutex = sem_open(sem_state_mutex_key, 1);
-    sem_ramp = sem_open(sem_ramp_key, 1);
-
-    if (sem_state_mutex == -1 || sem_ramp == -1) {
-        perror("Port manager: Failed to open semaphores");
-        shm_detach(shared_state);
-        return 1;
-    }
+    log_queue = terminals[0].log_queue;
 
     ferry_count = CONFIG_GET_INT("FERRY_COUNT");
-    passenger_count = CONFIG_GET_INT("PASSENGER_COUNT");
-    passenger_security_time_min = CONFIG_GET_INT("PASSENGER_SECURITY_TIME_MIN");
-    passenger_security_time_max = CONFIG_GET_INT("PASSENGER_SECURITY_TIME_MAX");
+    spawn_mode = getenv("SPAWN") ? getenv("SPAWN") : SPAWN_MODE_FORK;
+    exec_mode = strcmp(spawn_mode, SPAWN_MODE_EXEC) == 0;
 
     log_message(log_queue, ROLE, -1, "Port manager starting up");
+    if (terminal_count > 1) {
+        log_message(log_queue, ROLE, -1, "Port has %d terminals sharing %d ferries", terminal_count, ferry_count);
+    }
 
     // Determine executable paths for child processes based on current binary location
-    char* bin_dir = dirname(strdup(argv[1]));
+    char* bin_dir = dirname(strdup(ipc_key));
     char ferry_manager_path[255];
-    char passenger_path[255];
-    char ferry_id_arg[16];
-    char passenger_id_arg[16];
+    char generator_path[255];
 
     snprintf(ferry_manager_path, sizeof(ferry_manager_path), "%s/ferry-manager", bin_dir);
-    snprintf(passenger_path, sizeof(passenger_path), "%s/passenger", bin_dir);
-
-    pid_t ferry_pids[ferry_count];
-    pid_t security_manager;
-
-    // Spawn security manager process for passenger screening
-    security_manager = fork();
-    if (security_manager == -1) {
-        perror("Failed to spawn security manager");
-    }
-    else if (security_manager == 0) {
-        return run_security_manager(argv[1]);
+    snprintf(generator_path, sizeof(generator_path), "%s/passenger-generator", bin_dir);
+
+    // Every child, and where the security manager of each terminal is filed
+    PortChild children[ferry_count + 2 * terminal_count];
+    int child_count = 0;
+    int security_managers[terminal_count];
+
+    // Output buffered now would be flushed again by every forked child
+    fflush(stdout);
+    fflush(stderr);
+
+    // Spawn one security manager process per terminal for passenger screening
+    for (int t = 0; t < terminal_count; t++) {
+        pid_t pid = fork();
+        security_managers[t] = -1;
+        if (pid == -1) {
+            perror("Failed to spawn security manager");
+        }
+        else if (pid == 0) {
+            if (terminal_count > 1) {
+                terminals_pin(t, terminal_count);
+                proctitle_set("security-manager-%d", t);
+            } else {
+                proctitle_set("security-manager");
+            }
+            srand(time(NULL) ^ getpid());
+            sa.sa_handler = SIG_IGN;
+            sigaction(SIGINT, &sa, NULL);
+            sigaction(SIGUSR1, &sa, NULL);
+            sigaction(SIGUSR2, &sa, NULL);
+            _exit(run_security_manager(&terminals[t]));
+        }
+        else {
+            security_managers[t] = child_count;
+            port_child_file(&children[child_count++], pid, ROLE_SECURITY_MANAGER, t);
+        }
     }
 
-    // Spawn all ferry manager processes (one per ferry)
+    // Spawn all ferry manager processes (one per ferry), each serving every terminal
     for (int i = 0; i < ferry_count; i++) {
-        snprintf(ferry_id_arg, sizeof(ferry_id_arg), "%d", i);
-        ferry_pids[i] = fork();
-        if (ferry_pids[i] == -1) {
+        pid_t pid = spawn_role(exec_mode, ferry_manager_path, ipc_key, terminals, ferry_manager_process, "ferry-manager", i, NULL);
+        if (pid == -1) {
             perror("Failed to spawn ferry manager");
-        } else if (ferry_pids[i] == 0) {
-            if (execl(ferry_manager_path, ferry_manager_path, argv[1], ferry_id_arg, NULL) == -1) {
-                perror("Failed to exec ferry manager");
-            }
-            return 1;
+        } else {
+            port_child_file(&children[child_count++], pid, ROLE_FERRY_MANAGER, i);
         }
     }
 
-    // Spawn all passenger processes
-    for (int i = 0; i < passenger_count; i++) {
-        snprintf(passenger_id_arg, sizeof(passenger_id_arg), "%d", i);
-        int passpid = fork();
-        if (passpid == -1) {
-            perror("Failed to spawn passenger");
-        } else if (passpid == 0) {
-            if (execl(passenger_path, passenger_path, argv[1], passenger_id_arg, NULL) == -1) {
-                perror("Failed to exec passenger");
+    // Passengers are released by the generators, each exits after the last passenger of its terminal
+    for (int t = 0; t < terminal_count; t++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Failed to spawn passenger generator");
+        }
+        else if (pid == 0) {
+            char terminal_arg[16];
+
+            // Exec'd generators and passengers find their terminal in the environment
+            snprintf(terminal_arg, sizeof(terminal_arg), "%d", t);
+            setenv(TERMINAL_ENV, terminal_arg, 1);
+            if (terminal_count > 1) terminals_pin(t, terminal_count);
+            if (exec_mode) {
+                execl(generator_path, generator_path, ipc_key, NULL);
+                perror("Failed to exec passenger generator");
+                _exit(1);
             }
-            return 1;
+            if (terminal_count > 1) {
+                proctitle_set("passenger-generator-%d", t);
+            } else {
+                proctitle_set("passenger-generator");
+            }
+            _exit(passenger_generator_run(&terminals[t], ipc_key));
+        }
+        else {
+            port_child_file(&children[child_count++], pid, ROLE_PASSENGER_GENERATOR, t);
         }
     }
 
-    // Update spawned passengers count
-    sem_wait_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
-    shared_state->stats.passengers_spawned = passenger_count;
-    sem_signal_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
+    if (terminal_count > 1) {
+        log_message(log_queue, ROLE, -1, "Spawned all ferries and %d passenger generators", terminal_count);
+    } else {
+        log_message(log_queue, ROLE, -1, "Spawned all ferries and the passenger generator");
+    }
 
-    log_message(log_queue, ROLE, -1, "Spawned all ferries and passengers");
+    // Opened once every child is forked, so none of them holds the FIFO or a pidfd
+    control_path = getenv(CONTROL_ENV) ? getenv(CONTROL_ENV) : CONTROL_PATH_DEFAULT;
+    if (control_open(&control, control_path) == 0) {
+        log_message(log_queue, ROLE, -1, "Control channel open at %s", control_path);
+    } else {
+        perror("Port manager: Failed to open the control channel");
+    }
+    for (int i = 0; i < child_count; i++) {
+        children[i].pidfd = (int)syscall(SYS_pidfd_open, children[i].pid, 0);
+    }
 
-    // Monitor child processes: wait for all passengers to complete, then close port
-    int counter = 0;
-    int ferry_counter = 0;
-    long pid = 0;
-    while (counter < passenger_count) {
-        if ((pid = waitpid(0, NULL, WNOHANG)) > 0) {
-            for (int i = 0; i < ferry_count; i++) {
-                if (ferry_pids[i] == pid) {
-                    ferry_counter++;
-                    goto reap;
-                }
-            }
-            counter++;
-    reap:
-            continue;
-        }
-        usleep(10000);
+    // Supervise the children: each generator outlives every passenger of its terminal, so its exit
+    // closes that terminal. Ferries exit once every terminal is closed
+    int open_terminals = 0;
+    int ferries_running = 0;
+    for (int i = 0; i < child_count; i++) {
+        if (children[i].role == ROLE_PASSENGER_GENERATOR) open_terminals++;
+        if (children[i].role == ROLE_FERRY_MANAGER) ferries_running++;
     }
+    while (open_terminals > 0 || ferries_running > 0) {
+        PortChild* child = port_supervise(children, child_count, &control, terminals, terminal_count, ferry_count);
 
-    // All passengers have boarded or exited - signal port closure
-    log_message(log_queue, ROLE, -1, "All passengers exited. Marking port as closed.");
+        if (!child) continue;
+        if (child->role == ROLE_FERRY_MANAGER) ferries_running--;
+        if (child->role != ROLE_PASSENGER_GENERATOR) continue;
 
-    sem_wait_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_PORT);
-    shared_state->port_open = 0;
-    sem_signal_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_PORT);
+        int t = child->index;
+        SharedState* shared_state = (SharedState*)terminals[t].shm;
 
-    // Wait for all ferries to complete their final trips and exit
-    while (ferry_counter < ferry_count) {
-        for (int i=0 ;i < ferry_count; i++) {
-            if (waitpid(ferry_pids[i], NULL, WNOHANG) > 0) {
-                ferry_counter++;
+        // All passengers of the terminal have boarded or exited - signal its closure
+        if (terminal_count > 1) {
+            log_message(log_queue, ROLE, -1, "All passengers of terminal %d exited. Marking terminal as closed.", t);
+        } else {
+            log_message(log_queue, ROLE, -1, "All passengers exited. Marking port as closed.");
+        }
+        if (port_closed_by_command[t]) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (terminal_count > 1) {
+                log_message(log_queue, ROLE, -1, "Terminal %d empty %.3f s after close-port", t, TIMESPEC_DIFF(port_closed_at[t], now));
+            } else {
+                log_message(log_queue, ROLE, -1, "Port empty %.3f s after close-port", TIMESPEC_DIFF(port_closed_at[t], now));
             }
         }
-        usleep(10000);
+        state_mutex_lock(&shared_state->locks[SEM_STATE_MUTEX_VARIANT_PORT].mutex);
+        shared_state->port_open = 0;
+        state_mutex_unlock(&shared_state->locks[SEM_STATE_MUTEX_VARIANT_PORT].mutex);
+        ramp_wake_ferries(shared_state);
+        if (--open_terminals == 0 && terminal_count > 1) {
+            log_message(log_queue, ROLE, -1, "All terminals closed");
+        }
     }
+    control_close(&control);
 
-    log_message(log_queue, ROLE, -1, "Port manager exiting");
-    shm_detach(shared_state);
-
-    return 0;
-}
+    // No passenger is left to screen: security managers finish and exit
+    for (int t = 0; t < terminal_count; t++) {
+        SharedState* terminal_state = (SharedState*)terminals[t].shm;
+        int unanswered;
 
-/**
- * Attempts to assign a passenger to an available security station.
- * 
- * Security stations are gender-segregated. The function searches for:
- * 1. Empty stations (any gender)
- * 2. Stations with matching gender and available slots
- * 
- * @param securityStations Array of security station states
- * @param msg Security message containing passenger info (gender, PID, passenger ID)
- * @return 1 if passenger was assigned to a station, 0 if no slot found
- */
-int security_try_insert(SecurityStationState *securityStations, SecurityMessage *msg) {
-    int found = 0;
-    int variation = (rand() % (passenger_security_time_max - passenger_security_time_min + 1)) + passenger_security_time_min;
-    variation = variation * 1000000;
-    // Search for available security station matching passenger's gender
-    for (int station = 0; station < SECURITY_STATIONS; station++) {
-        // First look if the station is not occupied
-        if (securityStations[station].usage == 0) {
-            // Initialize empty station with passenger's gender and assign first slot
-            securityStations[station].gender = msg->gender;
-            securityStations[station].slots[0].pid = msg->pid;
-            clock_gettime(CLOCK_MONOTONIC, &securityStations[station].slots[0].finish_timestamp);
-            securityStations[station].slots[0].finish_timestamp.tv_nsec += variation;
-            securityStations[station].slots[0].passenger_id = msg->passenger_id;
-            securityStations[station].slots[0].dangerous = msg->dangerous_weapon;
-            securityStations[station].usage++;
-            found = 1;
+        security_ring_close(&terminal_state->security);
+        while (security_managers[t] != -1 && !children[security_managers[t]].reaped) {
+            port_supervise(children, child_count, &control, terminals, terminal_count, ferry_count);
         }
-        // Check if passenger's gender matches station and a slot is available
-        else if (securityStations[station].usage == 1 && msg->gender == (Gender)securityStations[station].gender) {
-            // Find an empty slot
-            for (int slot = 0; slot < SECURITY_STATION_CAPACITY; slot++) {
-                if (securityStations[station].slots[slot].pid == 0) {
-                    securityStations[station].slots[slot].pid = msg->pid;
-                    clock_gettime(CLOCK_MONOTONIC, &securityStations[station].slots[slot].finish_timestamp);
-                    securityStations[station].slots[slot].finish_timestamp.tv_nsec += variation;
-                    securityStations[station].slots[slot].passenger_id = msg->passenger_id;
-                    securityStations[station].slots[slot].dangerous = msg->dangerous_weapon;
-                    securityStations[station].usage++;
-                    // Note: Log moved to caller for station tracking
-                    found = 1;
-                    break;
-                }
-            }
+        // Every passenger has exited: a mailbox still held is a request nobody answered
+        if ((unanswered = mailbox_pending(&terminal_state->mailboxes)) > 0) {
+            log_message(log_queue, ROLE, -1, "[ERROR] %d reply mailboxes of terminal %d left unanswered", unanswered, t);
         }
-
-        if (found) break;
     }
-    return found;
+
+    port_children_report(log_queue, children, child_count, started);
+    log_message(log_queue, ROLE, -1, "Port manager exiting");
+
+    return 0;
 }
 
 /**
- * Security Manager Process.
+ * Port Manager Program Entry Point.
  * 
- * Manages passenger screening through gender-segregated security stations:
- * - Receives security requests from passengers via message queue
- * - Assigns passengers to appropriate stations based on gender
- * - Implements frustration mechanism: passengers overtaken multiple times get priority
- * - Notifies passengers when screening is complete
+ * Entry point of the multi-call binary when invoked as port-manager (SPAWN=exec).
+ * Opens the IPC objects of every terminal (TERMINAL_COUNT).
  * 
- * Uses an internal queue for passengers waiting when no matching station is available.
- * 
- * @param ipc_key Path used to generate IPC keys
- * @return 0 on success, 1 on error
+ * @param argc Argument count (expects at least 2)
+ * @param argv Arguments: [0]=program path, [1]=IPC key path
  */
-int run_security_manager(const char* ipc_key) {
-    key_t queue_security_key;
-    key_t queue_log_key;
-    key_t shm_key;
-    key_t sem_state_mutex_key;
-    int queue_security;
-    int queue_log;
-    int shm_id;
-    int sem_state_mutex;
-    SharedState* shared_state;
-
-    int initial_capacity = SECURITY_STATIONS * SECURITY_STATION_CAPACITY;
-    int capacity = initial_capacity;
-    SecurityStationState security_stations[SECURITY_STATIONS];
-    SecurityMessage msg;
-    SecurityMessage pending;
-    SecurityMessage internal_queue;
-    struct timespec current_time;
-    struct sigaction sa;
-
-    srand(time(NULL) ^ getpid());
-
-    sa.sa_handler = SIG_IGN;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART;
-    sigaction(SIGINT, &sa, NULL);
-    sigaction(SIGUSR1, &sa, NULL);
-    sigaction(SIGUSR2, &sa, NULL);
-
-    queue_security_key = ftok(ipc_key, IPC_KEY_QUEUE_SECURITY_ID);
-    queue_log_key = ftok(ipc_key, IPC_KEY_LOG_ID);
-    shm_key = ftok(ipc_key, IPC_KEY_SHM_ID);
-    sem_state_mutex_key = ftok(ipc_key, IPC_KEY_SEM_STATE_ID);
-
-    if (queue_security_key == -1) {
-        perror("Security manager: Failed to open semaphores");
-        return 1;
-    }
-
-    queue_security = queue_open(queue_security_key);
-    queue_log = queue_open(queue_log_key);
-    
-    shm_id = shm_open(shm_key);
-    if (shm_id == -1) {
-        perror("Security manager: Failed to open shared memory");
-        return 1;
-    }
-    
-    shared_state = (SharedState*)shm_attach(shm_id);
-    if (shared_state == (void*)-1) {
-        perror("Security manager: Failed to attach shared memory");
-        return 1;
-    }
-    
-    sem_state_mutex = sem_open(sem_state_mutex_key, SEM_STATE_MUTEX_VARIANT_COUNT);
-    if (sem_state_mutex == -1) {
-        perror("Security manager: Failed to open semaphore");
-        shm_detach(shared_state);
-        return 1;
-    }
+int port_manager_main(int argc, char** argv) {
+    IpcHandles terminals[TERMINAL_MAX];
+    int terminal_count = terminals_count();
+    int status;
 
-    // Initialize security state: no pending requests, all stations empty
-    pending.pid = 0;
-    internal_queue.pid = 0;
-    memset(security_stations, 0, sizeof(SecurityStationState) * SECURITY_STATIONS);
-
-    // Main security processing loop: receive requests, assign stations, complete screenings
-    while(1) {
-        if (capacity == 0) goto reap_stations;
-        if (pending.pid) goto try_insert;
-        // Use non-blocking mode if there are pending operations to process
-        int no_block = pending.pid + internal_queue.pid != 0 || capacity != initial_capacity;
-        if(msgrcv(queue_security, &msg, MSG_SIZE(msg), 1, no_block ? IPC_NOWAIT : 0) == -1) {
-            if (errno == EINVAL || errno == EIDRM) break;
-            if (errno == EINTR) continue;
-            if (errno == ENOMSG) goto try_insert;
-            perror("Security manager: msgrcv failed");
-        }
-        log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "Receiving security queue request");
-        pending = msg;
-
-    try_insert:
-        // Try to insert internal queue passenger first (frustration mechanism)
-        if (internal_queue.pid) {
-            if (security_try_insert(security_stations, &internal_queue)) {
-                internal_queue.pid = 0;
-                capacity--;
-            } else {
-                if (internal_queue.frustration == 3) goto reap_stations;
-            }
-        }
-
-        // Process pending passenger request (with frustration increment if overtaken)
-        if (pending.pid && (!internal_queue.pid || internal_queue.frustration < SECURITY_MAX_FRUSTRATION)) {
-            log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "Attempting to insert pending passenger_id: %d (gender: %s)",
-                        pending.passenger_id, pending.gender == GENDER_MAN ? "MALE" : "FEMALE");
-            if (security_try_insert(security_stations, &pending)) {
-                log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "Passenger %d assigned to security station (gender: %s)",
-                            pending.passenger_id, pending.gender == GENDER_MAN ? "MALE" : "FEMALE");
-                pending.pid = 0;
-                capacity--;
-                if(internal_queue.pid) {
-                    internal_queue.frustration++;
-                    log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "FRUSTRATION_INCREMENT - passenger %d overtaken (frustration: %d)",
-                                internal_queue.passenger_id, internal_queue.frustration);
-                }
-            }
-            else if (!internal_queue.pid) {
-                log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "No slot found, adding to internal queue");
-                internal_queue = pending;
-                pending.pid = 0;
-            }
-            else {
-                log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "No slot found");
-            }
-        }
-    reap_stations:
-        clock_gettime(CLOCK_MONOTONIC, &current_time);
-        // Check all stations for passengers who have completed security screening
-        for (int station = 0; station < SECURITY_STATIONS; station++) {
-            if (security_stations[station].usage == 0) continue;
-            for (int slot = 0; slot < SECURITY_STATION_CAPACITY; slot++) {
-                if (security_stations[station].slots[slot].pid != 0
-                    && TIMESPEC_DIFF(security_stations[station].slots[slot].finish_timestamp, current_time) >= 0) {
-                    msg.mtype = security_stations[station].slots[slot].pid;
-                    msg.passenger_id = security_stations[station].slots[slot].passenger_id;
-                    msg.dangerous_weapon = security_stations[station].slots[slot].dangerous;
-                    msg.gender = security_stations[station].gender;
-                    char *log;
-                    if (msg.dangerous_weapon) {
-                        log = "Passenger %d did not pass the security (station: %d, gender: %s)";
-                    } else {
-                        log = "Passenger %d passed the security (station: %d, gender: %s)";
-                    }
-                    log_message(queue_log, ROLE_SECURITY_MANAGER, -1, log,
-                                msg.passenger_id, station, msg.gender == GENDER_MAN ? "MALE" : "FEMALE");
-                    if (msgsnd(queue_security, &msg, MSG_SIZE(msg), 0)) {
-                        perror("Failed to send message back to user");
-                    }
-                    
-                    // Update screened statistics
-                    sem_wait_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
-                    if (msg.dangerous_weapon) shared_state->stats.passengers_screened_rejected++; else shared_state->stats.passengers_screened_passed++;
-                    sem_signal_single(sem_state_mutex, SEM_STATE_MUTEX_VARIANT_STATS);
-                    
-                    security_stations[station].usage--;
-                    security_stations[station].slots[slot].pid = 0;
-                    capacity++;
-                }
-            }
+    if (argc < 2) return 1;
+    for (int i = 0; i < terminal_count; i++) {
+        if (ipc_handles_open(argv[1], i, &terminals[i]) != 0) {
+            perror("Port manager: Failed to open IPC objects");
+            while (i-- > 0) ipc_handles_close(&terminals[i]);
+            return 1;
         }
     }
 
-    shm_detach(shared_state);
-    return 0;
-}
\ No newline at end of file
+    status = port_manager_run(terminals, terminal_count, argv[1]);
+    for (int i = 0; i < terminal_count; i++) ipc_handles_close(&terminals[i]);
+    return status;
+}
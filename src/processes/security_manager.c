@@ -0,0 +1,272 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/config.h"
+#include "common/state.h"
+#include "common/stats.h"
+#include "common/security_ring.h"
+#include "common/mailbox.h"
+#include "common/ipc.h"
+#include "common/logging.h"
+#include "common/messages.h"
+#include "common/macros.h"
+#include "common/timescale.h"
+#include "processes/security_manager.h"
+
+static int passenger_security_time_min;
+static int passenger_security_time_max;
+
+/**
+ * Files a screening by the time it ends, sifting it up the heap.
+ *
+ * @param completions Heap of the screenings in progress
+ * @param occupant Passenger being screened, with its finish timestamp set
+ * @param station Station screening the passenger
+ * @param slot Slot of the station
+ */
+static void security_completions_push(SecurityCompletions *completions, const SecurityStationOccupant *occupant,
+                                      int station, int slot) {
+    int child = completions->count++;
+    SecurityCompletion entry = { occupant->finish_timestamp, station, slot };
+
+    while (child > 0) {
+        int parent = (child - 1) / 2;
+        if (TIMESPEC_DIFF(completions->entries[parent].finish_timestamp, entry.finish_timestamp) >= 0) break;
+        completions->entries[child] = completions->entries[parent];
+        child = parent;
+    }
+    completions->entries[child] = entry;
+}
+
+/**
+ * Takes the screening ending first off the heap.
+ *
+ * @param completions Heap of the screenings in progress, not empty
+ * @return The screening ending first
+ */
+static SecurityCompletion security_completions_pop(SecurityCompletions *completions) {
+    SecurityCompletion first = completions->entries[0];
+    SecurityCompletion last = completions->entries[--completions->count];
+    int parent = 0;
+
+    while (1) {
+        int child = 2 * parent + 1;
+        if (child >= completions->count) break;
+        if (child + 1 < completions->count
+            && TIMESPEC_DIFF(completions->entries[child + 1].finish_timestamp, completions->entries[child].finish_timestamp) > 0) {
+            child++;
+        }
+        if (TIMESPEC_DIFF(last.finish_timestamp, completions->entries[child].finish_timestamp) >= 0) break;
+        completions->entries[parent] = completions->entries[child];
+        parent = child;
+    }
+    completions->entries[parent] = last;
+    return first;
+}
+
+/**
+ * Attempts to assign a passenger to an available security station.
+ * 
+ * Security stations are gender-segregated. The function searches for:
+ * 1. Empty stations (any gender)
+ * 2. Stations with matching gender and available slots
+ * 
+ * @param securityStations Array of security station states
+ * @param completions Heap the screening is filed in when it starts
+ * @param msg Security message containing passenger info (gender, PID, passenger ID)
+ * @return 1 if passenger was assigned to a station, 0 if no slot found
+ */
+int security_try_insert(SecurityStationState *securityStations, SecurityCompletions *completions, SecurityMessage *msg) {
+    int found = 0;
+    int variation = (rand() % (passenger_security_time_max - passenger_security_time_min + 1)) + passenger_security_time_min;
+    // Search for available security station matching passenger's gender
+    for (int station = 0; station < SECURITY_STATIONS; station++) {
+        // First look if the station is not occupied
+        if (securityStations[station].usage == 0) {
+            // Initialize empty station with passenger's gender and assign first slot
+            securityStations[station].gender = msg->gender;
+            securityStations[station].slots[0].pid = msg->pid;
+            clock_gettime(CLOCK_MONOTONIC, &securityStations[station].slots[0].finish_timestamp);
+            time_scale_deadline(&securityStations[station].slots[0].finish_timestamp, variation * 1000LL);
+            securityStations[station].slots[0].passenger_id = msg->passenger_id;
+            securityStations[station].slots[0].dangerous = msg->dangerous_weapon;
+            securityStations[station].slots[0].mailbox = msg->mailbox;
+            security_completions_push(completions, &securityStations[station].slots[0], station, 0);
+            securityStations[station].usage++;
+            found = 1;
+        }
+        // Check if passenger's gender matches station and a slot is available
+        else if (securityStations[station].usage == 1 && msg->gender == (Gender)securityStations[station].gender) {
+            // Find an empty slot
+            for (int slot = 0; slot < SECURITY_STATION_CAPACITY; slot++) {
+                if (securityStations[station].slots[slot].pid == 0) {
+                    securityStations[station].slots[slot].pid = msg->pid;
+                    clock_gettime(CLOCK_MONOTONIC, &securityStations[station].slots[slot].finish_timestamp);
+                    time_scale_deadline(&securityStations[station].slots[slot].finish_timestamp, variation * 1000LL);
+                    securityStations[station].slots[slot].passenger_id = msg->passenger_id;
+                    securityStations[station].slots[slot].dangerous = msg->dangerous_weapon;
+                    securityStations[station].slots[slot].mailbox = msg->mailbox;
+                    security_completions_push(completions, &securityStations[station].slots[slot], station, slot);
+                    securityStations[station].usage++;
+                    // Note: Log moved to caller for station tracking
+                    found = 1;
+                    break;
+                }
+            }
+        }
+
+        if (found) break;
+    }
+    return found;
+}
+
+/**
+ * Security Manager.
+ * 
+ * Manages passenger screening through gender-segregated security stations:
+ * - Takes security requests off the security ring in shared memory
+ * - Assigns passengers to appropriate stations based on gender
+ * - Implements frustration mechanism: passengers overtaken multiple times get priority
+ * - Notifies passengers in their mailboxes when screening is complete
+ * 
+ * Screenings in progress are filed in a min-heap by the time they end.
+ * Between events the manager sleeps on the doorbell of the ring until the
+ * next screening ends, or only until then while it has no room for another
+ * request. Ended screenings are answered in the order they ended. It exits
+ * once the ring is closed and every station is empty.
+ * 
+ * Uses an internal queue for passengers waiting when no matching station is available.
+ * Runs as a child process of the port manager, or as a thread of the threaded engine;
+ * signal dispositions and seeding are left to the caller.
+ * 
+ * @param ipc Simulation IPC objects
+ * @return 0 on success, 1 on error
+ */
+int run_security_manager(const IpcHandles* ipc) {
+    int queue_log;
+    SharedState* shared_state;
+    SecurityRing* ring;
+    SecurityRequest request;
+
+    int capacity = SECURITY_STATIONS * SECURITY_STATION_CAPACITY;
+    SecurityStationState security_stations[SECURITY_STATIONS];
+    SecurityCompletions completions;
+    SecurityMessage msg;
+    SecurityMessage pending;
+    SecurityMessage internal_queue;
+    struct timespec current_time;
+    struct timespec start_time;
+    struct timespec cpu_time;
+    int screened = 0;
+    double lateness = 0;
+
+    passenger_security_time_min = CONFIG_GET_INT("PASSENGER_SECURITY_TIME_MIN");
+    passenger_security_time_max = CONFIG_GET_INT("PASSENGER_SECURITY_TIME_MAX");
+
+    // IPC objects are opened once per process by the caller
+    queue_log = ipc->log_queue;
+    shared_state = (SharedState*)ipc->shm;
+    ring = &shared_state->security;
+
+    // Initialize security state: no pending requests, all stations empty
+    pending.pid = 0;
+    internal_queue.pid = 0;
+    memset(security_stations, 0, sizeof(SecurityStationState) * SECURITY_STATIONS);
+    completions.count = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    // Main security processing loop: complete screenings, receive requests, assign stations
+    while(1) {
+        clock_gettime(CLOCK_MONOTONIC, &current_time);
+        // Answer the passengers whose screening has ended, the earliest first
+        while (completions.count > 0 && TIMESPEC_DIFF(completions.entries[0].finish_timestamp, current_time) >= 0) {
+            SecurityCompletion done = security_completions_pop(&completions);
+            SecurityStationOccupant *occupant = &security_stations[done.station].slots[done.slot];
+            msg.passenger_id = occupant->passenger_id;
+            msg.dangerous_weapon = occupant->dangerous;
+            msg.gender = security_stations[done.station].gender;
+            char *log;
+            if (msg.dangerous_weapon) {
+                log = "Passenger %d did not pass the security (station: %d, gender: %s)";
+            } else {
+                log = "Passenger %d passed the security (station: %d, gender: %s)";
+            }
+            log_message(queue_log, ROLE_SECURITY_MANAGER, -1, log,
+                        msg.passenger_id, done.station, msg.gender == GENDER_MAN ? "MALE" : "FEMALE");
+            mailbox_post(&shared_state->mailboxes, occupant->mailbox, !msg.dangerous_weapon);
+
+            // Update screened statistics
+            if (msg.dangerous_weapon) STATS_INC(&shared_state->stats, done.station, passengers_screened_rejected);
+            else STATS_INC(&shared_state->stats, done.station, passengers_screened_passed);
+
+            security_stations[done.station].usage--;
+            occupant->pid = 0;
+            capacity++;
+            screened++;
+            lateness += TIMESPEC_DIFF(done.finish_timestamp, current_time);
+        }
+
+        if (capacity > 0) {
+            if (!pending.pid && security_ring_pop(ring, &request) == 0) {
+                log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "Receiving security queue request");
+                pending.gender = (Gender)request.gender;
+                pending.pid = request.pid;
+                pending.passenger_id = request.passenger_id;
+                pending.dangerous_weapon = request.dangerous;
+                pending.frustration = 0;
+                pending.mailbox = request.mailbox;
+            }
+
+            // Try to insert internal queue passenger first (frustration mechanism)
+            if (internal_queue.pid && security_try_insert(security_stations, &completions, &internal_queue)) {
+                internal_queue.pid = 0;
+                capacity--;
+            }
+
+            // Process pending passenger request (with frustration increment if overtaken)
+            if (pending.pid && (!internal_queue.pid || internal_queue.frustration < SECURITY_MAX_FRUSTRATION)) {
+                log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "Attempting to insert pending passenger_id: %d (gender: %s)",
+                            pending.passenger_id, pending.gender == GENDER_MAN ? "MALE" : "FEMALE");
+                if (security_try_insert(security_stations, &completions, &pending)) {
+                    log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "Passenger %d assigned to security station (gender: %s)",
+                                pending.passenger_id, pending.gender == GENDER_MAN ? "MALE" : "FEMALE");
+                    pending.pid = 0;
+                    capacity--;
+                    if(internal_queue.pid) {
+                        internal_queue.frustration++;
+                        log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "FRUSTRATION_INCREMENT - passenger %d overtaken (frustration: %d)",
+                                    internal_queue.passenger_id, internal_queue.frustration);
+                    }
+                }
+                else if (!internal_queue.pid) {
+                    log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "No slot found, adding to internal queue");
+                    internal_queue = pending;
+                    pending.pid = 0;
+                }
+                else {
+                    log_message(queue_log, ROLE_SECURITY_MANAGER, -1, "No slot found");
+                }
+            }
+        }
+
+        // A passenger still waiting for a station means a station is busy, so there is a deadline
+        const struct timespec* deadline = completions.count > 0 ? &completions.entries[0].finish_timestamp : NULL;
+        if (pending.pid || capacity == 0) {
+            // No room for another request: sleep until the next screening ends
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL);
+        } else if (security_ring_wait(ring, deadline) == -1 && errno == EIDRM) {
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &current_time);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time);
+    log_message(queue_log, ROLE_SECURITY_MANAGER, -1,
+                "Security manager exiting: %d screenings answered %.0f us late on average, %.1f ms CPU in %.1f s",
+                screened, screened ? lateness * 1000000.0 / screened : 0.0,
+                cpu_time.tv_sec * 1000.0 + cpu_time.tv_nsec / 1000000.0, TIMESPEC_DIFF(start_time, current_time));
+    return 0;
+}
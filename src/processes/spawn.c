@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <unistd.h>
+
+#include "common/proctitle.h"
+#include "processes/spawn.h"
+
+/**
+ * Starts one role in a child process.
+ * In fork mode the child runs the role directly on the IPC handles and
+ * configuration inherited from its parent, sharing its pages copy-on-write.
+ * In exec mode the child executes the multi-call binary under the role name,
+ * which opens every IPC object again.
+ * 
+ * @param exec_mode Non-zero to exec path instead of calling process
+ * @param path Program to exec
+ * @param ipc_key Path used to generate IPC keys
+ * @param ipc IPC handles of the parent
+ * @param process Role process function for fork mode
+ * @param title Process title of the role
+ * @param id Role identifier
+ * @param detail Extra argument for the exec'd program, NULL for none
+ * @return Child PID, -1 on error
+ */
+pid_t spawn_role(int exec_mode, const char* path, const char* ipc_key, const IpcHandles* ipc,
+                 int (*process)(const IpcHandles*, int), const char* title, int id, const char* detail) {
+    char id_arg[16];
+    pid_t pid;
+
+    pid = fork();
+    if (pid != 0) return pid;
+
+    if (exec_mode) {
+        snprintf(id_arg, sizeof(id_arg), "%d", id);
+        execl(path, path, ipc_key, id_arg, detail, (char*)NULL);
+        perror("Failed to exec role");
+        _exit(1);
+    }
+    proctitle_set("%s %d", title, id);
+    _exit(process(ipc, id));
+}
+
+/**
+ * Reads resident and proportional set size of a process.
+ * PSS splits shared pages between the processes mapping them,
+ * so it shows what each passenger actually costs.
+ * 
+ * @param pid Process to inspect
+ * @param rss Resident set size in kB
+ * @param pss Proportional set size in kB
+ * @return 0 on success, -1 if the process is gone
+ */
+static int read_memory_kb(pid_t pid, long* rss, long* pss) {
+    char path[64];
+    char line[256];
+    FILE* file;
+
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", (int)pid);
+    file = fopen(path, "r");
+    if (!file) return -1;
+
+    *rss = -1;
+    *pss = -1;
+    while (fgets(line, sizeof(line), file)) {
+        sscanf(line, "Rss: %ld kB", rss);
+        sscanf(line, "Pss: %ld kB", pss);
+    }
+    fclose(file);
+    return *rss >= 0 && *pss >= 0 ? 0 : -1;
+}
+
+/**
+ * Logs the average memory of a sample of passenger processes.
+ * Processes that already exited are left out.
+ * 
+ * @param log_queue Logger queue
+ * @param role Role of the caller
+ * @param pids Sampled passenger PIDs
+ * @param count Number of PIDs
+ * @param spawn_mode Spawn mode name for the report
+ * @return Number of processes sampled
+ */
+int spawn_report_memory(int log_queue, Role role, const pid_t* pids, int count, const char* spawn_mode) {
+    long rss_total = 0;
+    long pss_total = 0;
+    int sampled = 0;
+
+    for (int i = 0; i < count; i++) {
+        long rss;
+        long pss;
+        if (pids[i] <= 0 || read_memory_kb(pids[i], &rss, &pss) != 0) continue;
+        rss_total += rss;
+        pss_total += pss;
+        sampled++;
+    }
+    if (sampled == 0) return 0;
+    log_message(log_queue, role, -1, "Passenger memory: RSS %ld kB, PSS %ld kB on average (%d sampled, SPAWN=%s)",
+                rss_total / sampled, pss_total / sampled, sampled, spawn_mode);
+    return sampled;
+}
@@ -28,6 +28,26 @@ declare -a test_scripts=(
     "test_early_departure.sh"
     "test_port_closure.sh"
     "test_stress.sh"
+    "test_threads_engine.sh"
+    "test_des_engine.sh"
+    "test_replications.sh"
+    "test_sweep.sh"
+    "test_spawn_modes.sh"
+    "test_arrivals.sh"
+    "test_trace.sh"
+    "test_terminals.sh"
+    "test_docks.sh"
+    "test_time_scale.sh"
+    "test_transports.sh"
+    "test_checkpoint.sh"
+    "test_state_locks.sh"
+    "test_stats.sh"
+    "test_baggage_wait.sh"
+    "test_ramp_admission.sh"
+    "test_security_ring.sh"
+    "test_reply_mailboxes.sh"
+    "test_ramp_leases.sh"
+    "test_control.sh"
 )
 
 # Run each test
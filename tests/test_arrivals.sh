@@ -0,0 +1,89 @@
+#!/bin/bash
+# Arrival process test - passengers released by the generator at a given rate, with bounded concurrency
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Arrival Process Test"
+echo "========================================"
+echo "600 Poisson arrivals every 5 ms, at most 40 passengers alive"
+echo ""
+
+rm -f "$LOG_FILE"
+
+export ARRIVALS=poisson
+export ARRIVAL_INTERVAL=5
+export MAX_LIVE_PASSENGERS=40
+export PASSENGER_COUNT=600
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+
+log_info "Running simulation with the passenger generator..."
+run_test_with_timeout 120 "$SIM_BIN"
+
+exit_code=$?
+
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out!"
+    exit 1
+elif [ $exit_code -ne 0 ]; then
+    log_error "Simulation failed with exit code: $exit_code"
+    exit 1
+fi
+
+if ! verify_log_exists "$LOG_FILE"; then
+    exit 1
+fi
+
+echo ""
+log_info "Validating results..."
+echo ""
+
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned"
+
+# The generator reports how long releasing took and the most passengers alive at once
+report=$(grep "\[PASSENGER_GENERATOR\] Spawned" "$LOG_FILE")
+peak=$(echo "$report" | sed -n 's/.*peak \([0-9]*\) live.*/\1/p')
+release_ms=$(echo "$report" | sed -n 's/.* in \([0-9.]*\) s .*/\1/p' | awk '{ printf "%d", $1 * 1000 }')
+log_info "Generator: $report"
+
+assert_less_than_or_equal "${peak:-999}" "$MAX_LIVE_PASSENGERS" "Live passengers bounded by MAX_LIVE_PASSENGERS"
+# 600 arrivals 5 ms apart on average take about 3 s, not a burst
+assert_greater_than "${release_ms:-0}" 1000 "Arrivals spread over time"
+
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+check_for_errors "$LOG_FILE"
+
+# Fixed arrivals in virtual time: passenger i arrives i minutes after the port opens
+echo ""
+log_info "Running fixed arrivals with ENGINE=des..."
+ENGINE=des SEED=7 ARRIVALS=fixed ARRIVAL_INTERVAL=60000 PASSENGER_COUNT=50 "$SIM_BIN" > /dev/null 2>&1
+last_arrival=$(grep "\[PASSENGER_0049\] At baggage check" "$LOG_FILE" | cut -c2-9)
+assert_equals "00:49:00" "$last_arrival" "Last of 50 passengers arrives after 49 fixed gaps"
+
+print_test_summary
+exit $TESTS_FAILED
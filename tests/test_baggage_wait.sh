@@ -0,0 +1,96 @@
+#!/bin/bash
+# Baggage wait test - passengers asleep in bag weight buckets until a ferry that may take their bag docks (BENCH=baggage)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+BENCH_OUT="bench_baggage.out"
+
+echo "========================================"
+echo "Baggage Wait Test"
+echo "========================================"
+echo "Baggage benchmark, then 500 passengers in the process and threaded engines"
+echo ""
+
+# Sleeping waiters look at the docks less often than polling ones, and still see the ferry dock
+log_info "Running baggage benchmark..."
+BENCH=baggage BENCH_PROCESSES=4 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Baggage benchmark completed"
+rows=$(grep -c "^\(Polling 10 ms\|Weight buckets\) .* ms .* us .* us$" "$BENCH_OUT")
+assert_equals "2" "$rows" "Polling and weight buckets timed"
+polling_checks=$(grep "^Polling 10 ms " "$BENCH_OUT" | awk '{ print $4 }')
+bucket_checks=$(grep "^Weight buckets " "$BENCH_OUT" | awk '{ print $3 }')
+assert_greater_than "$polling_checks" "$bucket_checks" "Waiters in weight buckets look at the docks less often"
+rm -f "$BENCH_OUT"
+echo ""
+
+export DOCK_COUNT=2
+export PASSENGER_COUNT=500
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=20
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+export TIME_SCALE=10
+
+# Ferries of limits 20 to 50: heavy bags wait through several dockings, and every bag fits some ferry
+for engine in process threads; do
+    rm -f "$LOG_FILE"
+    export ENGINE=$engine
+
+    log_info "Running simulation with ENGINE=$engine..."
+    run_test_with_timeout 180 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out with ENGINE=$engine!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed with ENGINE=$engine, exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    passed=$(get_stat_passengers_screened_passed "$LOG_FILE")
+    rejected=$(get_stat_passengers_screened_rejected "$LOG_FILE")
+    boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (ENGINE=$engine)"
+    assert_equals "$spawned" "$((passed + rejected))" "Every passenger got past baggage check (ENGINE=$engine)"
+    assert_equals "$passed" "$boarded" "Every screened passenger boarded (ENGINE=$engine)"
+
+    # Every docking reports the demand waiting at baggage check
+    dockings=$(grep -c "Ferry is preparing for boarding" "$LOG_FILE")
+    demand=$(grep -c "Baggage check demand: [0-9]* waiting may fit the limit [0-9]*, [0-9]* heavier" "$LOG_FILE")
+    assert_equals "$dockings" "$demand" "Demand reported at every docking (ENGINE=$engine)"
+
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+done
+unset ENGINE
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,115 @@
+#!/bin/bash
+# Checkpoint test - discrete-event state saved mid-day (CHECKPOINT) and resumed (WARM_START)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+CHECKPOINT_FILE="$(mktemp /tmp/ferry-checkpoint-XXXXXX)"
+COLD_LOG="$(mktemp /tmp/ferry-cold-XXXXXX.log)"
+trap 'rm -f "$CHECKPOINT_FILE" "$COLD_LOG"' EXIT
+
+echo "========================================"
+echo "Checkpoint Test"
+echo "========================================"
+echo "3000 passengers, checkpoint after 10 simulated minutes"
+echo ""
+
+export ENGINE=des
+export SEED=11
+export PASSENGER_COUNT=3000
+export ARRIVAL_INTERVAL=500
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=5
+export FERRY_TRAVEL_TIME=3
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+
+CHECKPOINT_AT=600
+
+run_des() {
+    local label=$1
+    shift
+
+    rm -f "$LOG_FILE"
+    log_info "Running simulation ($label)..."
+    env "$@" "$SIM_BIN" > /dev/null
+    exit_code=$?
+    if [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed ($label), exit code: $exit_code"
+        exit 1
+    fi
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+}
+
+# Events from the checkpoint time on, without the checkpoint and warm start notes
+log_after_checkpoint() {
+    awk -v at=$CHECKPOINT_AT '
+        match($0, /^\(([0-9]+):([0-9]+):([0-9]+)\)/) {
+            split(substr($0, 2, 8), t, ":")
+            if (t[1] * 3600 + t[2] * 60 + t[3] >= at && $0 !~ /Warm start|Checkpoint saved/) print
+        }' "$1"
+}
+
+run_des "cold, with checkpoint" CHECKPOINT="$CHECKPOINT_FILE" CHECKPOINT_AT=$CHECKPOINT_AT
+cp "$LOG_FILE" "$COLD_LOG"
+cold_stats=$(grep -E "^(Passengers|Total)" "$LOG_FILE")
+saved=$(grep -c "Checkpoint saved" "$LOG_FILE")
+assert_equals "1" "$saved" "Checkpoint saved once"
+[ -s "$CHECKPOINT_FILE" ]
+assert_equals "0" "$?" "Checkpoint file written"
+
+run_des "warm start, same seed" WARM_START="$CHECKPOINT_FILE"
+warm_stats=$(grep -E "^(Passengers|Total)" "$LOG_FILE")
+first=$(grep -m1 -o "^([0-9:]*)" "$LOG_FILE")
+assert_equals "(00:09:59)" "$first" "Warm start resumes at the checkpoint"
+[ "$cold_stats" = "$warm_stats" ]
+assert_equals "0" "$?" "Same statistics as the uninterrupted run"
+diff -q <(log_after_checkpoint "$COLD_LOG") <(log_after_checkpoint "$LOG_FILE") > /dev/null
+assert_equals "0" "$?" "Same events as the uninterrupted run after the checkpoint"
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+check_for_errors "$LOG_FILE"
+echo ""
+
+run_des "warm start, other seed" WARM_START="$CHECKPOINT_FILE" SEED=12
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (other seed)"
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+echo ""
+
+completed=$(WARM_START="$CHECKPOINT_FILE" REPLICATIONS=4 "$SIM_BIN" | grep -o "Replications completed: *[0-9]*/[0-9]*" | awk '{ print $NF }')
+assert_equals "4/4" "$completed" "Replications start from the checkpoint"
+
+# Checkpoints only resume the model they were taken from
+FERRY_COUNT=5 WARM_START="$CHECKPOINT_FILE" "$SIM_BIN" > /dev/null 2>&1
+assert_equals "1" "$?" "Checkpoint with another configuration rejected"
+head -c 100 "$CHECKPOINT_FILE" > "$COLD_LOG"
+WARM_START="$COLD_LOG" "$SIM_BIN" > /dev/null 2>&1
+assert_equals "1" "$?" "Truncated checkpoint rejected"
+CHECKPOINT="$COLD_LOG" CHECKPOINT_AT=1000000 "$SIM_BIN" > /dev/null 2>&1
+assert_equals "1" "$?" "Checkpoint after the port closed reported"
+ENGINE=process CHECKPOINT="$COLD_LOG" "$SIM_BIN" > /dev/null 2>&1
+assert_equals "1" "$?" "CHECKPOINT rejected outside the discrete-event engine"
+rm -f "$LOG_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
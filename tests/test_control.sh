@@ -0,0 +1,167 @@
+#!/bin/bash
+# Control channel test - commands to the port manager's FIFO reach only the roles they concern
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+export CONTROL="$PWD/test.control"
+
+# Waits for a line in the log, up to a timeout in seconds
+wait_for_log() {
+    local pattern="$1"
+    local timeout="$2"
+    for attempt in $(seq $((timeout * 20))); do
+        grep -q "$pattern" "$LOG_FILE" 2>/dev/null && return 0
+        sleep 0.05
+    done
+    return 1
+}
+
+# Writes a command to the control channel
+send_command() {
+    log_info "Sending \"$1\" on the control channel..."
+    echo "$1" > "$CONTROL"
+}
+
+echo "========================================"
+echo "Control Channel Test"
+echo "========================================"
+echo "Control benchmark, pause, resume, depart-now and drain on 300 passengers, then close-port on 5000"
+echo ""
+
+output=$(BENCH=control BENCH_PROCESSES=200 "$SIM_BIN")
+assert_equals "0" "$?" "Control benchmark completed"
+echo "$output"
+group=$(echo "$output" | awk '/^Group signals/ { print $3 }')
+channel=$(echo "$output" | awk '/^Control channel/ { print $3 }')
+assert_equals "200" "$group" "Group broadcast signals every passenger for one ferry"
+assert_equals "0" "$channel" "Control channel signals nobody"
+echo ""
+
+export PASSENGER_COUNT=300
+export FERRY_COUNT=2
+export FERRY_CAPACITY=40
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=30
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=10
+export PASSENGER_SECURITY_TIME_MAX=20
+export PASSENGER_BOARDING_TIME=2000
+export FERRY_GATE_MAX_DELAY=100
+export FERRY_BAGGAGE_LIMIT_MIN=60
+export FERRY_BAGGAGE_LIMIT_MAX=80
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=0
+export VIP_CHANCE=10
+export ARRIVAL_INTERVAL=20
+export ENGINE=process
+
+rm -f "$LOG_FILE"
+log_info "Running simulation with $PASSENGER_COUNT passengers arriving every ${ARRIVAL_INTERVAL} ms..."
+run_test_with_timeout 120 "$SIM_BIN" > /dev/null &
+sim_pid=$!
+
+if ! wait_for_log "Control channel open" 20 || [ ! -p "$CONTROL" ]; then
+    log_error "Control channel never opened"
+    kill "$sim_pid"
+    exit 1
+fi
+wait_for_log "Ferry is open for boarding" 20
+
+# Nobody arrives while paused
+send_command "pause"
+wait_for_log "Arrivals paused" 10
+sleep 1
+arrived=$(grep -c "At baggage check" "$LOG_FILE")
+sleep 2
+assert_equals "$arrived" "$(grep -c "At baggage check" "$LOG_FILE")" "No arrivals while paused"
+send_command "resume"
+wait_for_log "Arrivals resumed" 10
+assert_equals "0" "$?" "Arrivals resumed"
+
+# Only the ferry named departs, long before its 30 s interval
+send_command "depart-now 0"
+send_command "depart-now 7"
+send_command "sail-away"
+# A line too long for the channel is dropped whole, its tail is no command
+send_command "$(printf 'x%.0s' {1..70})depart-now 6"
+wait_for_log "FERRY_MANAGER_0000\] Ferry departing" 10
+assert_equals "0" "$?" "Ferry 0 departed on depart-now"
+
+# The passengers who arrived board, nobody else arrives
+send_command "drain"
+wait $sim_pid
+exit_code=$?
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out: the port never drained"
+    exit 1
+fi
+assert_equals "0" "$exit_code" "Simulation drained"
+if ! verify_log_exists "$LOG_FILE"; then
+    exit 1
+fi
+assert_equals "1" "$(grep -c "Ignoring control command \"depart-now 7\": no ferry 7" "$LOG_FILE")" "Unknown ferry ignored"
+assert_equals "1" "$(grep -c "Ignoring control command \"sail-away\": unknown" "$LOG_FILE")" "Unknown command ignored"
+assert_equals "0" "$(grep -c "control command \"[x]*depart-now 6\"" "$LOG_FILE")" "Over-long line dropped"
+assert_equals "1" "$(grep -c "Port draining, [0-9]* passengers never arrived" "$LOG_FILE")" "Arrivals stopped by drain"
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+assert_greater_than "$PASSENGER_COUNT" "$spawned" "Not every passenger arrived"
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+check_for_errors "$LOG_FILE"
+# Children are reaped as they exit, the port manager wakes up for exits and commands only
+children=$((FERRY_COUNT + 2))
+report=$(grep -o "Supervised .*" "$LOG_FILE")
+log_info "$report"
+assert_equals "$children" "$(grep -c "Child [a-z-]* [0-9]* (pid [0-9]*) exited with status 0 after" "$LOG_FILE")" "Every child's exit status and lifetime reported"
+assert_equals "$children" "$(echo "$report" | awk '{ print $7 }')" "Every child exited cleanly"
+assert_less_than_or_equal "$(echo "$report" | awk '{ print $12 }')" "$((children + 7 + 4))" "Port manager woke only for exits and commands"
+[ -e "$CONTROL" ]
+assert_equals "1" "$?" "Control channel removed"
+echo ""
+
+# Close the port on 5000 passengers at once
+export PASSENGER_COUNT=5000
+export FERRY_COUNT=4
+export FERRY_CAPACITY=600
+export RAMP_CAPACITY_REG=5
+export RAMP_CAPACITY_VIP=3
+export FERRY_DEPARTURE_INTERVAL=8
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export ARRIVAL_INTERVAL=0
+rm -f "$LOG_FILE"
+log_info "Running simulation with $PASSENGER_COUNT passengers, closing the port as the first ferry departs..."
+run_test_with_timeout 180 "$SIM_BIN" > /dev/null &
+sim_pid=$!
+wait_for_log "Ferry departing" 60
+send_command "close-port"
+wait $sim_pid
+exit_code=$?
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out: passengers outlived the closure"
+    exit 1
+fi
+assert_equals "0" "$exit_code" "Simulation closed by close-port"
+empty=$(grep -o "Port empty [0-9.]* s after close-port" "$LOG_FILE")
+assert_equals "1" "$(echo "$empty" | grep -c "Port empty")" "Closure time logged"
+log_info "$empty"
+boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+assert_greater_than "$PASSENGER_COUNT" "$boarded" "Passengers left without boarding"
+assert_equals "0" "$(pgrep -c -f "^passenger [0-9]")" "No passenger left running"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+check_for_errors "$LOG_FILE"
+unset CONTROL PASSENGER_COUNT ARRIVAL_INTERVAL ENGINE
+rm -f "$LOG_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
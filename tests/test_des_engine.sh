@@ -0,0 +1,89 @@
+#!/bin/bash
+# Discrete-event engine test - whole port day in virtual time (ENGINE=des)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Discrete-Event Engine Test"
+echo "========================================"
+echo "2000 passengers over several simulated hours, no real sleeps"
+echo ""
+
+rm -f "$LOG_FILE"
+
+# Discrete-event engine configuration: minutes-long intervals cost nothing in virtual time
+export ENGINE=des
+export SEED=42
+export PASSENGER_COUNT=2000
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=120
+export FERRY_TRAVEL_TIME=600
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+
+log_info "Running simulation with the discrete-event engine..."
+run_test_with_timeout 30 "$SIM_BIN"
+
+exit_code=$?
+
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out!"
+    exit 1
+elif [ $exit_code -ne 0 ]; then
+    log_error "Simulation failed with exit code: $exit_code"
+    exit 1
+fi
+
+if ! verify_log_exists "$LOG_FILE"; then
+    exit 1
+fi
+
+echo ""
+log_info "Validating results..."
+echo ""
+
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+rejected_security=$(get_stat_passengers_screened_rejected "$LOG_FILE")
+
+log_info "Passengers spawned: $spawned"
+log_info "Passengers boarded: $boarded"
+log_info "Passengers rejected at security: $rejected_security"
+
+assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned"
+
+# Same log events as the process engine, so the same validations apply
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+validate_ramp_empty_on_departure "$LOG_FILE"
+
+# Check for errors
+check_for_errors "$LOG_FILE"
+
+# Same seed, same port day
+first_stats=$(grep -A7 "=== Simulation Statistics ===" "$LOG_FILE" | md5sum)
+run_test_with_timeout 30 "$SIM_BIN"
+second_stats=$(grep -A7 "=== Simulation Statistics ===" "$LOG_FILE" | md5sum)
+assert_equals "$first_stats" "$second_stats" "Runs with the same SEED produce the same statistics"
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,100 @@
+#!/bin/bash
+# Multi-dock test - several ferries boarding at once from their own ramp lanes (DOCK_COUNT)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Multi-Dock Test"
+echo "========================================"
+echo "500 passengers, 6 ferries boarding at 3 docks"
+echo ""
+
+export DOCK_COUNT=3
+export PASSENGER_COUNT=500
+export FERRY_COUNT=6
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=2
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+
+run_docks() {
+    local label=$1
+
+    rm -f "$LOG_FILE"
+    log_info "Running simulation with $DOCK_COUNT docks ($label)..."
+    run_test_with_timeout 180 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out ($label)!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed ($label), exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned ($label)"
+
+    # Gates open between "Ferry is open for boarding" and "Gate closing" of the same ferry
+    max_boarding=$(grep -E "Ferry is open for boarding|Gate closing" "$LOG_FILE" | \
+        awk '/open for boarding/ { open++ } /Gate closing/ { open-- } open > max { max = open } END { print max + 0 }')
+    assert_greater_than "$max_boarding" "1" "Several ferries boarded at once ($label)"
+    assert_less_than_or_equal "$max_boarding" "$DOCK_COUNT" "At most one ferry per dock ($label)"
+
+    # Every ferry has its own ramp lane with the configured slots
+    max_on_ramp=$(grep -E "Granting ramp|left ramp" "$LOG_FILE" | \
+        awk '{ ferry = $2 } /Granting ramp/ { on[ferry]++ } /left ramp/ { on[ferry]-- } on[ferry] > max { max = on[ferry] } END { print max + 0 }')
+    assert_less_than_or_equal "$max_on_ramp" "$((RAMP_CAPACITY_REG + RAMP_CAPACITY_VIP))" "Ramp lane capacity never exceeded ($label)"
+
+    validate_passenger_accounting "$LOG_FILE"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+}
+
+run_docks "process engine"
+
+docked=$(grep -o "Ferry docked at dock [0-9]*" "$LOG_FILE" | sort -u | wc -l)
+assert_equals "$DOCK_COUNT" "$docked" "Every dock used"
+routed=$(grep -o "Baggage meets the limit (.*dock: [0-9]*)" "$LOG_FILE" | awk '{ print $NF }' | sort -u | wc -l)
+assert_equals "$DOCK_COUNT" "$routed" "Passengers routed to every dock"
+
+export ENGINE=threads
+run_docks "threads engine"
+
+export ENGINE=des
+export SEED=5
+run_docks "discrete-event engine"
+unset SEED ENGINE
+
+# The number of docks is bounded
+DOCK_COUNT=9 "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "DOCK_COUNT above the limit rejected"
+
+print_test_summary
+exit $TESTS_FAILED
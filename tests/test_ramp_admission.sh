@@ -0,0 +1,116 @@
+#!/bin/bash
+# Ramp admission test - passengers reach the ramp through shared-memory lanes with VIP priority (BENCH=ramp),
+# and the ferry sleeps on the doorbell of its lane (BENCH=boarding)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+BENCH_OUT="bench_ramp.out"
+
+echo "========================================"
+echo "Ramp Admission Test"
+echo "========================================"
+echo "Ramp and boarding benchmarks, then 500 passengers in the process and threaded engines"
+echo ""
+
+# Both protocols board every passenger without letting more onto the ramp than it has slots
+log_info "Running ramp benchmark..."
+BENCH=ramp BENCH_PROCESSES=8 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Ramp benchmark completed"
+rows=$(grep -c "^\(Message queue\|Shared lane\) *[0-9]* *[0-9]*$" "$BENCH_OUT")
+assert_equals "2" "$rows" "Message queue and shared lane timed"
+kept=$(grep -c "^Ramp capacity kept: yes$" "$BENCH_OUT")
+assert_equals "1" "$kept" "Ramp capacity kept by both protocols"
+echo ""
+
+# A ferry asleep on its doorbell grants sooner than one polling every millisecond, and does not wake for nothing
+log_info "Running boarding benchmark..."
+BENCH=boarding BENCH_PROCESSES=4 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Boarding benchmark completed"
+polling=$(awk '/^Polling 1 ms/ { printf "%d", $4 }' "$BENCH_OUT")
+doorbell=$(awk '/^Doorbell/ { printf "%d", $2 }' "$BENCH_OUT")
+empty=$(awk '/^Doorbell/ { print $6 }' "$BENCH_OUT")
+assert_greater_than "$polling" "$doorbell" "Doorbell grants sooner than polling (us)"
+# Only a passenger preempted between sending and ringing wakes it to a lane it already emptied
+assert_less_than_or_equal "$empty" 10 "Doorbell ferry hardly ever woke to an empty lane (per s)"
+rm -f "$BENCH_OUT"
+echo ""
+
+export DOCK_COUNT=2
+export PASSENGER_COUNT=500
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=60
+export FERRY_BAGGAGE_LIMIT_MAX=80
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=30
+export TIME_SCALE=10
+
+for engine in process threads; do
+    rm -f "$LOG_FILE"
+    export ENGINE=$engine
+
+    log_info "Running simulation with ENGINE=$engine..."
+    run_test_with_timeout 180 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out with ENGINE=$engine!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed with ENGINE=$engine, exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    passed=$(get_stat_passengers_screened_passed "$LOG_FILE")
+    boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (ENGINE=$engine)"
+    assert_equals "$passed" "$boarded" "Every screened passenger boarded (ENGINE=$engine)"
+
+    # Every grant is answered in a grant cell and ends with the passenger leaving the ramp
+    granted=$(grep -c "Granting ramp to passenger" "$LOG_FILE")
+    left=$(grep -c "Passenger [0-9]* left ramp" "$LOG_FILE")
+    assert_equals "$granted" "$left" "Every passenger granted the ramp left it (ENGINE=$engine)"
+    vip_granted=$(grep -c "Granting ramp to passenger [0-9]* (VIP: 1)" "$LOG_FILE")
+    assert_greater_than "$vip_granted" "0" "VIP lane used (ENGINE=$engine)"
+
+    validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+done
+unset ENGINE
+
+# A ramp lane holds at most 32 passengers
+RAMP_CAPACITY_REG=30 RAMP_CAPACITY_VIP=3 "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "Ramp capacity above the lane size rejected"
+rm -f "$LOG_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,109 @@
+#!/bin/bash
+# Ramp lease test - the ferry takes back ramp slots of passengers killed on the ramp, and waits for those outliving their lease
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+KILLED=3
+
+echo "========================================"
+echo "Ramp Lease Test"
+echo "========================================"
+echo "80 passengers, $KILLED killed while walking onto the ferry, then 40 passengers with a short lease"
+echo ""
+
+export PASSENGER_COUNT=80
+export FERRY_COUNT=2
+export FERRY_CAPACITY=30
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=2
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=3000000
+export FERRY_GATE_MAX_DELAY=100
+export FERRY_BAGGAGE_LIMIT_MIN=60
+export FERRY_BAGGAGE_LIMIT_MAX=80
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=0
+export VIP_CHANCE=10
+export ENGINE=process
+
+rm -f "$LOG_FILE"
+log_info "Running simulation, killing $KILLED passengers on the ramp..."
+run_test_with_timeout 180 "$SIM_BIN" > /dev/null &
+sim_pid=$!
+
+# Kill the first passengers granted the ramp while they walk onto the ferry
+for attempt in $(seq 100); do
+    boarding=$(grep -c "Boarding ferry" "$LOG_FILE" 2>/dev/null)
+    [ "${boarding:-0}" -ge "$KILLED" ] && break
+    sleep 0.1
+done
+killed=0
+for id in $(grep "Boarding ferry" "$LOG_FILE" | head -n "$KILLED" | sed -E 's/.*PASSENGER_0*([0-9]+).*/\1/'); do
+    pkill -9 -f "^passenger $id\$" && ((killed++))
+done
+log_info "Killed $killed passengers on the ramp"
+
+wait $sim_pid
+exit_code=$?
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out: a dock stalled on a leaked ramp slot"
+    exit 1
+fi
+assert_equals "0" "$exit_code" "Simulation completed with passengers killed on the ramp"
+
+if ! verify_log_exists "$LOG_FILE"; then
+    exit 1
+fi
+
+reclaimed=$(grep -c "Reclaimed ramp slot of passenger [0-9]* (passenger exited" "$LOG_FILE")
+assert_equals "$killed" "$reclaimed" "Every killed passenger's slot taken back"
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+passed=$(get_stat_passengers_screened_passed "$LOG_FILE")
+boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned"
+assert_equals "$((passed - killed))" "$boarded" "Every other screened passenger boarded"
+validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+check_for_errors "$LOG_FILE"
+echo ""
+
+# A lease shorter than the walk: live passengers outliving it keep their slot and board
+# the ferry that let them on, which waits for them and is never overfilled
+export PASSENGER_COUNT=40
+export FERRY_CAPACITY=6
+export PASSENGER_BOARDING_TIME=1000000
+export RAMP_LEASE_TIME=200000
+rm -f "$LOG_FILE"
+log_info "Running simulation with RAMP_LEASE_TIME=$RAMP_LEASE_TIME..."
+run_test_with_timeout 180 "$SIM_BIN" > /dev/null
+assert_equals "0" "$?" "Simulation completed with a short lease"
+outlived=$(grep -c "outlived its ramp lease" "$LOG_FILE")
+reclaimed=$(grep -c "Reclaimed ramp slot" "$LOG_FILE")
+assert_greater_than "$outlived" "0" "Passengers outlived their lease"
+assert_equals "0" "$reclaimed" "No slot taken back from a live passenger"
+passed=$(get_stat_passengers_screened_passed "$LOG_FILE")
+boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+assert_equals "$passed" "$boarded" "Every screened passenger boarded"
+validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+check_for_errors "$LOG_FILE"
+echo ""
+
+RAMP_LEASE_TIME=0 "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "RAMP_LEASE_TIME=0 rejected"
+unset RAMP_LEASE_TIME ENGINE
+rm -f "$LOG_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,86 @@
+#!/bin/bash
+# Replication runner test - independent DES runs across worker processes (ENGINE=des REPLICATIONS=N)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+OUTPUT_FILE="replications.out"
+
+echo "========================================"
+echo "Replication Runner Test"
+echo "========================================"
+echo "40 replications of 500 passengers on 4 workers"
+echo ""
+
+rm -f "$OUTPUT_FILE"
+
+# Replication configuration
+export ENGINE=des
+export REPLICATIONS=40
+export WORKERS=4
+export SEED=100
+export PASSENGER_COUNT=500
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=60
+export FERRY_TRAVEL_TIME=300
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=10
+export VIP_CHANCE=10
+
+log_info "Running replications..."
+timeout 60 "$SIM_BIN" > "$OUTPUT_FILE"
+exit_code=$?
+
+if [ $exit_code -eq 124 ]; then
+    log_error "Replications timed out!"
+    exit 1
+elif [ $exit_code -ne 0 ]; then
+    log_error "Replications failed with exit code: $exit_code"
+    exit 1
+fi
+
+echo ""
+log_info "Validating results..."
+echo ""
+
+completed=$(grep "Replications completed:" "$OUTPUT_FILE" | awk '{print $3}')
+assert_equals "$REPLICATIONS/$REPLICATIONS" "$completed" "All replications completed"
+
+# Every passenger either boards or is rejected at security, so the means add up too
+boarded_mean=$(grep "^Passengers boarded" "$OUTPUT_FILE" | awk '{print $3}')
+rejected_mean=$(grep "^Passengers rejected security" "$OUTPUT_FILE" | awk '{print $4}')
+total=$(awk -v a="$boarded_mean" -v b="$rejected_mean" 'BEGIN { printf "%.0f", a + b }')
+assert_equals "$PASSENGER_COUNT" "$total" "Mean boarded + mean rejected = passengers"
+
+# Confidence interval brackets the mean
+inside=$(grep "^Passengers boarded" "$OUTPUT_FILE" | awk '{ print ($5 <= $3 && $3 <= $6) ? "yes" : "no" }')
+assert_equals "yes" "$inside" "Mean lies inside its confidence interval"
+
+# Replications differ, so boarded counts have non-zero variance
+variance=$(grep "^Passengers boarded" "$OUTPUT_FILE" | awk '{ printf "%.0f", $4 * 1000 }')
+assert_greater_than "$variance" 0 "Replications use distinct seeds"
+
+# Same SEED reproduces the whole table, regardless of worker count
+first=$(grep -A9 "=== Replication Statistics ===" "$OUTPUT_FILE" | md5sum)
+WORKERS=1 timeout 60 "$SIM_BIN" > "$OUTPUT_FILE"
+second=$(grep -A9 "=== Replication Statistics ===" "$OUTPUT_FILE" | md5sum)
+assert_equals "$first" "$second" "Same SEED gives the same statistics on 1 and 4 workers"
+
+rm -f "$OUTPUT_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,144 @@
+#!/bin/bash
+# Reply mailbox test - security and ramp answers in shared-memory mailboxes, none left held at the end
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+BENCH_OUT="bench_mailboxes.out"
+
+echo "========================================"
+echo "Reply Mailbox Test"
+echo "========================================"
+echo "Shared state layout, then 600 passengers at 2 docks in the process and threaded engines,"
+echo "then 30 passengers asking a stopped ferry for the ramp as the port closes"
+echo ""
+
+log_info "Checking the shared state layout..."
+BENCH=layout BENCH_ITERATIONS=1000 run_test_with_timeout 60 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+assert_equals "0" "$exit_code" "Layout benchmark completed"
+assert_equals "1" "$(grep -c "reply mailboxes [0-9]* (64 each)" "$BENCH_OUT")" "Reply mailboxes one cache line each"
+rm -f "$BENCH_OUT"
+echo ""
+
+export PASSENGER_COUNT=600
+export FERRY_COUNT=4
+export DOCK_COUNT=2
+export FERRY_CAPACITY=60
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=60
+export FERRY_BAGGAGE_LIMIT_MAX=80
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=10
+export VIP_CHANCE=20
+export TIME_SCALE=10
+
+for engine in process threads; do
+    rm -f "$LOG_FILE"
+    export ENGINE=$engine
+
+    log_info "Running simulation with ENGINE=$engine..."
+    run_test_with_timeout 180 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out with ENGINE=$engine!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed with ENGINE=$engine, exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    passed=$(get_stat_passengers_screened_passed "$LOG_FILE")
+    rejected=$(get_stat_passengers_screened_rejected "$LOG_FILE")
+    boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (ENGINE=$engine)"
+    assert_equals "$spawned" "$((passed + rejected))" "Every passenger screened (ENGINE=$engine)"
+    assert_equals "$passed" "$boarded" "Every screened passenger boarded (ENGINE=$engine)"
+
+    # Both managers answer in mailboxes: every request gets exactly one answer
+    requested=$(grep -c "Requested security station allocation" "$LOG_FILE")
+    screened=$(grep -c "Passenger [0-9]* \(passed\|did not pass\) the security" "$LOG_FILE")
+    assert_equals "$requested" "$screened" "Every security request answered (ENGINE=$engine)"
+    ramp_requests=$(grep -c "Requesting ramp access" "$LOG_FILE")
+    ramp_answers=$(grep -c "Granting ramp to passenger\|Rejecting passenger" "$LOG_FILE")
+    assert_equals "$ramp_requests" "$ramp_answers" "Every ramp request answered (ENGINE=$engine)"
+    refused=$(grep -c "Rejecting passenger" "$LOG_FILE")
+    log_info "Ramp requests refused and asked again: $refused"
+
+    unanswered=$(grep -c "reply mailboxes.*left unanswered" "$LOG_FILE")
+    assert_equals "0" "$unanswered" "No mailbox left held (ENGINE=$engine)"
+
+    validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+done
+unset ENGINE
+
+# The only ferry stops as its gate opens, before screening lets anyone onto the ramp,
+# so nobody answers the ramp requests before the port closes
+export PASSENGER_COUNT=30
+export FERRY_COUNT=1
+export DOCK_COUNT=1
+export FERRY_CAPACITY=30
+export RAMP_CAPACITY_REG=10
+export PASSENGER_SECURITY_TIME_MIN=300
+export PASSENGER_SECURITY_TIME_MAX=500
+export FERRY_GATE_MAX_DELAY=100
+export DANGEROUS_ITEM_CHANCE=0
+export TIME_SCALE=1
+rm -f "$LOG_FILE"
+log_info "Running simulation, closing the port while its ferry is stopped..."
+run_test_with_timeout 120 setsid "$SIM_BIN" > /dev/null &
+sim_pid=$!
+
+for attempt in $(seq 200); do
+    grep -q "Ferry is open for boarding" "$LOG_FILE" 2>/dev/null && break
+    sleep 0.01
+done
+pkill -STOP -f "^ferry-manager"
+for attempt in $(seq 200); do
+    grep -q "Requesting ramp access" "$LOG_FILE" && break
+    sleep 0.05
+done
+pkill -INT -f "^port-manager"
+sleep 3
+pkill -CONT -f "^ferry-manager"
+
+wait $sim_pid
+exit_code=$?
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out: a ramp request outlived the port"
+    exit 1
+fi
+assert_equals "0" "$exit_code" "Simulation completed with the ferry stopped at the closure"
+withdrawn=$(grep -c "Withdrew ramp request" "$LOG_FILE")
+found=$(grep -c "Passenger [0-9]* withdrew its ramp request" "$LOG_FILE")
+assert_greater_than "$withdrawn" "0" "Ramp requests withdrawn once the port closed"
+assert_equals "$withdrawn" "$found" "The resumed ferry found every request withdrawn"
+assert_equals "0" "$(grep -c "reply mailboxes.*left unanswered" "$LOG_FILE")" "Withdrawn mailboxes not counted as held"
+check_for_errors "$LOG_FILE"
+rm -f "$LOG_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
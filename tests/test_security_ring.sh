@@ -0,0 +1,103 @@
+#!/bin/bash
+# Security ring test - screening requests through the shared-memory ring, answers in completion cells (BENCH=security)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+BENCH_OUT="bench_security.out"
+
+echo "========================================"
+echo "Security Ring Test"
+echo "========================================"
+echo "Security benchmark, then 500 passengers in the process and threaded engines"
+echo ""
+
+# Intake on the ring does not slow down behind unread replies the way the typed queue does
+log_info "Running security benchmark..."
+BENCH=security BENCH_ITERATIONS=20000 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Security benchmark completed"
+rows=$(grep -c "^[0-9][0-9]* .* ns .* ns$" "$BENCH_OUT")
+assert_equals "4" "$rows" "Every backlog timed"
+queue_ns=$(grep "^400 " "$BENCH_OUT" | awk '{ printf "%d", $2 }')
+ring_ns=$(grep "^400 " "$BENCH_OUT" | awk '{ printf "%d", $4 }')
+assert_greater_than "$queue_ns" "$ring_ns" "Ring intake faster than the queue behind 400 replies"
+rm -f "$BENCH_OUT"
+echo ""
+
+export PASSENGER_COUNT=500
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=60
+export FERRY_BAGGAGE_LIMIT_MAX=80
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=20
+export VIP_CHANCE=10
+export TIME_SCALE=10
+
+for engine in process threads; do
+    rm -f "$LOG_FILE"
+    export ENGINE=$engine
+
+    log_info "Running simulation with ENGINE=$engine..."
+    run_test_with_timeout 180 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out with ENGINE=$engine!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed with ENGINE=$engine, exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    passed=$(get_stat_passengers_screened_passed "$LOG_FILE")
+    rejected=$(get_stat_passengers_screened_rejected "$LOG_FILE")
+    boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (ENGINE=$engine)"
+    assert_equals "$spawned" "$((passed + rejected))" "Every passenger screened (ENGINE=$engine)"
+    assert_equals "$passed" "$boarded" "Every screened passenger boarded (ENGINE=$engine)"
+
+    # Every request taken off the ring is answered in its completion cell
+    requested=$(grep -c "Requested security station allocation" "$LOG_FILE")
+    received=$(grep -c "Receiving security queue request" "$LOG_FILE")
+    answered=$(grep -c "Passenger [0-9]* \(passed\|did not pass\) the security" "$LOG_FILE")
+    assert_equals "$requested" "$received" "Every request taken off the ring (ENGINE=$engine)"
+    assert_equals "$received" "$answered" "Every request answered (ENGINE=$engine)"
+    assert_greater_than "$rejected" "0" "Dangerous items rejected (ENGINE=$engine)"
+
+    validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+done
+unset ENGINE
+
+# The closed ring lets the security manager exit with its port
+leftover=$(pgrep -c -f "^security-manager" 2>/dev/null)
+assert_equals "0" "${leftover:-0}" "No security manager left running"
+rm -f "$LOG_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
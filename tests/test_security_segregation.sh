@@ -13,7 +13,7 @@ LOG_FILE="simulation.log"
 echo "========================================"
 echo "Security Segregation Test"
 echo "========================================"
-echo "Validate max 2 per station, same gender when 2 present"
+echo "Validate max 2 per station, same gender when 2 present, and a security manager idle between screenings"
 echo ""
 
 rm -f "$LOG_FILE"
@@ -69,6 +69,12 @@ validate_passenger_accounting "$LOG_FILE"
 validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
 validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
 
+# The security manager's CPU time and lateness are logged, not asserted: both vary with the load on the host
+summary=$(grep -o "Security manager exiting: .*" "$LOG_FILE")
+log_info "$summary"
+screenings=$(echo "$summary" | awk '{ print $4 }')
+assert_equals "$security_passed" "$screenings" "Every screening answered"
+
 # Check for errors
 check_for_errors "$LOG_FILE"
 
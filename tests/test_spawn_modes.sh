@@ -0,0 +1,79 @@
+#!/bin/bash
+# Spawn mode test - roles forked without exec (SPAWN=fork) and exec'd from the multi-call binary (SPAWN=exec)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Spawn Mode Test"
+echo "========================================"
+echo "500 passengers, forked and exec'd"
+echo ""
+
+export PASSENGER_COUNT=500
+export FERRY_COUNT=4
+export FERRY_CAPACITY=200
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=2
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+
+for mode in exec fork; do
+    rm -f "$LOG_FILE"
+    export SPAWN=$mode
+
+    log_info "Running simulation with SPAWN=$mode..."
+    run_test_with_timeout 120 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out with SPAWN=$mode!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed with SPAWN=$mode, exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (SPAWN=$mode)"
+
+    # Spawn rate and passenger memory are reported by the port manager
+    spawn_reports=$(grep -c "Spawned $PASSENGER_COUNT passengers in .* SPAWN=$mode" "$LOG_FILE")
+    assert_equals "1" "$spawn_reports" "Spawn rate reported (SPAWN=$mode)"
+    memory_reports=$(grep -c "Passenger memory: RSS .* PSS .* SPAWN=$mode" "$LOG_FILE")
+    assert_equals "1" "$memory_reports" "Passenger memory reported (SPAWN=$mode)"
+
+    validate_passenger_accounting "$LOG_FILE"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+done
+
+# Unknown spawn modes are rejected before anything starts
+SPAWN=vfork "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "Unknown SPAWN rejected"
+
+print_test_summary
+exit $TESTS_FAILED
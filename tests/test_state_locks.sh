@@ -0,0 +1,122 @@
+#!/bin/bash
+# State lock test - shared state guarded by robust process-shared mutexes instead of System V semaphores,
+# docks read through a seqlock, every region on its own cache line (BENCH=locks, BENCH=docks, BENCH=layout)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+BENCH_OUT="bench_locks.out"
+
+echo "========================================"
+echo "State Lock Test"
+echo "========================================"
+echo "Lock, docks and layout benchmarks, then 600 passengers over 2 terminals"
+echo ""
+
+# Both locks count every increment, and a dead holder does not block the next one
+log_info "Running lock benchmark..."
+BENCH=locks BENCH_ITERATIONS=20000 BENCH_PROCESSES=4 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Lock benchmark completed"
+for lock in "SysV semaphore" "State mutex"; do
+    rows=$(grep -c "^$lock .* ns .* ns$" "$BENCH_OUT")
+    assert_equals "1" "$rows" "$lock timed without lost updates"
+done
+recovered=$(grep -c "^Owner death: lock recovered" "$BENCH_OUT")
+assert_equals "1" "$recovered" "Lock recovered after its holder died"
+
+# Passengers reading the docks under the lock or through the seqlock; the seqlock never blocks the ferry
+log_info "Running docks benchmark..."
+BENCH=docks BENCH_ITERATIONS=20000 BENCH_PROCESSES=4 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Docks benchmark completed"
+seqlock_waits=$(grep "^Seqlock " "$BENCH_OUT" | awk '{ print $(NF-1) }')
+assert_equals "0.00%" "$seqlock_waits" "Ferry never waited for seqlock readers"
+seqlock_reads=$(grep "^Seqlock " "$BENCH_OUT" | awk '{ print $NF }')
+assert_greater_than "$seqlock_reads" "0" "Seqlock readers read the docks"
+rm -f "$BENCH_OUT"
+
+# Header, read-mostly fields, locks, statistics shards and ferries start on cache lines of their own
+log_info "Running layout benchmark..."
+BENCH=layout BENCH_ITERATIONS=20000 BENCH_PROCESSES=4 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Layout benchmark completed"
+aligned=$(grep -c "^Every region starts on a cache line: yes" "$BENCH_OUT")
+assert_equals "1" "$aligned" "SharedState regions cache-line aligned"
+rows=$(grep -c "^\(Ferry records\|Docks and stats\) .* ns .* ns$" "$BENCH_OUT")
+assert_equals "2" "$rows" "Packed and aligned layouts timed"
+rm -f "$BENCH_OUT"
+
+BENCH=spin "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "Unknown BENCH rejected"
+echo ""
+
+# Every role locks the shared state of its terminal, passengers read its docks through the seqlock
+rm -f "$LOG_FILE"
+
+export TERMINAL_COUNT=2
+export DOCK_COUNT=2
+export PASSENGER_COUNT=600
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+export TIME_SCALE=10
+
+log_info "Running simulation with $TERMINAL_COUNT terminals..."
+run_test_with_timeout 180 "$SIM_BIN"
+
+exit_code=$?
+
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out!"
+    exit 1
+elif [ $exit_code -ne 0 ]; then
+    log_error "Simulation failed with exit code: $exit_code"
+    exit 1
+fi
+
+if ! verify_log_exists "$LOG_FILE"; then
+    exit 1
+fi
+
+echo ""
+log_info "Validating results..."
+
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned"
+boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+terminal_boarded=$(grep "^Terminal [0-9]*: " "$LOG_FILE" | sed 's/.*boarded \([0-9]*\).*/\1/' | awk '{ sum += $1 } END { print sum }')
+assert_equals "$boarded" "$terminal_boarded" "Terminal statistics add up to the port"
+
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+check_for_errors "$LOG_FILE"
+
+# The state locks live in shared memory: no semaphore set is left behind
+leftover=$(ipcs -s 2>/dev/null | grep -c "^0x")
+assert_equals "0" "$leftover" "No semaphore sets left over"
+
+print_test_summary
+exit $TESTS_FAILED
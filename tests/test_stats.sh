@@ -0,0 +1,97 @@
+#!/bin/bash
+# Statistics test - lock-free sharded statistics counters (BENCH=stats)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+BENCH_OUT="bench_stats.out"
+
+echo "========================================"
+echo "Statistics Test"
+echo "========================================"
+echo "Counter benchmark, then 1000 passengers in the process and threaded engines"
+echo ""
+
+# Every update is counted, with or without the lock
+log_info "Running statistics benchmark..."
+BENCH=stats BENCH_ITERATIONS=50000 BENCH_PROCESSES=4 run_test_with_timeout 120 "$SIM_BIN" > "$BENCH_OUT"
+exit_code=$?
+cat "$BENCH_OUT"
+assert_equals "0" "$exit_code" "Statistics benchmark completed"
+for counter in "State mutex" "Atomic" "Sharded atomic"; do
+    rows=$(grep -c "^$counter  .* ns .* ns$" "$BENCH_OUT")
+    assert_equals "1" "$rows" "$counter counted without lost updates"
+done
+rm -f "$BENCH_OUT"
+echo ""
+
+export DOCK_COUNT=2
+export PASSENGER_COUNT=1000
+export FERRY_COUNT=6
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+export TIME_SCALE=10
+
+# Passengers, ferries and the security manager count on different shards;
+# the totals must still agree with each other and with the log
+for engine in process threads; do
+    rm -f "$LOG_FILE"
+    export ENGINE=$engine
+
+    log_info "Running simulation with ENGINE=$engine..."
+    run_test_with_timeout 180 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out with ENGINE=$engine!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed with ENGINE=$engine, exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    passed=$(get_stat_passengers_screened_passed "$LOG_FILE")
+    rejected=$(get_stat_passengers_screened_rejected "$LOG_FILE")
+    boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+    trips=$(get_stat_total_ferry_trips "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (ENGINE=$engine)"
+    assert_equals "$spawned" "$((passed + rejected))" "Every passenger screened once (ENGINE=$engine)"
+    assert_equals "$passed" "$boarded" "Every screened passenger boarded (ENGINE=$engine)"
+    logged_boarded=$(grep -c "Passenger [0-9]* left ramp" "$LOG_FILE")
+    assert_equals "$logged_boarded" "$boarded" "Boarded count matches the log (ENGINE=$engine)"
+    logged_rejected=$(grep -c "did not pass the security" "$LOG_FILE")
+    assert_equals "$logged_rejected" "$rejected" "Security rejections match the log (ENGINE=$engine)"
+    assert_greater_than "$trips" "0" "Ferry trips counted (ENGINE=$engine)"
+
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+done
+unset ENGINE
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,77 @@
+#!/bin/bash
+# Parameter sweep test - grid search over fleet configurations (ENGINE=des SWEEP=...)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+OUTPUT_FILE="sweep.out"
+
+echo "========================================"
+echo "Parameter Sweep Test"
+echo "========================================"
+echo "4 fleet sizes x 2 capacities, fleet budget of 3 ferries"
+echo ""
+
+rm -f "$OUTPUT_FILE"
+
+# Sweep configuration
+export ENGINE=des
+export SWEEP="FERRY_COUNT=1:4 FERRY_CAPACITY=50,100"
+export FLEET_BUDGET=3
+export REPLICATIONS=4
+export WORKERS=4
+export SEED=7
+export PASSENGER_COUNT=1000
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=60
+export FERRY_TRAVEL_TIME=300
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=10
+export VIP_CHANCE=10
+
+log_info "Running sweep..."
+timeout 60 "$SIM_BIN" > "$OUTPUT_FILE"
+exit_code=$?
+
+if [ $exit_code -eq 124 ]; then
+    log_error "Sweep timed out!"
+    exit 1
+elif [ $exit_code -ne 0 ]; then
+    log_error "Sweep failed with exit code: $exit_code"
+    exit 1
+fi
+
+echo ""
+log_info "Validating results..."
+echo ""
+
+# Result rows start with the FERRY_COUNT value
+rows=$(sed -n '/=== Sweep Results ===/,/^=====/p' "$OUTPUT_FILE" | grep -cE '^ +[0-9]')
+assert_equals "6" "$rows" "Only configurations within the fleet budget are simulated"
+
+best_ferries=$(grep "^Best:" "$OUTPUT_FILE" | sed -E 's/.*FERRY_COUNT=([0-9]+).*/\1/')
+assert_less_than_or_equal "$best_ferries" "$FLEET_BUDGET" "Best configuration respects the fleet budget"
+
+# Best is the row with the highest throughput
+best_row=$(sed -n '/=== Sweep Results ===/,/^=====/p' "$OUTPUT_FILE" | grep -E '^ +[0-9]' | sort -k3 -g -r | head -1 | awk '{print "FERRY_COUNT=" $1 " FERRY_CAPACITY=" $2}')
+best_line=$(grep "^Best:" "$OUTPUT_FILE" | awk '{print $2 " " $3}')
+assert_equals "$best_row" "$best_line" "Reported best configuration maximizes boarded passengers per hour"
+
+rm -f "$OUTPUT_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
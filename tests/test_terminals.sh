@@ -0,0 +1,102 @@
+#!/bin/bash
+# Multi-terminal test - several terminals sharing one ferry fleet (TERMINAL_COUNT)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Multi-Terminal Test"
+echo "========================================"
+echo "600 passengers over 3 terminals, 4 shared ferries"
+echo ""
+
+rm -f "$LOG_FILE"
+
+export TERMINAL_COUNT=3
+export PASSENGER_COUNT=600
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+
+log_info "Running simulation with $TERMINAL_COUNT terminals..."
+run_test_with_timeout 180 "$SIM_BIN"
+
+exit_code=$?
+
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out!"
+    exit 1
+elif [ $exit_code -ne 0 ]; then
+    log_error "Simulation failed with exit code: $exit_code"
+    exit 1
+fi
+
+if ! verify_log_exists "$LOG_FILE"; then
+    exit 1
+fi
+
+echo ""
+log_info "Validating results..."
+
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned"
+
+# Every terminal released its share and reports its own statistics
+terminal_reports=$(grep -c "^Terminal [0-9]*: " "$LOG_FILE")
+assert_equals "$TERMINAL_COUNT" "$terminal_reports" "Statistics reported per terminal"
+for t in 0 1 2; do
+    terminal_spawned=$(grep "^Terminal $t: " "$LOG_FILE" | sed 's/.*spawned \([0-9]*\).*/\1/')
+    assert_equals "$((PASSENGER_COUNT / TERMINAL_COUNT))" "$terminal_spawned" "Terminal $t spawned its share"
+done
+boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+terminal_boarded=$(grep "^Terminal [0-9]*: " "$LOG_FILE" | sed 's/.*boarded \([0-9]*\).*/\1/' | awk '{ sum += $1 } END { print sum }')
+assert_equals "$boarded" "$terminal_boarded" "Terminal statistics add up to the port"
+
+# Passenger ids are unique across terminals
+distinct_ids=$(grep -o "\[PASSENGER_[0-9]*\] At baggage check" "$LOG_FILE" | sort -u | wc -l)
+assert_equals "$PASSENGER_COUNT" "$distinct_ids" "Passenger ids unique across terminals"
+
+# Ferries are routed between terminals instead of staying at one
+roaming=0
+for f in 0000 0001 0002 0003; do
+    visited=$(grep "\[FERRY_MANAGER_$f\] Ferry heading to terminal" "$LOG_FILE" | awk '{print $NF}' | sort -u | wc -l)
+    [ "$visited" -gt 1 ] && roaming=$((roaming + 1))
+done
+assert_greater_than "$roaming" "0" "Ferries served more than one terminal"
+
+closed=$(grep -c "Marking terminal as closed" "$LOG_FILE")
+assert_equals "$TERMINAL_COUNT" "$closed" "Every terminal closed"
+
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+check_for_errors "$LOG_FILE"
+
+# Terminals need the process engine, and their number is bounded
+ENGINE=des "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "TERMINAL_COUNT > 1 rejected with ENGINE=des"
+TERMINAL_COUNT=17 "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "TERMINAL_COUNT above the limit rejected"
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,100 @@
+#!/bin/bash
+# Threaded engine test - runs every role as a thread of one process (ENGINE=threads)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Threaded Engine Test"
+echo "========================================"
+echo "2000 passengers as threads, at most 256 alive at once, then ferry threads that cannot all start"
+echo ""
+
+rm -f "$LOG_FILE"
+
+# Threaded engine configuration
+export ENGINE=threads
+export MAX_LIVE_PASSENGERS=256
+export PASSENGER_COUNT=2000
+export FERRY_COUNT=4
+export FERRY_CAPACITY=500
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=5
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+
+log_info "Running simulation with the threaded engine..."
+run_test_with_timeout 120 "$SIM_BIN"
+
+exit_code=$?
+
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out!"
+    exit 1
+elif [ $exit_code -ne 0 ]; then
+    log_error "Simulation failed with exit code: $exit_code"
+    exit 1
+fi
+
+if ! verify_log_exists "$LOG_FILE"; then
+    exit 1
+fi
+
+echo ""
+log_info "Validating results..."
+echo ""
+
+spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+boarded=$(get_stat_passengers_boarded "$LOG_FILE")
+rejected_security=$(get_stat_passengers_screened_rejected "$LOG_FILE")
+
+log_info "Passengers spawned: $spawned"
+log_info "Passengers boarded: $boarded"
+log_info "Passengers rejected at security: $rejected_security"
+
+assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned"
+
+# Same log events as the process engine, so the same validations apply
+validate_passenger_accounting "$LOG_FILE"
+validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+validate_ramp_capacity "$LOG_FILE" "$RAMP_CAPACITY_REG" "$RAMP_CAPACITY_VIP"
+validate_ramp_empty_on_departure "$LOG_FILE"
+
+# Check for errors
+check_for_errors "$LOG_FILE"
+echo ""
+
+# Too little address space for every ferry's stack: the run ends with an error, joining only the ferries that started
+rm -f "$LOG_FILE"
+log_info "Running with FERRY_COUNT=300 in 400 MB of address space..."
+(ulimit -v 400000; FERRY_COUNT=300 run_test_with_timeout 60 "$SIM_BIN" > /dev/null 2>&1)
+exit_code=$?
+if [ $exit_code -eq 124 ]; then
+    log_error "Simulation timed out after a ferry thread failed to start"
+    exit 1
+fi
+assert_equals "1" "$exit_code" "Failed ferry thread reported in the exit status"
+started=$(grep -o "Started [0-9]* of 300 ferry managers" "$LOG_FILE" | awk '{ print $2 }')
+assert_greater_than "${started:-0}" "0" "Some ferry threads started"
+assert_equals "${started:-0}" "$(grep -c "Ferry exiting" "$LOG_FILE")" "Every started ferry exited"
+assert_equals "0" "$(grep -c "All passengers exited" "$LOG_FILE")" "Port not reported closed by its passengers"
+rm -f "$LOG_FILE"
+
+print_test_summary
+exit $TESTS_FAILED
@@ -0,0 +1,107 @@
+#!/bin/bash
+# Time scale test - all simulated durations compressed together (TIME_SCALE)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Time Scale Test"
+echo "========================================"
+echo "200 passengers in real time and 10x faster"
+echo ""
+
+export PASSENGER_COUNT=200
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=3
+export FERRY_TRAVEL_TIME=2
+export PASSENGER_SECURITY_TIME_MIN=20
+export PASSENGER_SECURITY_TIME_MAX=40
+export PASSENGER_BOARDING_TIME=5000
+export FERRY_GATE_MAX_DELAY=100000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+export ARRIVAL_INTERVAL=20
+
+# Runs the simulation and prints its wall time in ms
+run_scaled() {
+    local label=$1
+    local start
+    local end
+
+    rm -f "$LOG_FILE"
+    start=$(date +%s%N)
+    run_test_with_timeout 120 "$SIM_BIN" > /dev/null
+    exit_code=$?
+    end=$(date +%s%N)
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out ($label)!" >&2
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed ($label), exit code: $exit_code" >&2
+        exit 1
+    fi
+    echo $(((end - start) / 1000000))
+}
+
+validate_run() {
+    local label=$1
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned ($label)"
+    validate_passenger_accounting "$LOG_FILE"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+}
+
+log_info "Running simulation in real time..."
+real_ms=$(run_scaled "TIME_SCALE=1")
+log_info "Took $real_ms ms"
+validate_run "TIME_SCALE=1"
+
+export TIME_SCALE=10
+log_info "Running simulation with TIME_SCALE=$TIME_SCALE..."
+fast_ms=$(run_scaled "TIME_SCALE=$TIME_SCALE")
+log_info "Took $fast_ms ms"
+validate_run "TIME_SCALE=$TIME_SCALE"
+
+# Departure intervals and crossings dominate the day, so it shrinks by most of the factor
+assert_greater_than "$real_ms" "$((fast_ms * 4))" "Port day more than 4x shorter at TIME_SCALE=$TIME_SCALE"
+
+# A crossing still takes FERRY_TRAVEL_TIME simulated seconds, one log line per second
+travel_lines=$(grep "\[FERRY_MANAGER_0000\] Traveling: time left" "$LOG_FILE" | head -$FERRY_TRAVEL_TIME | wc -l)
+assert_equals "$FERRY_TRAVEL_TIME" "$travel_lines" "Crossing counted in simulated seconds"
+
+export ENGINE=threads
+log_info "Running threaded engine with TIME_SCALE=$TIME_SCALE..."
+fast_ms=$(run_scaled "threads engine")
+log_info "Took $fast_ms ms"
+validate_run "threads engine"
+unset ENGINE
+
+# Time cannot stand still or run backwards
+for scale in 0 -2 fast; do
+    TIME_SCALE=$scale "$SIM_BIN" > /dev/null 2>&1
+    exit_code=$?
+    assert_equals "1" "$exit_code" "TIME_SCALE=$scale rejected"
+done
+
+print_test_summary
+exit $TESTS_FAILED
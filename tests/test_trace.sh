@@ -0,0 +1,140 @@
+#!/bin/bash
+# Trace replay test - recorded arrivals (CSV and binary) replayed by every engine
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+CSV_TRACE="$(mktemp /tmp/ferry-trace-XXXXXX.csv)"
+BIN_TRACE="$(mktemp /tmp/ferry-trace-XXXXXX.bin)"
+trap 'rm -f "$CSV_TRACE" "$BIN_TRACE"' EXIT
+
+TRACE_LENGTH=200
+
+echo "========================================"
+echo "Trace Replay Test"
+echo "========================================"
+echo "$TRACE_LENGTH recorded passengers, every 10th carrying a dangerous item"
+echo ""
+
+# Little-endian integer of the given width in bytes
+le() {
+    local value=$1
+    local bytes=$2
+    for ((b = 0; b < bytes; b++)); do
+        printf "\\x$(printf '%02x' $((value & 255)))"
+        value=$((value >> 8))
+    done
+}
+
+# Passenger i arrives at 1000 + 2*i ms (the offset is dropped on replay), women on odd rows,
+# VIPs every 7th row, dangerous items every 10th row, bags within every ferry's limit
+echo "arrival_ms,gender,vip,bag_weight,dangerous" > "$CSV_TRACE"
+{
+    printf 'FTRC'
+    le 1 4
+    le $TRACE_LENGTH 8
+} > "$BIN_TRACE"
+for ((i = 0; i < TRACE_LENGTH; i++)); do
+    arrival=$((1000 + 2 * i))
+    gender=$((i % 2 + 1))
+    vip=$((i % 7 == 0 ? 1 : 0))
+    bag=$((5 + i % 36))
+    dangerous=$((i % 10 == 0 ? 1 : 0))
+    echo "$arrival,$([ $gender -eq 1 ] && echo M || echo W),$vip,$bag,$dangerous" >> "$CSV_TRACE"
+    {
+        le $arrival 8
+        le $gender 1
+        le $vip 1
+        le $dangerous 1
+        le 0 1
+        le $bag 4
+    } >> "$BIN_TRACE"
+done
+DANGEROUS_ROWS=$((TRACE_LENGTH / 10))
+WOMEN_ROWS=$((TRACE_LENGTH / 2))
+
+# PASSENGER_COUNT is only a cap: the trace decides who arrives
+export PASSENGER_COUNT=1000
+export FERRY_COUNT=4
+export FERRY_CAPACITY=100
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=1
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=50
+export VIP_CHANCE=50
+
+run_replay() {
+    local label=$1
+
+    rm -f "$LOG_FILE"
+    log_info "Replaying the trace ($label)..."
+    run_test_with_timeout 120 "$SIM_BIN"
+
+    exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out ($label)!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed ($label), exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    assert_equals "$TRACE_LENGTH" "$spawned" "Every recorded passenger arrived ($label)"
+    rejected=$(get_stat_passengers_screened_rejected "$LOG_FILE")
+    assert_equals "$DANGEROUS_ROWS" "$rejected" "Recorded dangerous items rejected at security ($label)"
+    women=$(grep -c "Requested security station allocation (gender: FEMALE)" "$LOG_FILE")
+    assert_equals "$WOMEN_ROWS" "$women" "Recorded genders screened ($label)"
+
+    validate_passenger_accounting "$LOG_FILE"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    echo ""
+}
+
+export TRACE="$CSV_TRACE"
+run_replay "CSV, passenger generator"
+
+export TRACE="$BIN_TRACE"
+run_replay "binary, passenger generator"
+
+export ENGINE=threads
+run_replay "binary, threads engine"
+
+export ENGINE=des
+export SEED=7
+run_replay "binary, discrete-event engine"
+des_binary=$(grep "^Passengers" "$LOG_FILE")
+export TRACE="$CSV_TRACE"
+run_replay "CSV, discrete-event engine"
+des_csv=$(grep "^Passengers" "$LOG_FILE")
+[ "$des_binary" = "$des_csv" ]
+assert_equals "0" "$?" "Both trace formats replay identically"
+unset ENGINE SEED
+
+# Unreadable traces are rejected before anything starts
+TRACE=/nonexistent/trace.csv "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "Missing TRACE rejected"
+
+print_test_summary
+exit $TESTS_FAILED
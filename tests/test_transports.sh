@@ -0,0 +1,93 @@
+#!/bin/bash
+# Transport test - the same scenario over System V queues, POSIX queues and shared-memory rings (TRANSPORT)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/buildDir"
+SIM_BIN="${1:-$BUILD_DIR/ferry-simulation}"
+
+source "$SCRIPT_DIR/tests.shlib"
+
+LOG_FILE="simulation.log"
+
+echo "========================================"
+echo "Transport Test"
+echo "========================================"
+echo "500 passengers, 2 docks, every transport"
+echo ""
+
+export DOCK_COUNT=2
+export PASSENGER_COUNT=500
+export FERRY_COUNT=4
+export FERRY_CAPACITY=150
+export RAMP_CAPACITY_REG=4
+export RAMP_CAPACITY_VIP=2
+export FERRY_DEPARTURE_INTERVAL=2
+export FERRY_TRAVEL_TIME=1
+export PASSENGER_SECURITY_TIME_MIN=3
+export PASSENGER_SECURITY_TIME_MAX=7
+export PASSENGER_BOARDING_TIME=500
+export FERRY_GATE_MAX_DELAY=1000
+export FERRY_BAGGAGE_LIMIT_MIN=40
+export FERRY_BAGGAGE_LIMIT_MAX=60
+export PASSENGER_BAG_WEIGHT_MIN=5
+export PASSENGER_BAG_WEIGHT_MAX=50
+export DANGEROUS_ITEM_CHANCE=5
+export VIP_CHANCE=10
+export TIME_SCALE=10
+
+for transport in sysv posix ring; do
+    rm -f "$LOG_FILE"
+    export TRANSPORT=$transport
+
+    log_info "Running simulation with TRANSPORT=$transport..."
+    start=$(date +%s%N)
+    run_test_with_timeout 120 "$SIM_BIN"
+
+    exit_code=$?
+    elapsed=$(( ($(date +%s%N) - start) / 1000000 ))
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Simulation timed out with TRANSPORT=$transport!"
+        exit 1
+    elif [ $exit_code -ne 0 ]; then
+        log_error "Simulation failed with TRANSPORT=$transport, exit code: $exit_code"
+        exit 1
+    fi
+
+    if ! verify_log_exists "$LOG_FILE"; then
+        exit 1
+    fi
+    log_info "TRANSPORT=$transport: ${elapsed} ms"
+
+    spawned=$(get_stat_passengers_spawned "$LOG_FILE")
+    assert_equals "$PASSENGER_COUNT" "$spawned" "All passengers spawned (TRANSPORT=$transport)"
+    docked=$(grep -o "Ferry docked at dock [0-9]*" "$LOG_FILE" | sort -u | wc -l)
+    assert_equals "$DOCK_COUNT" "$docked" "Every ramp lane used (TRANSPORT=$transport)"
+
+    validate_passenger_accounting "$LOG_FILE"
+    validate_ferry_capacity "$LOG_FILE" "$FERRY_CAPACITY"
+    check_for_errors "$LOG_FILE"
+    # The logger reads any role's oldest line first, as msgrcv does; a day rollover is no regression
+    if [ "$transport" = posix ]; then
+        regressions=$(grep -o '^([0-9:]*)' "$LOG_FILE" | tr -d '()' | awk -F: '{ t = $1 * 3600 + $2 * 60 + $3; if (NR > 1 && t < prev && prev - t < 43200) n++; prev = t } END { print n + 0 }')
+        assert_equals "0" "$regressions" "Log lines in the order they were sent (TRANSPORT=$transport)"
+    fi
+    echo ""
+done
+unset TRANSPORT
+
+# Nothing is left behind once the simulation ends
+leftover=$(ipcs -q -m 2>/dev/null | grep -c "^0x")
+assert_equals "0" "$leftover" "No queues or rings left over"
+
+# Unknown transports are rejected before anything starts
+TRANSPORT=pipe "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "Unknown TRANSPORT rejected"
+ENGINE=threads TRANSPORT=ring "$SIM_BIN" > /dev/null 2>&1
+exit_code=$?
+assert_equals "1" "$exit_code" "TRANSPORT rejected with the threaded engine"
+
+print_test_summary
+exit $TESTS_FAILED